@@ -0,0 +1,80 @@
+# Native build of the firmware for the host
+# The host backend of the hardware abstraction layer replaces avr-libc, so the firmware can be benchmarked & tested
+# on a workstation. Used by the Host build & by the host tools, which build a library per countermeasure combination.
+set(FIRMWARE_BASE_PATH "${CMAKE_CURRENT_LIST_DIR}/..")
+if(NOT F_CPU)
+    set(F_CPU 4800000UL)
+endif()
+if(NOT BAUD)
+    set(BAUD 9600UL)
+endif()
+set(FIRMWARE_HOST_SOURCES   "${FIRMWARE_BASE_PATH}/src/communication.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/scheduler.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/statistics.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/cycleCounter.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/logger.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/blockCache.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/aes.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/aesMath.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/keyStore.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/masking.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/hiding.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/rng.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/host/aesNI.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/host/bitslicedAES.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/host/hostAES.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/host/tTableAES.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/aes/host/vpermAES.cpp"
+                            "${FIRMWARE_BASE_PATH}/src/hal/host.cpp"
+)
+# The firmware's main(), only for host tools that run the firmware as a whole, e.g. renamed with -Dmain=firmwareMain
+set(FIRMWARE_HOST_MAIN "${FIRMWARE_BASE_PATH}/src/main.cpp")
+
+# Add a static library with everything but main(), built with the compile definitions given after the target name
+function(add_firmware_host_library target)
+    set(sources ${FIRMWARE_HOST_SOURCES})
+    if("PROFILING" IN_LIST ARGN)
+        list(APPEND sources "${FIRMWARE_BASE_PATH}/src/profiler.cpp")
+    endif()
+    if("LEAKAGE" IN_LIST ARGN)
+        list(APPEND sources "${FIRMWARE_BASE_PATH}/src/leakage.cpp")
+    endif()
+    add_library(${target} STATIC ${sources})
+    target_include_directories(${target} PUBLIC "${FIRMWARE_BASE_PATH}/include" "${FIRMWARE_BASE_PATH}/include/aes")
+    target_compile_definitions(${target} PUBLIC ${ARGN} F_CPU=${F_CPU} BAUD=${BAUD})
+    target_compile_options(${target} PUBLIC -funsigned-char PRIVATE -Wall)
+endfunction()
+
+# Enumerate every combination of the countermeasures MASKING, SHUFFLING & DUMMY_OPS.
+# Sets <out> to the names of the variants, e.g. plain or masking_dummyops, & <out>_<variant> to the compile definitions
+# of each variant, e.g. MASKING;DUMMY_OPS.
+function(firmware_variants out)
+    set(variants)
+    foreach(masking OFF ON)
+        foreach(shuffling OFF ON)
+            foreach(dummyOps OFF ON)
+                set(variant)
+                set(definitions)
+                if(masking)
+                    list(APPEND variant "masking")
+                    list(APPEND definitions "MASKING")
+                endif()
+                if(shuffling)
+                    list(APPEND variant "shuffling")
+                    list(APPEND definitions "SHUFFLING")
+                endif()
+                if(dummyOps)
+                    list(APPEND variant "dummyops")
+                    list(APPEND definitions "DUMMY_OPS")
+                endif()
+                if(NOT variant)
+                    set(variant "plain")
+                endif()
+                string(REPLACE ";" "_" variant "${variant}")
+                list(APPEND variants ${variant})
+                set(${out}_${variant} ${definitions} PARENT_SCOPE)
+            endforeach()
+        endforeach()
+    endforeach()
+    set(${out} ${variants} PARENT_SCOPE)
+endfunction()
@@ -16,6 +16,11 @@
 #include "defs.h"
 #include "lut.h"
 #include "aesMath.h"
+#include "cycleCounter.h"
+#include "statistics.h"
+#include "profiler.h"
+#include "leakage.h"
+#include "keyStore.h"
 
 // Logger
 #ifdef DEBUG
@@ -46,23 +51,99 @@ class AES
 {
 public:
     /**
-     * @brief Construct a new AES object.
-     * @param[in] masterKey (const @ref aes_key_t): The master key.
+     * @brief Construct a new AES object without a key.
+     * 
+     * The key is selected with selectKey() before the first decryption.
+     */
+    AES() = default;
+
+    /**
+     * @brief Number of blocks decryptBlocks() decrypts at the same time.
+     *
+     * Each layer handles all blocks of a group in its inner loop, so a host CPU overlaps the independent lookups
+     * & multiplications of the blocks. The AVR executes in order, so a group is a single block there.
+     */
+    #ifdef __AVR__
+    static constexpr uint8_t PARALLEL_BLOCKS = 1;
+    #else
+    static constexpr uint8_t PARALLEL_BLOCKS = 4;
+    #endif
+
+    /**
+     * @brief Select the key of @p slot in the KeyStore for the following decryptions.
+     * 
+     * The key schedule is only read from the KeyStore, if another slot was selected before
+     * or a key was loaded in the meantime.
+     * @param[in] slot (const uint8_t): Slot of the key.
+     * @return (bool): Whether @p slot contains a valid key.
      */
-    AES(const aes_key_t masterKey);
+    bool selectKey(const uint8_t slot);
 
     /**
      * @brief Decrypt a cipher using the 128-bit AES algorithm.
+     * 
+     * @pre A key has to be selected with selectKey().
+     * The decryption is timed with the CycleCounter & counted in the Statistics.
      * @see <a href="https://swarm.cs.pub.ro/~mbarbulescu/cripto/Understanding%20Cryptography%20by%20Christof%20Paar%20.pdf#section.4.5.gb" target="_blank">p. 110-112</a> 
      * @param[inout] cipher (uint8_t *): Cipher to decrypt.
      */
     void decrypt(uint8_t *cipher);
+
+    /**
+     * @brief Decrypt consecutive blocks independently, e.g. ECB data or a run of counter blocks.
+     *
+     * @pre A key has to be selected with selectKey().
+     * The countermeasures are initialized once for the whole batch: All blocks are decrypted with the same masks,
+     * S-Box access order & dummy ops, which saves their setup for all but the first block, but gives an attacker
+     * up to @p nBlocks traces with the same randomness. The blocks are decrypted in groups of #PARALLEL_BLOCKS,
+     * the remaining blocks one by one.
+     * The batch is timed with the CycleCounter & each block is counted in the Statistics with the average cycles.
+     * @param[in] in (const uint8_t*): The ciphers, 16 bytes per block.
+     * @param[out] out (uint8_t*): The decrypted blocks, 16 bytes per block. May be the same as @p in.
+     * @param[in] nBlocks (const size_t): Number of blocks.
+     */
+    void decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks);
+
+    #if defined(MASKING) || defined(SHUFFLING) || defined(DUMMY_OPS)
+    /**
+     * @brief Scheduler job that precomputes the countermeasures for the next decryption.
+     * 
+     * Perform a single step of refreshing the masks (Masking::refreshStep()) & afterwards
+     * the hiding operations (Hiding::refreshStep()), so decrypt() does not have to wait for them.
+     * @param[inout] aes (void*): The AES object to precompute the countermeasures for.
+     * @return (bool): Whether the precomputation is still in progress.
+     */
+    static bool precompute(void *aes);
+    #endif
+
+    /**
+     * @brief Create the subkey @p keyIndex of the AES key-schedule from the previous subkey.
+     * 
+     * The first subkey is the master key, the remaining subkeys are calculated as defined in the %AES standard.
+     * See <a href="https://swarm.cs.pub.ro/~mbarbulescu/cripto/Understanding%20Cryptography%20by%20Christof%20Paar%20.pdf#subsection.4.4.4.Fa" target="_blank">p. 106-108</a> 
+     * for reference.
+     *    
+     * @param[inout] subKeys ( @ref sub_keys_t): Array that contains all subkeys, with the subkeys 0 to @p keyIndex-1 already created.
+     * @param[in] keyIndex (const uint8_t): Index of the subkey to create, between 1 & #ROUNDS.
+     */
+    static void createRoundKey(sub_keys_t subKeys, const uint8_t keyIndex);
+
+    /**
+     * @brief Get the round coefficient, that createRoundKey() uses for the subkey @p keyIndex.
+     * @param[in] keyIndex (const uint8_t): Index of the subkey, between 1 & #ROUNDS.
+     * @return (uint8_t): The round coefficient.
+     */
+    static uint8_t roundCoefficient(const uint8_t keyIndex) { return mRCs[keyIndex-1]; }
     
 private:
     // *******************************************************************************
     // Private Attributes ************************************************************
     // *******************************************************************************
+    static constexpr uint8_t NO_SLOT = 0xff;    ///< #mSlot if no key is selected
+
     sub_keys_t mSubkeys = {};       ///< Array that contains all subkeys
+    uint8_t mSlot = NO_SLOT;        ///< KeyStore slot of the key in #mSubkeys
+    uint8_t mGeneration = 0;        ///< KeyStore::generation() when the key was read
     static uint8_t mRCs[ROUNDS];    ///< Array of round coefficients that are used in the key schedule.
 
     // Logger 
@@ -88,55 +169,74 @@ private:
     // ******************************************************************************
     // Private Methods **************************************************************
     // ******************************************************************************
-    // Key Schedule *****************************************************************
     /**
-     * @brief Create the AES key-schedule & store all subkeys in #mSubkeys.
-     * 
-     * - The first subkey is @p masterKey.
-     * - The remaining subkeys are calculated as defined in the %AES standard.
-     *   See <a href="https://swarm.cs.pub.ro/~mbarbulescu/cripto/Understanding%20Cryptography%20by%20Christof%20Paar%20.pdf#subsection.4.4.4.Fa" target="_blank">p. 106-108</a> 
-     *   for reference.
-     *    
-     * @param[in] masterKey (const @ref aes_key_t): The master key, which is used to create the key schedule.
-     * @param[out] subKeys ( @ref sub_keys_t): Array that contains all subkeys.
+     * @brief Initialize the masks & the hiding operations for the next decryption or batch.
      */
-    void createKeySchedule(const aes_key_t masterKey, sub_keys_t subKeys) const;
-    
+    void initCountermeasures();
+
+    /**
+     * @brief Decrypt a group of @p N blocks with the initialized countermeasures.
+     *
+     * The group size is a template parameter, so the loops over the group vanish for a single block
+     * & decrypt() compiles to the plain single-block code.
+     * @tparam N Number of blocks, at most #PARALLEL_BLOCKS.
+     * @param[in] in (const uint8_t*): The ciphers, 16 bytes per block.
+     * @param[out] out (uint8_t*): The decrypted blocks, 16 bytes per block. May be the same as @p in.
+     */
+    template<uint8_t N>
+    void decryptGroup(const uint8_t *in, uint8_t *out);
+
+    /**
+     * @brief Decrypt a group of states with the initialized countermeasures.
+     * @tparam N Number of states.
+     * @param[inout] states ( @ref state_t [N]): The (masked) states.
+     */
+    template<uint8_t N>
+    void decryptStates(state_t (&states)[N]);
+
     // Key Addition Layer ***********************************************************
     /**
-     * @brief Add the key for the current round to @p state.
+     * @brief Add the key for the current round to @p states.
      * 
-     * X-OR each byte of @p state with the corresponding byte in @p roundKey.
+     * X-OR each byte of @p states with the corresponding byte in @p roundKey.
+     * @tparam N Number of states.
      * @param[in] roundKey (const @ref aes_key_t): Key for the current round. 
-     * @param[inout] state ( @ref state_t): Current state matrix. 
+     * @param[inout] states ( @ref state_t [N]): Current state matrices. 
      */
-    void addRoundKey(const aes_key_t roundKey, state_t state);
+    template<uint8_t N>
+    void addRoundKey(const aes_key_t roundKey, state_t (&states)[N]);
 
     // Diffusion Layer **************************************************************
     /**
      * @brief Inverse MixColumn sublayer.
      * 
-     * Do a matrix-matrix multiplication of @p state & #INV_MIX_COL_MATRIX.
-     * @param[inout] state ( @ref state_t): Current state matrix. 
+     * Do a matrix-matrix multiplication of each of @p states & #INV_MIX_COL_MATRIX.
+     * @tparam N Number of states.
+     * @param[inout] states ( @ref state_t [N]): Current state matrices. 
      */
-    void invMixCols(state_t state);
+    template<uint8_t N>
+    void invMixCols(state_t (&states)[N]);
 
     /**
      * @brief Inverse ShiftRows sublayer.
      * 
-     * Rotate each row of the @p state matrix by the row-number to the right.
-     * @param[inout] state ( @ref state_t): Current state matrix. 
+     * Rotate each row of the @p states matrices by the row-number to the right.
+     * @tparam N Number of states.
+     * @param[inout] states ( @ref state_t [N]): Current state matrices. 
      */
-    void invShiftRows(state_t state);
+    template<uint8_t N>
+    void invShiftRows(state_t (&states)[N]);
 
     // Byte Substitution layer ******************************************************
     /**
      * @brief Inverse Byte Substituion layer.
      *
-     * Substitute each byte in @p state with the corresponding value in #INV_S_BOX.
-     * @param[inout] state ( @ref state_t): Current state matrix. 
+     * Substitute each byte in @p states with the corresponding value in #INV_S_BOX.
+     * @tparam N Number of states.
+     * @param[inout] states ( @ref state_t [N]): Current state matrices. 
      */
-    void invByteSub(state_t state);
+    template<uint8_t N>
+    void invByteSub(state_t (&states)[N]);
 };
 
 #endif // AES_H
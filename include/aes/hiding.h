@@ -14,6 +14,7 @@
 #include "defs.h"
 #include "rng.h"
 #include "aesMath.h"
+#include "leakage.h"
 #include <string.h>
 
 /**
@@ -39,13 +40,26 @@ public:
     /**
      * @brief Initialize AES hiding operations.
      * 
-     * -# Seed the RNG.
-     * -# Init the dummy ops by creating an array of random numbers, w
-     * which will be the number of dummy ops per round. It is important that the
-     * total number of dummy ops stays the same for every AES execution.
+     * Finish the refresh that was started in the background by refreshStep(),
+     * or run a complete refresh, if none was started yet.
+     * Afterwards, the dummy ops are consumed & the next call to refreshStep() starts a new refresh.
      */
     void init();
 
+    /**
+     * @brief Perform a single step of refreshing the AES hiding operations.
+     * 
+     * The refresh is split into small steps, so it can be run as a Scheduler job:
+     * -# Seed the RNG, one ADC conversion at a time.
+     * -# Init the dummy ops by creating an array of random numbers, #REFRESH_CHUNK numbers at a time,
+     *    which will be the number of dummy ops per round. It is important that the
+     *    total number of dummy ops stays the same for every AES execution.
+     * -# Shuffle the array, #REFRESH_CHUNK entries at a time.
+     * 
+     * @return (bool): Whether the refresh is still in progress.
+     */
+    bool refreshStep();
+
     /**
      * @brief Shuffle the S-Box access.
      * 
@@ -63,12 +77,38 @@ public:
     void dummyOp();
     #endif
 
+    /**
+     * @brief Restart the dummy ops of the current AES execution, so they are used for another group of blocks.
+     *
+     * AES::decryptBlocks() decrypts several groups of blocks with the same hiding operations, each group
+     * with the same total number of dummy ops as a single AES execution.
+     */
+    #ifdef DUMMY_OPS
+    void restartDummyOps() { mNoOpCounter = 0; }
+    #endif
+
 private:
+    /**
+     * @brief Phases of refreshing the hiding operations.
+     */
+    enum class RefreshPhase : uint8_t
+    {
+        SEED,               ///< Seed the RNG
+        CREATE_NUMBERS,     ///< Create the random numbers of dummy ops
+        SHUFFLE_NUMBERS,    ///< Shuffle the numbers of dummy ops
+        READY               ///< Hiding is ready to be used
+    };
+
+    static constexpr uint8_t REFRESH_CHUNK      = 4;        ///< Number of array entries that are handled in a single refresh step
+    RefreshPhase mRefreshPhase                  = RefreshPhase::SEED;   ///< Current phase of the refresh
+    uint8_t mRefreshIndex                       = 0;        ///< Progress within the current refresh phase
+
     #ifdef DUMMY_OPS
     static constexpr uint8_t MAX_NUMBER_NO_OPS  = 100;      ///< The maximum number of NOPs per AES execution. It is important that this number stays the same for every AES execution.
     static constexpr uint8_t NUMBER_OPS         = 40;       ///< The number of operations before which the dummy ops are executed.
     uint8_t mNumbersDummyOps[NUMBER_OPS]        = {};       ///< Array of random numbers, which specify the number of dummy ops per round.
     uint8_t mNoOpCounter                        = 0;        ///< Counter for the number of dummy ops per round.
+    uint8_t mRemainingDummyOps                  = 0;        ///< Number of dummy ops that are not yet distributed.
     #endif
 
     #ifdef SHUFFLING
@@ -82,7 +122,16 @@ private:
      * @param[inout] array (uint8_t []): Array to shuffle.
      * @param[in] size (const uint8_t): Size of the array.
      */
-    void shuffleArray(uint8_t array[], const uint8_t size);
+    void shuffleArray(uint8_t array[], const uint8_t size) { shuffleArray(array, size, 0, size); }
+
+    /**
+     * @brief Perform some iterations of the Fisher-Yates shuffle.
+     * @param[inout] array (uint8_t []): Array to shuffle.
+     * @param[in] size (const uint8_t): Size of the array.
+     * @param[in] first (const uint8_t): First iteration to perform.
+     * @param[in] count (const uint8_t): Number of iterations to perform.
+     */
+    void shuffleArray(uint8_t array[], const uint8_t size, const uint8_t first, const uint8_t count);
 };
 
 #endif // HIDING_H
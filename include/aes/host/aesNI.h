@@ -0,0 +1,94 @@
+/**
+ * @file aesNI.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the AESNI class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef AES_NI_H
+#define AES_NI_H
+
+#include <stddef.h>
+
+#include "defs.h"
+
+/**
+ * @brief Class providing a 128-bit AES decryption for the host with the AES-NI instructions of x86 CPUs.
+ *
+ * Each round is a single AESDEC (AESDECLAST for the last round), the round keys are the key schedule of
+ * AES::createRoundKey() in reverse order, with AESIMC (InvMixColumns) applied to the keys of rounds 1 to 9.
+ * AESDEC has a latency of several cycles, but a throughput of about one per cycle, so decryptBlocks()
+ * keeps #PARALLEL_BLOCKS independent blocks in flight.
+ *
+ * The instructions are only used, if the CPU supports them (see supported()). The class is compiled without
+ * global compiler flags, so the host library still runs on CPUs without AES-NI. Use HostAES to select the
+ * fastest available engine at runtime.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class AESNI
+{
+public:
+    static constexpr uint8_t PARALLEL_BLOCKS = 8;   ///< Number of blocks decryptBlocks() decrypts at the same time
+
+    /**
+     * @brief Construct a new AESNI object without a key.
+     *
+     * The key is set with setKey() or selectKey() before the first decryption.
+     */
+    AESNI() = default;
+
+    /**
+     * @brief Check whether the CPU supports the AES-NI instructions.
+     * @return (bool): Whether the CPU supports AES-NI, always false on other architectures than x86.
+     */
+    static bool supported();
+
+    /**
+     * @brief Set the key for the following decryptions.
+     * @pre supported() is true.
+     * @param[in] key (const @ref aes_key_t): The master key.
+     */
+    void setKey(const aes_key_t key);
+
+    /**
+     * @brief Select the key of @p slot in the KeyStore for the following decryptions, like AES::selectKey().
+     * @pre supported() is true.
+     * @param[in] slot (const uint8_t): Slot of the key.
+     * @return (bool): Whether @p slot contains a valid key.
+     */
+    bool selectKey(const uint8_t slot);
+
+    /**
+     * @brief Decrypt a cipher using the 128-bit AES algorithm.
+     * @pre A key has to be set with setKey() or selectKey().
+     * @param[inout] cipher (uint8_t *): Cipher to decrypt.
+     */
+    void decrypt(uint8_t *cipher) const;
+
+    /**
+     * @brief Decrypt consecutive blocks independently (ECB), #PARALLEL_BLOCKS at a time.
+     * @pre A key has to be set with setKey() or selectKey().
+     * @param[in] in (const uint8_t*): The ciphertexts, 16 bytes per block.
+     * @param[out] out (uint8_t*): The plaintexts, 16 bytes per block. May be the same as @p in.
+     * @param[in] nBlocks (const size_t): Number of blocks.
+     */
+    void decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const;
+
+private:
+    alignas(16) uint8_t mRoundKeys[ROUNDS+1][STATE_BYTES] = {};    ///< Round keys of the equivalent inverse cipher
+
+    /**
+     * @brief Derive the round keys from the key schedule.
+     * @param[in] subKeys (const @ref sub_keys_t): The key schedule, as created by AES::createRoundKey().
+     */
+    void expand(const sub_keys_t subKeys);
+};
+
+#endif // AES_NI_H
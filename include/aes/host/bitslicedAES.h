@@ -0,0 +1,99 @@
+/**
+ * @file bitslicedAES.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the BitslicedAES class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef BITSLICED_AES_H
+#define BITSLICED_AES_H
+
+#include <stddef.h>
+
+#include "defs.h"
+
+/**
+ * @brief Class providing a constant-time 128-bit AES decryption of #BATCH_BLOCKS blocks at a time for the host.
+ *
+ * The blocks are bitsliced: Bit j of byte i of all #BATCH_BLOCKS blocks is kept in a single 64-bit slice,
+ * so every operation works on all blocks at once & is a fixed sequence of AND, XOR & NOT:
+ * - InvShiftRows only renames the slices.
+ * - InvSubBytes is a circuit instead of #LUT::INV_S_BOX: the inverse affine transformation followed by the inversion
+ *   in GF(2^8) as x^254, with 4 multiplications & 7 squarings of bitsliced polynomials.
+ * - InvMixColumns is built from xtime(), which is a renaming of the slices & 3 XORs.
+ * - The round keys are expanded to all-zero or all-one slices, so AddRoundKey is a plain XOR.
+ *
+ * There are neither table lookups nor branches, that depend on the key or the data, so the decryption is
+ * constant-time by construction. Only the key schedule (AES::createRoundKey()) uses the S-Box table, once per key.
+ * The decryption of a single block costs as much as a whole batch, so use decryptBlocks() for many blocks.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class BitslicedAES
+{
+public:
+    static constexpr uint8_t BATCH_BLOCKS = 64;     ///< Number of blocks that are decrypted at a time
+
+    /**
+     * @brief Construct a new BitslicedAES object without a key.
+     *
+     * The key is set with setKey() or selectKey() before the first decryption.
+     */
+    BitslicedAES() = default;
+
+    /**
+     * @brief Set the key for the following decryptions.
+     * @param[in] key (const @ref aes_key_t): The master key.
+     */
+    void setKey(const aes_key_t key);
+
+    /**
+     * @brief Select the key of @p slot in the KeyStore for the following decryptions, like AES::selectKey().
+     * @param[in] slot (const uint8_t): Slot of the key.
+     * @return (bool): Whether @p slot contains a valid key.
+     */
+    bool selectKey(const uint8_t slot);
+
+    /**
+     * @brief Decrypt a cipher using the 128-bit AES algorithm, as a batch of a single block.
+     * @pre A key has to be set with setKey() or selectKey().
+     * @param[inout] cipher (uint8_t *): Cipher to decrypt.
+     */
+    void decrypt(uint8_t *cipher) const;
+
+    /**
+     * @brief Decrypt consecutive blocks independently (ECB), in batches of #BATCH_BLOCKS.
+     * @pre A key has to be set with setKey() or selectKey().
+     * @param[in] in (const uint8_t*): The ciphertexts, 16 bytes per block.
+     * @param[out] out (uint8_t*): The plaintexts, 16 bytes per block. May be the same as @p in.
+     * @param[in] nBlocks (const size_t): Number of blocks.
+     */
+    void decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const;
+
+private:
+    typedef uint64_t slices_t[STATE_BYTES][8];  ///< Bitsliced state or round key: slice [i][j] holds bit j of byte i
+
+    slices_t mRoundKeys[ROUNDS+1] = {};         ///< Bitsliced round keys, in the order of the key schedule
+
+    /**
+     * @brief Expand the key schedule to bitsliced round keys.
+     * @param[in] subKeys (const @ref sub_keys_t): The key schedule, as created by AES::createRoundKey().
+     */
+    void expand(const sub_keys_t subKeys);
+
+    /**
+     * @brief Decrypt up to #BATCH_BLOCKS blocks.
+     * @param[in] in (const uint8_t*): The ciphertexts.
+     * @param[out] out (uint8_t*): The plaintexts.
+     * @param[in] nBlocks (const size_t): Number of blocks, at most #BATCH_BLOCKS.
+     */
+    void decryptBatch(const uint8_t *in, uint8_t *out, const size_t nBlocks) const;
+};
+
+#endif // BITSLICED_AES_H
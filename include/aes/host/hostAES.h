@@ -0,0 +1,128 @@
+/**
+ * @file hostAES.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the HostAES class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef HOST_AES_H
+#define HOST_AES_H
+
+#include <stddef.h>
+
+#include "defs.h"
+#include "host/aesNI.h"
+#include "host/bitslicedAES.h"
+#include "host/tTableAES.h"
+#include "host/vpermAES.h"
+
+/**
+ * @brief Class that decrypts with the fastest host AES engine, that the CPU supports.
+ *
+ * The engine is selected once at construction (see best()), so the Terminal's tools & host simulations
+ * get the same results on every host, only at a different speed:
+ * -# AESNI, if the CPU supports the AES-NI instructions.
+ * -# VPermAES, if the CPU supports SSSE3, which is constant-time unlike TTableAES.
+ * -# TTableAES otherwise, which runs on every CPU.
+ *
+ * BitslicedAES is never selected automatically, as it is only faster than TTableAES for large batches.
+ * Select it explicitly, where constant-time decryption of many blocks is required.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class HostAES
+{
+public:
+    /**
+     * @brief The host AES engines.
+     */
+    enum class Engine : uint8_t
+    {
+        T_TABLE   = 0,  ///< TTableAES
+        AES_NI    = 1,  ///< AESNI
+        BITSLICED = 2,  ///< BitslicedAES
+        VPERM     = 3   ///< VPermAES
+    };
+
+    /**
+     * @brief Construct a new HostAES object with the fastest engine, that the CPU supports.
+     */
+    HostAES() : mEngine(best()) {}
+
+    /**
+     * @brief Construct a new HostAES object with a specific engine, e.g. to compare them.
+     * @pre The CPU supports @p engine (see supported()).
+     * @param[in] engine (const ::Engine): The engine.
+     */
+    explicit HostAES(const Engine engine) : mEngine(engine) {}
+
+    /**
+     * @brief Get the fastest engine, that the CPU supports.
+     * @return (::Engine): The engine.
+     */
+    static Engine best();
+
+    /**
+     * @brief Check whether the CPU supports @p engine.
+     * @param[in] engine (const ::Engine): The engine.
+     * @return (bool): Whether the engine can be used.
+     */
+    static bool supported(const Engine engine);
+
+    /**
+     * @brief Get the name of @p engine.
+     * @param[in] engine (const ::Engine): The engine.
+     * @return (const char*): The name of the engine's class.
+     */
+    static const char *name(const Engine engine);
+
+    /**
+     * @brief Get the selected engine.
+     * @return (::Engine): The engine.
+     */
+    Engine engine() const { return mEngine; }
+
+    /**
+     * @brief Set the key for the following decryptions.
+     * @param[in] key (const @ref aes_key_t): The master key.
+     */
+    void setKey(const aes_key_t key);
+
+    /**
+     * @brief Select the key of @p slot in the KeyStore for the following decryptions, like AES::selectKey().
+     * @param[in] slot (const uint8_t): Slot of the key.
+     * @return (bool): Whether @p slot contains a valid key.
+     */
+    bool selectKey(const uint8_t slot);
+
+    /**
+     * @brief Decrypt a cipher using the 128-bit AES algorithm.
+     * @pre A key has to be set with setKey() or selectKey().
+     * @param[inout] cipher (uint8_t *): Cipher to decrypt.
+     */
+    void decrypt(uint8_t *cipher) const;
+
+    /**
+     * @brief Decrypt consecutive blocks independently (ECB).
+     * @pre A key has to be set with setKey() or selectKey().
+     * @param[in] in (const uint8_t*): The ciphertexts, 16 bytes per block.
+     * @param[out] out (uint8_t*): The plaintexts, 16 bytes per block. May be the same as @p in.
+     * @param[in] nBlocks (const size_t): Number of blocks.
+     */
+    void decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const;
+
+private:
+    const Engine mEngine;       ///< The selected engine
+    TTableAES mTTable;          ///< The T-table engine, if selected
+    AESNI mAESNI;               ///< The AES-NI engine, if selected
+    BitslicedAES mBitsliced;    ///< The bitsliced engine, if selected
+    VPermAES mVPerm;            ///< The vector permute engine, if selected
+};
+
+#endif // HOST_AES_H
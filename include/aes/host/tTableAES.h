@@ -0,0 +1,86 @@
+/**
+ * @file tTableAES.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the TTableAES class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef T_TABLE_AES_H
+#define T_TABLE_AES_H
+
+#include "defs.h"
+
+/**
+ * @brief Class providing a fast 128-bit AES decryption for the host, with 32-bit inverse T-tables.
+ *
+ * Each round combines InvSubBytes, InvShiftRows & InvMixColumns into 16 lookups in the four 1 KB tables Td0-Td3
+ * & the round key addition, on 32-bit columns. The round keys are the key schedule of AES::createRoundKey()
+ * in reverse order, with InvMixColumns applied to the keys of rounds 1 to 9 (the equivalent inverse cipher).
+ *
+ * The class has the same interface as AES, but no countermeasures. It is meant for the Terminal's tools &
+ * host simulations only: The table lookups depend on the key & the data, so it leaks through the cache timing.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class TTableAES
+{
+public:
+    /**
+     * @brief Construct a new TTableAES object without a key.
+     *
+     * The key is set with setKey() or selectKey() before the first decryption.
+     */
+    TTableAES() = default;
+
+    /**
+     * @brief Set the key for the following decryptions.
+     * @param[in] key (const @ref aes_key_t): The master key.
+     */
+    void setKey(const aes_key_t key);
+
+    /**
+     * @brief Select the key of @p slot in the KeyStore for the following decryptions, like AES::selectKey().
+     * @param[in] slot (const uint8_t): Slot of the key.
+     * @return (bool): Whether @p slot contains a valid key.
+     */
+    bool selectKey(const uint8_t slot);
+
+    /**
+     * @brief Decrypt a cipher using the 128-bit AES algorithm.
+     * @pre A key has to be set with setKey() or selectKey().
+     * @param[inout] cipher (uint8_t *): Cipher to decrypt.
+     */
+    void decrypt(uint8_t *cipher) const;
+
+private:
+    /**
+     * @brief The inverse T-tables & the inverse S-Box.
+     */
+    struct tables_t
+    {
+        uint32_t td[WORD_BYTES][SBOX_BYTES];    ///< Td0-Td3: InvMixColumns of the inverse S-Box, rotated by 0 to 3 bytes
+        uint8_t td4[SBOX_BYTES];                ///< Inverse S-Box for the last round
+    };
+
+    uint32_t mRoundKeys[ROUNDS+1][WORD_BYTES] = {};     ///< Round keys of the equivalent inverse cipher
+
+    /**
+     * @brief Derive the round keys from the key schedule.
+     * @param[in] subKeys (const @ref sub_keys_t): The key schedule, as created by AES::createRoundKey().
+     */
+    void expand(const sub_keys_t subKeys);
+
+    /**
+     * @brief Get the tables, which are calculated on the first call.
+     * @return (const @ref tables_t&): The tables.
+     */
+    static const tables_t &tables();
+};
+
+#endif // T_TABLE_AES_H
@@ -0,0 +1,96 @@
+/**
+ * @file vpermAES.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the VPermAES class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef VPERM_AES_H
+#define VPERM_AES_H
+
+#include <stddef.h>
+
+#include "defs.h"
+
+/**
+ * @brief Class providing a constant-time 128-bit AES decryption for the host with the vector permute instruction
+ * PSHUFB of SSSE3 & AVX2, for x86 CPUs without AES-NI.
+ *
+ * PSHUFB looks up 16 nibbles in a 16-byte table at once, so all table lookups are done in registers & don't depend
+ * on the cache:
+ * - InvSubBytes changes each byte to the tower field GF((2^4)^2) with a normal basis (b, b^16), together with the
+ *   inverse affine transformation. The inversion then only needs inversions in GF(2^4) & XOR, i.e. 7 lookups
+ *   in nibble tables, & the result is changed back to the polynomial basis by 2 more lookups.
+ * - InvMixColumns multiplies by 0e, 0b, 0d & 09 with nibble tables & rotates the products within the columns
+ *   with byte shuffles.
+ * - InvShiftRows is a single byte shuffle.
+ *
+ * The tables are derived from GF(2^8) on the first use instead of #LUT::INV_S_BOX. decrypt() uses SSSE3,
+ * decryptBlocks() keeps 2 blocks in each 256-bit register & 2 registers in flight, if the CPU supports AVX2.
+ * The instructions are only used, if the CPU supports them (see supported()). Use HostAES to select the
+ * fastest available engine at runtime.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class VPermAES
+{
+public:
+    /**
+     * @brief Construct a new VPermAES object without a key.
+     *
+     * The key is set with setKey() or selectKey() before the first decryption.
+     */
+    VPermAES() = default;
+
+    /**
+     * @brief Check whether the CPU supports SSSE3.
+     * @return (bool): Whether the CPU supports SSSE3, always false on other architectures than x86.
+     */
+    static bool supported();
+
+    /**
+     * @brief Check whether the CPU supports AVX2, so decryptBlocks() decrypts 2 blocks per register.
+     * @return (bool): Whether the CPU supports AVX2, always false on other architectures than x86.
+     */
+    static bool supportedAVX2();
+
+    /**
+     * @brief Set the key for the following decryptions.
+     * @param[in] key (const @ref aes_key_t): The master key.
+     */
+    void setKey(const aes_key_t key);
+
+    /**
+     * @brief Select the key of @p slot in the KeyStore for the following decryptions, like AES::selectKey().
+     * @param[in] slot (const uint8_t): Slot of the key.
+     * @return (bool): Whether @p slot contains a valid key.
+     */
+    bool selectKey(const uint8_t slot);
+
+    /**
+     * @brief Decrypt a cipher using the 128-bit AES algorithm.
+     * @pre supported() is true & a key has to be set with setKey() or selectKey().
+     * @param[inout] cipher (uint8_t *): Cipher to decrypt.
+     */
+    void decrypt(uint8_t *cipher) const;
+
+    /**
+     * @brief Decrypt consecutive blocks independently (ECB), with AVX2 if the CPU supports it.
+     * @pre supported() is true & a key has to be set with setKey() or selectKey().
+     * @param[in] in (const uint8_t*): The ciphertexts, 16 bytes per block.
+     * @param[out] out (uint8_t*): The plaintexts, 16 bytes per block. May be the same as @p in.
+     * @param[in] nBlocks (const size_t): Number of blocks.
+     */
+    void decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const;
+
+private:
+    alignas(16) uint8_t mRoundKeys[ROUNDS+1][STATE_BYTES] = {};    ///< Round keys, in the order of the key schedule
+};
+
+#endif // VPERM_AES_H
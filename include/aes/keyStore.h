@@ -0,0 +1,152 @@
+/**
+ * @file keyStore.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the KeyStore class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef KEY_STORE_H
+#define KEY_STORE_H
+
+#include <string.h>
+
+#include "defs.h"
+
+/**
+ * @brief Class that stores the key schedules of several keys in EEPROM.
+ *
+ * The Terminal selects a key by its slot (see Protocol::INS_DECRYPT) & loads new keys with
+ * Protocol::INS_LOAD_KEY. Each slot holds the complete key schedule, so selecting a slot only reads it from EEPROM.
+ *
+ * A new key is loaded in the background by the loadStep() job:
+ * -# Its key schedule is created in a staging buffer in SRAM, one subkey per step.
+ * -# The key schedule & its checksum are written to a spare physical slot, one byte per step whenever the EEPROM is ready.
+ * -# The directory entry of the slot is pointed to the spare physical slot. This single byte write commits the key,
+ *    so a reset at any time leaves either the old or the new key in the slot.
+ *
+ * The slot switches to the new key as soon as load() is called: Until the key is committed, the slot is read from the
+ * staging buffer & a pending key schedule is completed on the first read. The staging buffer is wiped after the commit.
+ * Writing a key takes about 180 EEPROM writes of 3.4ms each, during which the card keeps decrypting blocks.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class KeyStore
+{
+public:
+    static constexpr uint8_t NUM_SLOTS  = 8;    ///< Number of key slots
+    static const aes_key_t DEFAULT_KEY;         ///< Key of slot 0 after erasing the EEPROM, main() passes it to init()
+
+    /**
+     * @brief Find the spare physical slot.
+     *
+     * If the slot 0 is empty (e.g. after erasing the EEPROM), load @p defaultKey into it.
+     * @param[in] defaultKey (const @ref aes_key_t): Key for slot 0, if it is empty.
+     */
+    static void init(const aes_key_t defaultKey);
+
+    /**
+     * @brief Start loading @p key into @p slot in the background.
+     * @param[in] slot (const uint8_t): Slot to load the key into.
+     * @param[in] key (const @ref aes_key_t): The master key.
+     * @return (bool): Whether loading was started, false if @p slot is invalid or another key is still being loaded.
+     */
+    static bool load(const uint8_t slot, const aes_key_t key);
+
+    /**
+     * @brief Scheduler job that performs a single step of loading a key.
+     * @param[in] context (void*): Unused.
+     * @return (bool): Whether a key is still being loaded.
+     */
+    static bool loadStep(void *context);
+
+    /**
+     * @brief Read the key schedule of @p slot.
+     *
+     * If the key schedule of @p slot is still being created, it is completed first.
+     * @param[in] slot (const uint8_t): Slot to read.
+     * @param[out] subKeys ( @ref sub_keys_t): The key schedule.
+     * @return (bool): Whether @p slot contains a valid key.
+     */
+    static bool read(const uint8_t slot, sub_keys_t subKeys);
+
+    /**
+     * @brief Check whether a key is being loaded.
+     * @return (bool): Whether a key is being loaded.
+     */
+    static bool busy() { return mLoadPhase != LoadPhase::IDLE; }
+
+    /**
+     * @brief Get the generation of the stored keys, which changes whenever a key is loaded.
+     * @return (uint8_t): The generation.
+     */
+    static uint8_t generation() { return mGeneration; }
+
+private:
+    static constexpr uint8_t PHYSICAL_SLOTS = NUM_SLOTS + 1;    ///< Number of physical slots, including the spare one
+    static constexpr uint8_t EMPTY          = 0xff;             ///< Directory entry of an empty slot (erased EEPROM)
+
+    /**
+     * @brief A key schedule in EEPROM.
+     */
+    struct __attribute__((__packed__)) slot_t
+    {
+        sub_keys_t subKeys;     ///< The key schedule
+        uint8_t checksum;       ///< CRC-8 of #subKeys
+    };
+
+    /**
+     * @brief Phases of loading a key.
+     */
+    enum class LoadPhase : uint8_t
+    {
+        IDLE,       ///< No key is being loaded
+        EXPAND,     ///< Creating the key schedule in #mStaging
+        WRITE,      ///< Writing the key schedule & its checksum to the spare physical slot
+        COMMIT      ///< Pointing the directory entry to the spare physical slot
+    };
+
+    static uint8_t mDirectory[NUM_SLOTS];               ///< Physical slot of each slot in EEPROM
+    static slot_t mSlots[PHYSICAL_SLOTS];               ///< Physical slots in EEPROM
+
+    static sub_keys_t mStaging;                         ///< Key schedule of the key that is being loaded
+    static uint8_t mStagingSlot;                        ///< Slot of the key that is being loaded or #EMPTY
+    static uint8_t mStagingChecksum;                    ///< CRC-8 of #mStaging
+    static uint8_t mSpare;                              ///< Physical slot, that is not used by any slot
+    static uint8_t mGeneration;                         ///< Generation of the stored keys
+    static LoadPhase mLoadPhase;                        ///< Current phase of loading a key
+    static uint8_t mLoadIndex;                          ///< Next subkey (EXPAND) or byte (WRITE) to process
+
+    /**
+     * @brief Get the physical slot of @p slot.
+     * @param[in] slot (const uint8_t): The slot.
+     * @return (uint8_t): The physical slot or #EMPTY.
+     */
+    static uint8_t physicalSlot(const uint8_t slot);
+
+    /**
+     * @brief Find a physical slot, that is not used by any slot.
+     * @param[in] slot (const uint8_t): Slot, whose directory entry is about to change.
+     * @param[in] physical (const uint8_t): New physical slot of @p slot.
+     * @return (uint8_t): The unused physical slot.
+     */
+    static uint8_t findSpare(const uint8_t slot, const uint8_t physical);
+
+    /**
+     * @brief Create the next subkey of #mStaging & start writing it to EEPROM once all are created.
+     * @return (bool): Whether subkeys remain to be created.
+     */
+    static bool expandStep();
+
+    /**
+     * @brief Construct a new KeyStore object.
+     */
+    KeyStore() = default;
+};
+
+#endif // KEY_STORE_H
@@ -13,13 +13,6 @@
 
 #include "defs.h"
 
-#ifdef __cplusplus
-extern "C"
-{  
-#include <avr/pgmspace.h>
-}
-#endif
-
 /**
  * @brief Namespace that contains the following lookup tables: S-Box, (original) inverse S-Box, inverse MixCol matrix.
  * 
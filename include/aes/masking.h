@@ -44,14 +44,25 @@ public:
     /**
      * @brief Initialize the masks & the masked inverse S-Box.
      * 
-     * -# Seed the Random-Number-Generator.
-     * -# Create random m & m' masks.
-     * -# Create the masked inverse S-Box, by calling initInvMaskedSBox().
-     * -# Create random masks m_i', i=1..4.
-     * -# Calculate the corresponding masks m_i, i=1..4 by calling initMixColInputMask().
+     * Finish the refresh that was started in the background by refreshStep(),
+     * or run a complete refresh, if none was started yet.
+     * Afterwards, the masks are consumed & the next call to refreshStep() starts a new refresh.
      */
     void init();
 
+    /**
+     * @brief Perform a single step of refreshing the masks & the masked inverse S-Box.
+     * 
+     * The refresh is split into small steps, so it can be run as a Scheduler job:
+     * -# Seed the Random-Number-Generator, one ADC conversion at a time.
+     * -# Create random m & m' masks & random masks m_i', i=1..4.
+     * -# Create the masked inverse S-Box, #REFRESH_SBOX_CHUNK entries at a time, by calling initInvMaskedSBox().
+     * -# Calculate the corresponding masks m_i, i=1..4, one mask at a time, by calling initMixColInputMask().
+     * 
+     * @return (bool): Whether the refresh is still in progress.
+     */
+    bool refreshStep();
+
     /**
      * @brief Mask the @p subKeys & store the masked keys in @p maskedSubKeys.
      * 
@@ -110,9 +121,23 @@ private:
         uint8_t output; ///< Output mask
     };
 
+    /**
+     * @brief Phases of refreshing the masks.
+     */
+    enum class RefreshPhase : uint8_t
+    {
+        SEED,           ///< Seed the RNG
+        MASKS,          ///< Create the random masks
+        S_BOX,          ///< Create the masked inverse S-Box
+        MIX_COL_MASKS,  ///< Calculate the MixCol input masks
+        READY           ///< All masks are ready to be used
+    };
+
     // ******************************************************************************
     // Private Attributes ***********************************************************
     // ******************************************************************************
+    static constexpr uint16_t REFRESH_SBOX_CHUNK = 16; ///< Number of masked S-Box entries computed in a single refresh step
+
     uint8_t mInvMaskedSBox[SBOX_BYTES]; ///< Inverse S-Box with masked values
     
     /**
@@ -130,6 +155,9 @@ private:
      * the MixCol input masks are noted as m_i, while the output masks are noted as m_i', where i=1..4.
      */
     mask_t mMixColMasks[4]  = {};
+
+    RefreshPhase mRefreshPhase  = RefreshPhase::SEED;   ///< Current phase of the mask refresh
+    uint16_t mRefreshIndex      = 0;                    ///< Progress within the current refresh phase
     
     RNG mRNG;       ///< Random-Number-Generator
     #ifdef DEBUG
@@ -139,21 +167,24 @@ private:
     // Private Methods **************************************************************
     // ******************************************************************************
     /**
-     * @brief Compute the (inverse) masked S-Box.
+     * @brief Compute a part of the (inverse) masked S-Box.
      * 
      * Masking is done as follows: S_masked(x + m') = S(x) + m, where x is any index of the S-Box.
      * @see "Power Analysis Attacks" by Mangard et. al. p. 228 ff.
      * @param[out] maskedSBox (uint8_t*): The masked S-Box.
      * @param[in] subByteMask (const @ref mask_t): Masks m & m'. 
+     * @param[in] first (const uint16_t): First S-Box index to compute.
+     * @param[in] count (const uint16_t): Number of S-Box entries to compute.
      */
-    void initInvMaskedSBox(uint8_t maskedSBox[], const mask_t &subByteMask) const;
+    void initInvMaskedSBox(uint8_t maskedSBox[], const mask_t &subByteMask, const uint16_t first, const uint16_t count) const;
 
     /**
-     * @brief Compute masks m_i, i=1..4, by performing a MixCol operation on masks m_i'.
+     * @brief Compute mask m_i by performing a MixCol operation on masks m_i'.
      * @see "Power Analysis Attacks" by Mangard et. al. p. 228 ff.
      * @param[inout] mixColMasks ( @ref mask_t): Masks m_i & m_i'. 
+     * @param[in] row (const uint8_t): Index i of the mask to compute.
      */
-    void initMixColInputMask(mask_t mixColMasks[]) const;
+    void initMixColInputMask(mask_t mixColMasks[], const uint8_t row) const;
 };
 
 #endif // MASK_H
\ No newline at end of file
@@ -33,14 +33,33 @@ public:
 
     /**
      * @brief Initialize the RNG & underlying ADC.
+     * 
+     * Starts the dummy conversion of the ADC without waiting for it to finish.
      */
     static void init();
 
     /**
      * @brief Seed the RNG by reading the ADC's LSB 8 times.
+     * 
+     * Blocks until the seed is complete, by calling startSeed() & seedStep().
      * @pre Requires init() to be called before.
      */
     void seed();
+
+    /**
+     * @brief Restart seeding the RNG with seedStep().
+     */
+    void startSeed();
+
+    /**
+     * @brief Perform a single, non-blocking step of seeding the RNG.
+     * 
+     * Each call collects at most a single LSB from the ADC & starts the next conversion.
+     * If a conversion is still running, return immediately.
+     * @pre Requires init() & startSeed() to be called before.
+     * @return (bool): Whether all 8 bits of the seed have been read.
+     */
+    bool seedStep();
     
     /**
      * @brief Create a pseudo-random number between 0 and 255.
@@ -51,14 +70,11 @@ public:
     uint8_t rand();
 
 private:
-    uint8_t mRand = 0; ///< The RNG's state
+    static constexpr uint8_t SEED_BITS = 8;    ///< Number of ADC LSBs that make up a seed
 
-    /**
-     * @brief Read the LSB from ADC0.
-     * @pre Requires init() to be called before.
-     * @return (bit_t): The read LSB.
-     */
-    static bit_t readADC();
+    uint8_t mRand       = 0;        ///< The RNG's state
+    uint8_t mSeedBits   = 0;        ///< Number of seed bits that have been read so far
+    bool mConverting    = false;    ///< Whether this RNG started the currently running ADC conversion
 };
 
 #endif // RNG_H
\ No newline at end of file
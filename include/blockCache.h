@@ -0,0 +1,97 @@
+/**
+ * @file blockCache.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the BlockCache class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <string.h>
+
+#include "defs.h"
+
+#if defined(BLOCK_CACHE) && (defined(MASKING) || defined(SHUFFLING) || defined(DUMMY_OPS))
+#error "The block cache answers a repeated block much faster than a decryption & can't be combined with the countermeasures."
+#endif
+
+#ifndef BLOCK_CACHE_SIZE
+#define BLOCK_CACHE_SIZE 4  ///< Default number of cached blocks
+#endif
+
+/**
+ * @brief Class that caches the last decrypted blocks, so retransmitted blocks are answered without decrypting them again.
+ *
+ * If the Terminal times out or receives a corrupted response, it sends the same ciphertext again.
+ * The cache holds the last #SIZE pairs of ciphertext & plaintext of each key slot. Each entry also stores a CRC-8 of its
+ * ciphertext, so a lookup only compares a single byte per entry & the whole block only if the CRC matches.
+ * Entries are replaced round-robin.
+ *
+ * The cache is only compiled if BLOCK_CACHE is defined. It stores plaintexts in SRAM & a cache hit is answered
+ * much faster than a decryption, so it is disabled by default & can't be combined with MASKING, SHUFFLING or DUMMY_OPS.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class BlockCache
+{
+public:
+    static constexpr uint8_t SIZE = BLOCK_CACHE_SIZE;   ///< Number of cached blocks
+    static_assert(SIZE > 0 && SIZE < 0xff, "BLOCK_CACHE_SIZE has to be between 1 & 254");
+
+    /**
+     * @brief Look up the ciphertext @p data of @p slot.
+     *
+     * - On a hit, overwrite @p data with the cached plaintext.
+     * - On a miss, reserve the oldest entry for @p data. Its plaintext is stored with store() after the decryption.
+     *
+     * @param[in] slot (const uint8_t): Key slot of the ciphertext.
+     * @param[in,out] data ( @ref byte_t*): The ciphertext, replaced by the plaintext on a hit.
+     * @return (bool): Whether @p data was found.
+     */
+    static bool lookup(const uint8_t slot, byte_t *data);
+
+    /**
+     * @brief Store the plaintext of the ciphertext, that was reserved by the last missed lookup().
+     * @param[in] data (const @ref byte_t*): The plaintext.
+     */
+    static void store(const byte_t *data);
+
+    /**
+     * @brief Remove & clear all entries, e.g. after a new key was loaded.
+     */
+    static void invalidate();
+
+private:
+    static constexpr uint8_t EMPTY  = 0x00;     ///< Tag of an unused entry, so the zero-initialized cache is empty
+    static constexpr uint8_t NONE   = 0xff;     ///< Value of #mReserved, if no entry is reserved
+
+    /**
+     * @brief A cached block.
+     */
+    struct entry_t
+    {
+        uint8_t tag;                    ///< Key slot + 1 or #EMPTY
+        uint8_t checksum;               ///< CRC-8 of #cipher
+        byte_t cipher[STATE_BYTES];     ///< The ciphertext
+        byte_t plain[STATE_BYTES];      ///< The plaintext
+    };
+
+    static entry_t mEntries[SIZE];  ///< The cached blocks
+    static uint8_t mNext;           ///< Entry to replace next
+    static uint8_t mReserved;       ///< Entry reserved by the last missed lookup() or #NONE
+    static uint8_t mReservedTag;    ///< Tag of the reserved entry
+
+    /**
+     * @brief Construct a new BlockCache object.
+     */
+    BlockCache() = default;
+};
+
+#endif // BLOCK_CACHE_H
@@ -11,15 +11,11 @@
 #ifndef COMM_INTERFACE_H
 #define COMM_INTERFACE_H
 
-#ifdef __cplusplus
-extern "C" 
-{
-    #include <avr/interrupt.h>
-}
-#endif
-
 #include "defs.h"
+#include "communicationISR.h"
 #include "protocol.h"
+#include "scheduler.h"
+#include "statistics.h"
 
 #ifdef DEBUG
 #include "logger.h"
@@ -63,14 +59,40 @@ public:
     void sendATR() { sendBytes(Protocol::ATR_SEQ, Protocol::ATR_LENGTH); }
 
     /**
-     * @brief Receive data to decrypt from the Terminal.
+     * @brief Receive the header of the next command from the Terminal.
      * 
-     * -# Receive the protocol header, #Protocol::DATA_IN_HEADER, by calling receiveProtocolHeader().
-     * -# Receive 16 bytes of data byte-by-byte & send #Protocol::ACK_DATA_IN after each byte.
+     * -# Receive Protocol::HEADER_LENGTH bytes.
+     * -# If the class byte is unknown, reject the command with #Protocol::SW_CLA_UNKNOWN by calling rejectCommand().
      * 
+     * @param[out] header ( @ref byte_t*): Byte array of length Protocol::HEADER_LENGTH to store the header in.
+     * @return (bool): Whether the command was accepted & has to be handled by the caller.
+     */
+    bool receiveCommand(byte_t *header);
+
+    /**
+     * @brief Reject a command by sending a status word & count the rejection in the Statistics.
+     * @param[in] status (const @ref byte_t*): Status word to send, e.g. #Protocol::SW_INS_UNKNOWN.
+     */
+    void rejectCommand(const byte_t *status);
+
+    /**
+     * @brief Receive the data of a command from the Terminal.
+     * 
+     * Receive P3 bytes of data byte-by-byte & send the inverted instruction byte as ACK before each byte.
+     * @pre @p header has to be received by calling receiveCommand() before.
+     * @param[in] header (const @ref byte_t*): Header of the command.
      * @param[out] data ( @ref byte_t*): Byte array to store the received data in. 
      */
-    void receiveDataToDecrypt(byte_t *data);
+    void receiveData(const byte_t *header, byte_t *data);
+
+    /**
+     * @brief Receive data to decrypt from the Terminal.
+     * 
+     * Receive 16 bytes of data byte-by-byte & send #Protocol::ACK_DATA_IN before each byte.
+     * @pre The header #Protocol::DATA_IN_HEADER has to be received by calling receiveCommand() before.
+     * @param[out] data ( @ref byte_t*): Byte array to store the received data in. 
+     */
+    void receiveDataToDecrypt(byte_t *data) { receiveData(Protocol::DATA_IN_HEADER, data); }
     
     /**
      * @brief Send the decrypted data to the Terminal.
@@ -85,6 +107,27 @@ public:
      */
     void sendDecryptedData(const byte_t *data);
 
+    /**
+     * @brief Send the data requested by a command with outgoing data, e.g. #Protocol::INS_GET_DATA.
+     * 
+     * -# If P3 of @p header does not equal @p len, send #Protocol::SW_WRONG_LE & @p len,
+     *    so the Terminal can repeat the command with the correct length.
+     * -# Otherwise send the instruction byte as acknowledge.
+     * -# Send @p data byte by byte.
+     * -# Send #Protocol::SW_OK.
+     * 
+     * @param[in] header (const @ref byte_t*): Header of the command.
+     * @param[in] data (const @ref byte_t*): Data to send.
+     * @param[in] len (const uint8_t): Length of @p data.
+     */
+    void sendResponseData(const byte_t *header, const byte_t *data, const uint8_t len);
+
+    /**
+     * @brief Send a status word to the Terminal.
+     * @param[in] status (const @ref byte_t*): Status word with Protocol::RESPONSE_LENGTH bytes.
+     */
+    void sendStatus(const byte_t *status) { sendBytes(status, Protocol::RESPONSE_LENGTH); }
+
 private:
     // ******************************************************************************
     // Private Subclasses ***********************************************************
@@ -104,13 +147,10 @@ private:
         /**
          * @brief Initialize the Timer class.
          * 
-         * - Copy the address of the provided Communication pointer, @p comm to #mComm.
-         * - Set-up the timer: Enable CTC mode, enable Output Compare Match A Interrupts
-         *   & set the match value to #ETU.
-         * 
-         * @param[in] comm (Communication *): Communication pointer. 
+         * Set-up the timer: Enable CTC mode, enable Output Compare Match A Interrupts
+         * & set the match value to #ETU.
          */
-        static void init(Communication *comm);
+        static void init();
         
         /**
          * @brief Stop the 16-bit timer by setting no clock source.
@@ -140,17 +180,31 @@ private:
          */
         static constexpr uint16_t ETU = 372/1;
 
+        /**
+         * @brief Match value after a start bit, to sample each bit in the middle.
+         *
+         * 1.5 ETU minus the cycles from the compare match to the sampling in serviceRoutine().
+         */
+        static constexpr uint16_t START_BIT_MATCH = ETU*3/2-50;
+
+        /**
+         * @brief Value of TCCR1B while the timer is running: CTC mode & clock source CS10.
+         */
+        static constexpr uint8_t RUNNING = COMM_TIMER_RUNNING;
+
     private:
         // Private Attributes *******************************************************
-        static Communication *mComm;                            ///< Communication object to access the class methods & attributes
         static constexpr uint16_t TIMER_BOTTOM = 0x0000;        ///< Timer bottom value
 
         // Private Methods **********************************************************
         /**
          * @brief Interrupt Service Routine for the 16-bit timer. 
          *        An interrupt is triggered if the timer hits the value stored in OCR1A.
+         *
+         * All state is accessed through the GPIORs & all called functions are inlined,
+         * so the prologue only saves the few registers that are actually used.
          */
-        static void serviceRoutine() __asm__("__vector_13") __attribute__((__signal__, __used__, __externally_visible__));
+        static void serviceRoutine() HAL_ISR(__vector_13);
     };
 
     /**
@@ -168,41 +222,71 @@ private:
         /**
          * @brief Initialize the IOPin class.
          * 
-         * - Copy the address of the provided Communication pointer, @p comm to #mComm.
-         * - Enable interrupts for Pins 8-15.
-         * 
-         * @param[in] comm (Communication *): Communication pointer. 
+         * Set the Pin to input & activate its pull-up resistor.
          */
-        static void init(Communication *comm);
+        static void init();
         
         /**
          * @brief Set logical level of the Pin.
          * @param[in] bit (const @ref bit_t): Level to set (0 or 1). 
          */
-        static void setLevel(const bit_t bit);
+        static void setLevel(const bit_t bit)
+        {
+            if(bit) SET_BIT(PORTB, PB6);    // Set Pin to high
+            else    CLR_BIT(PORTB, PB6);    // Set Pin to low
+        }
 
         /**
-         * @brief Set the direction of the Pin.
+         * @brief Set the direction of the Pin & #FLAG_DIRECTION_INPUT accordingly.
          * @param[in] direction (const ::PinDir): Direction to set (PinDir::INPUT or PinDir::OUTPUT). 
          */
-        static void setDirection(const PinDir direction);
+        static void setDirection(const PinDir direction)
+        {
+            if(direction == PinDir::INPUT)
+            {
+                CLR_BIT(DDRB, DDB6);    // Set direction for I/O-Pin to input
+                SET_BIT(COMM_FLAGS, FLAG_DIRECTION_INPUT);
+            }
+            else
+            {
+                SET_BIT(DDRB, DDB6);    // Set direction for I/O-Pin to output
+                CLR_BIT(COMM_FLAGS, FLAG_DIRECTION_INPUT);
+            }
+        }
 
         /**
          * @brief Enable/disable interrupts for the Pin.
          * @param[in] enabled (const bool): Whether interrupts should be enabled or not. 
          */
-        static void setInterrupt(const bool enabled);
+        static void setInterrupt(const bool enabled)
+        {
+            if(enabled)
+            {
+                SET_BIT(PCICR, PCIE1);      // Enable interrupts for pins PCINT15:8
+                SET_BIT(PCMSK1, PCINT14);   // Enable interrupts for PinB6
+            }
+            else
+            {
+                CLR_BIT(PCICR, PCIE1);      // Disable interrupts for Pins PCINT15:8
+                CLR_BIT(PCMSK1, PCINT14);   // Disable interrupts for PinB6
+            }
+        }
     
     private:
-        // Private Attributes *******************************************************
-        static Communication *mComm; ///< Communication object to access the class methods & attributes
-
         // Private Methods **********************************************************
+        #if defined(DEBUG) || !defined(__AVR__)
         /**
          * @brief Interrupt Service Routine for the IOPin. 
          *        An interrupt is triggered if the logic-level of the Pin changes.
+         *
+         * Same as the assembly ISR in communicationISR.S, but logs pin changes that are not a start bit.
+         * It is also used on the host, where the assembly is not available.
          */
-        static void serviceRoutine() __asm__("__vector_5") __attribute__((__signal__, __used__, __externally_visible__));
+        static void serviceRoutine() HAL_ISR(__vector_5);
+        #else
+        /// Timer::START_BIT_MATCH for the ISR in communicationISR.S, which loads it from SRAM
+        static const uint16_t mStartBitMatch __asm__("commStartBitMatch");
+        #endif
     };
 
     // ******************************************************************************
@@ -212,6 +296,18 @@ private:
     static constexpr bit_t START_BIT        = 0;                ///< The start bit of a transfer
     static constexpr bit_t STOP_BIT         = 1;                ///< The stop bit of a transfer
 
+    // Bits of #COMM_FLAGS **********************************************************
+    static constexpr uint8_t FLAG_DIRECTION_INPUT   = COMM_FLAG_DIRECTION_INPUT;  ///< Whether the IOPin is set to input
+    // Output flags
+    static constexpr uint8_t FLAG_BIT_SENT          = 1;        ///< Whether the last bit of a transmission was sent
+    static constexpr uint8_t FLAG_OUTPUT_BIT        = 2;        ///< The next bit to output
+    // Input flags
+    static constexpr uint8_t FLAG_BYTE_RECEIVED     = 3;        ///< Whether a byte was received successfully
+    // Error flags
+    static constexpr uint8_t FLAG_CHECK_ERRORS      = 4;        ///< Whether to check for errors after sending a byte
+    static constexpr uint8_t FLAG_ERROR_BIT         = 5;        ///< Error bit that is set to 0/1 during the stop bit indicating failure/success.
+    static constexpr uint8_t FLAG_PARITY_ERROR      = 6;        ///< Whether a parity error occurred while receiving a byte
+
     // Class Objects ****************************************************************
     friend Timer;   ///< 16-bit Timer/Counter
     friend IOPin;   ///< IOPin (PinB6)
@@ -219,20 +315,6 @@ private:
     Logger mLog;    ///< Logger
     #endif
 
-    // Volatile Attributes **********************************************************
-    volatile PinDir     mDirection          = PinDir::OUTPUT;   ///< Current direction of the IOPin
-    // Output flags/data
-    volatile bool       mBitSent            = true;             ///< Whether the last bit of a transmission was sent
-    volatile bit_t      mOutputBit          = 0;                ///< The next bit to output
-    // Input flags/data
-    volatile bool       mByteReceived       = 0;                ///< Whether a byte was received successfully
-    volatile uint8_t    mInputBitCounter    = 0;                ///< Number of input bits in the current transfer
-    volatile byte_t     mInputByte          = 0x00;             ///< The currently received input byte
-    // Error flags/data
-    volatile bool       mCheckErrors        = false;            ///< Whether to check for errors after sending a byte
-    volatile bit_t      mErrorBit           = 0;                ///< Error bit that is set to 0/1 during the stop bit indicating failure/success.
-    volatile bool       mParityError        = false;            ///< Whether a parity error occurred while receiving a byte
-
     // ******************************************************************************
     // Private Methods **************************************************************
     // ******************************************************************************
@@ -240,9 +322,10 @@ private:
     /**
      * @brief Send a single @p bit to the Terminal.
      * 
-     * -# Wait for the last bit to be sent, (#mBitSent to be true).
-     * -# Set #mOutputBit to @p bit.
-     * -# Set #mBitSent to false.
+     * -# Wait for the last bit to be sent, (#FLAG_BIT_SENT to be set). The CPU sleeps in the meantime,
+     *    background jobs are not run, since the next bit has to be set within a single Timer::ETU.
+     * -# Clear #FLAG_BIT_SENT.
+     * -# Set #FLAG_OUTPUT_BIT to @p bit.
      * 
      * @param[in] bit (const @ref bit_t): The bit to send. 
      */
@@ -259,7 +342,7 @@ private:
      * -# Calculate the parity (getParity()) & send the parity bit.
      * -# Send the #STOP_BIT.
      * -# After half an Timer::ETU, check if the IOPin is low, which indicates a parity error.
-     *    If so, restart at 2.
+     *    If so, count the retransmission in the Statistics & restart at 2.
      * 
      * @param[in] byte (const @ref byte_t): Byte to send. 
      */
@@ -283,7 +366,8 @@ private:
      * 
      * -# Set the direction to input (IOPin::setDirection()) 
      *    & enable interrupts for the IOPin (IOPin::setInterrupt()).
-     * -# Set #mByteReceived to false & wait until it's true again.
+     * -# Clear #FLAG_BYTE_RECEIVED & wait until it's set again.
+     *    While waiting, the Scheduler runs background jobs or puts the CPU to sleep.
      * 
      * @return ( @ref byte_t): The received byte
      */
@@ -291,6 +375,8 @@ private:
 
     /**
      * @brief Receive a protocol header, which contains 5 bytes.
+     * 
+     * If the received header does not match @p header, count the mismatch in the Statistics.
      * @param[in] header (const @ref byte_t*): Header to expect.
      */
     void receiveProtocolHeader(const byte_t *header);
@@ -0,0 +1,32 @@
+/**
+ * @file communicationISR.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Registers & constants shared by the Communication class & its assembly ISR (communicationISR.S).
+ *
+ * The file only contains macros, so it can be included by the assembler.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef COMMUNICATION_ISR_H
+#define COMMUNICATION_ISR_H
+
+/**
+ * @name State shared with the interrupt service routines
+ *
+ * The state is kept in the general purpose I/O registers instead of SRAM, so the ISRs don't need a pointer to it.
+ * GPIOR0 lies in the bit-addressable I/O space: Each flag is set, cleared & tested with a single SBI/CBI/SBIS/SBIC,
+ * which is also atomic. GPIOR1 & GPIOR2 are read & written with a single IN/OUT.
+ * @{
+ */
+#define COMM_FLAGS          GPIOR0  ///< Flags, see Communication::FLAG_DIRECTION_INPUT ff.
+#define COMM_BIT_COUNTER    GPIOR1  ///< Number of input bits in the current transfer
+#define COMM_INPUT_BYTE     GPIOR2  ///< The currently received input byte
+/** @} */
+
+#define COMM_FLAG_DIRECTION_INPUT   0                           ///< Bit of #COMM_FLAGS, see Communication::FLAG_DIRECTION_INPUT
+#define COMM_TIMER_RUNNING          ((1<<WGM12) | (1<<CS10))    ///< TCCR1B while the timer runs, see Communication::Timer::RUNNING
+
+#endif // COMMUNICATION_ISR_H
@@ -0,0 +1,71 @@
+/**
+ * @file cycleCounter.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the CycleCounter class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include "defs.h"
+
+/**
+ * @brief Class that counts CPU clock cycles with the ATmega644's 16-bit Timer1.
+ *
+ * Timer1 is normally used by the Communication class to time the ETUs of a transfer.
+ * While the card is not communicating (e.g. during a decryption), it is free & can be used to count cycles instead.
+ * The timer runs without a prescaler in normal mode. Its overflows are counted in an ISR,
+ * which extends the counter to 32 bits.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class CycleCounter
+{
+public:
+    /**
+     * @brief Start counting cycles.
+     *
+     * -# Save the current Timer1 configuration.
+     * -# Reset the counter & switch Timer1 to normal mode with overflow interrupts.
+     * -# Start Timer1 without a prescaler.
+     *
+     * @pre Timer1 must not be used by the Communication class in the meantime.
+     */
+    static void start();
+
+    /**
+     * @brief Get the number of cycles since start() was called.
+     * @return (uint32_t): Number of elapsed clock cycles.
+     */
+    static uint32_t now();
+
+    /**
+     * @brief Stop counting cycles & restore the previous Timer1 configuration.
+     * @return (uint32_t): Number of clock cycles since start() was called.
+     */
+    static uint32_t stop();
+
+private:
+    static volatile uint16_t mOverflows;    ///< Number of Timer1 overflows since start()
+    static uint8_t mSavedTCCR1B;            ///< Timer1 control register B before start()
+    static uint8_t mSavedTIMSK1;            ///< Timer1 interrupt mask before start()
+
+    /**
+     * @brief Interrupt Service Routine for the Timer1 overflow.
+     */
+    static void overflowRoutine() HAL_ISR(__vector_15);
+
+    /**
+     * @brief Construct a new CycleCounter object.
+     */
+    CycleCounter() = default;
+};
+
+#endif // CYCLE_COUNTER_H
\ No newline at end of file
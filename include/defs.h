@@ -15,13 +15,8 @@
 #include <stdio.h>
 #include <stdint.h>
 
-// C Includes
-#ifdef __cplusplus
-extern "C"
-{   
-    #include <avr/io.h>
-}
-#endif
+// Hardware abstraction layer (AVR or host)
+#include "hal/hal.h"
 
 #define SET_BIT(reg, pos) reg |= (1<<pos)           ///< Set a single bit at a specific position
 #define CLR_BIT(reg, pos) reg &= ~(1<<pos)          ///< Clear a single bit at a specific position
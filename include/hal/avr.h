@@ -0,0 +1,31 @@
+/**
+ * @file avr.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief AVR backend of the hardware abstraction layer, which maps it to avr-libc.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef HAL_AVR_H
+#define HAL_AVR_H
+
+#ifdef __cplusplus
+extern "C"
+{
+    #include <avr/io.h>
+    #include <avr/interrupt.h>
+    #include <avr/pgmspace.h>
+    #include <avr/sleep.h>
+    #include <avr/eeprom.h>
+    #include <util/crc16.h>
+}
+#endif
+
+/**
+ * @brief Attributes to declare a static member function as the interrupt service routine of @p vector, e.g. `__vector_13`.
+ */
+#define HAL_ISR(vector) __asm__(#vector) __attribute__((__signal__, __used__, __externally_visible__))
+
+#endif // HAL_AVR_H
@@ -0,0 +1,29 @@
+/**
+ * @file hal.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Hardware abstraction layer, that selects the AVR or the host backend.
+ *
+ * Both backends provide the same interface:
+ * - The I/O registers & their bit positions of the ATmega644, e.g. PORTB & PB6.
+ * - Interrupts: sei(), cli() & HAL_ISR() to declare an interrupt service routine.
+ * - Sleep modes: set_sleep_mode(), sleep_enable(), sleep_cpu() & sleep_disable().
+ * - Flash & EEPROM: PROGMEM, pgm_read_byte(), EEMEM, eeprom_read_byte() & friends.
+ * - _crc8_ccitt_update().
+ *
+ * The AVR backend is avr-libc, the host backend emulates the hardware (see hal/host.h).
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#ifdef __AVR__
+#include "hal/avr.h"
+#else
+#include "hal/host.h"
+#endif
+
+#endif // HAL_H
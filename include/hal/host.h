@@ -0,0 +1,201 @@
+/**
+ * @file host.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Host backend of the hardware abstraction layer, that emulates the hardware of the ATmega644.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Emulated I/O register of the ATmega644.
+ *
+ * The register can be read & written like the volatile registers of avr-libc. Optional hooks are called
+ * before every read & after every write, so the HostHardware can emulate peripherals such as the ADC.
+ * Hooks access the raw value with #value, which doesn't call the hooks again.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+template<typename T>
+class HostRegister
+{
+public:
+    typedef void (*hook_t)(HostRegister &reg);  ///< Hook that is called on an access
+
+    volatile T value = 0;       ///< Raw value of the register
+    hook_t onRead = nullptr;    ///< Hook that is called before every read
+    hook_t onWrite = nullptr;   ///< Hook that is called after every write
+
+    operator T() { if(onRead) onRead(*this); return value; }
+    HostRegister &operator=(const T newValue) { value = newValue; if(onWrite) onWrite(*this); return *this; }
+    HostRegister &operator|=(const int bits) { return *this = static_cast<T>(*this | bits); }
+    HostRegister &operator&=(const int bits) { return *this = static_cast<T>(*this & bits); }
+    HostRegister &operator^=(const int bits) { return *this = static_cast<T>(*this ^ bits); }
+};
+
+/**
+ * @brief Class that emulates the hardware of the ATmega644 on the host.
+ *
+ * - The I/O registers are HostRegister objects. By default, an ADC conversion finishes immediately with a noisy result.
+ * - There are no asynchronous interrupts: sleep_cpu() calls #sleepHook, e.g. to let a simulated Terminal
+ *   advance the time & call the ISRs, which keep their vector names as symbols (e.g. `__vector_13`).
+ * - The EEPROM is emulated in SRAM & erased (0xff) before main() is called.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class HostHardware
+{
+public:
+    // Port B
+    static HostRegister<uint8_t> portB;     ///< PORTB
+    static HostRegister<uint8_t> ddrB;      ///< DDRB
+    static HostRegister<uint8_t> pinB;      ///< PINB
+    // Timer1
+    static HostRegister<uint8_t> tccr1A;    ///< TCCR1A
+    static HostRegister<uint8_t> tccr1B;    ///< TCCR1B
+    static HostRegister<uint8_t> timsk1;    ///< TIMSK1
+    static HostRegister<uint8_t> tifr1;     ///< TIFR1
+    static HostRegister<uint16_t> tcnt1;    ///< TCNT1
+    static HostRegister<uint16_t> ocr1A;    ///< OCR1A
+    // Pin change interrupts
+    static HostRegister<uint8_t> pcicr;     ///< PCICR
+    static HostRegister<uint8_t> pcifr;     ///< PCIFR
+    static HostRegister<uint8_t> pcmsk1;    ///< PCMSK1
+    // ADC
+    static HostRegister<uint8_t> adcsrA;    ///< ADCSRA
+    static HostRegister<uint8_t> admux;     ///< ADMUX
+    static HostRegister<uint8_t> adcL;      ///< ADCL
+    static HostRegister<uint8_t> adcH;      ///< ADCH
+    // USART0
+    static HostRegister<uint8_t> ucsr0A;    ///< UCSR0A
+    static HostRegister<uint8_t> ucsr0B;    ///< UCSR0B
+    static HostRegister<uint8_t> ucsr0C;    ///< UCSR0C
+    static HostRegister<uint8_t> ubrr0H;    ///< UBRR0H
+    static HostRegister<uint8_t> ubrr0L;    ///< UBRR0L
+    static HostRegister<uint8_t> udr0;      ///< UDR0
+    // CPU
+    static HostRegister<uint8_t> sreg;      ///< SREG
+    static HostRegister<uint8_t> mcusr;     ///< MCUSR
+    // The general purpose I/O registers are plain bytes, since Scheduler::waitFor() takes a reference to them
+    static volatile uint8_t gpior0;         ///< GPIOR0
+    static volatile uint8_t gpior1;         ///< GPIOR1
+    static volatile uint8_t gpior2;         ///< GPIOR2
+
+    static void (*sleepHook)();             ///< Called by sleep_cpu(), if set
+
+    /**
+     * @brief Erase the emulated EEPROM, i.e. set all bytes to 0xff.
+     */
+    static void eraseEeprom();
+
+private:
+    /**
+     * @brief Construct a new HostHardware object.
+     */
+    HostHardware() = default;
+};
+
+// Registers ************************************************************************
+#define PORTB   (HostHardware::portB)
+#define DDRB    (HostHardware::ddrB)
+#define PINB    (HostHardware::pinB)
+#define TCCR1A  (HostHardware::tccr1A)
+#define TCCR1B  (HostHardware::tccr1B)
+#define TIMSK1  (HostHardware::timsk1)
+#define TIFR1   (HostHardware::tifr1)
+#define TCNT1   (HostHardware::tcnt1)
+#define OCR1A   (HostHardware::ocr1A)
+#define PCICR   (HostHardware::pcicr)
+#define PCIFR   (HostHardware::pcifr)
+#define PCMSK1  (HostHardware::pcmsk1)
+#define ADCSRA  (HostHardware::adcsrA)
+#define ADMUX   (HostHardware::admux)
+#define ADCL    (HostHardware::adcL)
+#define ADCH    (HostHardware::adcH)
+#define UCSR0A  (HostHardware::ucsr0A)
+#define UCSR0B  (HostHardware::ucsr0B)
+#define UCSR0C  (HostHardware::ucsr0C)
+#define UBRR0H  (HostHardware::ubrr0H)
+#define UBRR0L  (HostHardware::ubrr0L)
+#define UDR0    (HostHardware::udr0)
+#define SREG    (HostHardware::sreg)
+#define MCUSR   (HostHardware::mcusr)
+#define GPIOR0  (HostHardware::gpior0)
+#define GPIOR1  (HostHardware::gpior1)
+#define GPIOR2  (HostHardware::gpior2)
+
+// Bit positions ********************************************************************
+enum { PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7 };
+enum { DDB0, DDB1, DDB2, DDB3, DDB4, DDB5, DDB6, DDB7 };
+enum { PINB0, PINB1, PINB2, PINB3, PINB4, PINB5, PINB6, PINB7 };
+enum { CS10, CS11, CS12, WGM12, WGM13 };                    // TCCR1B
+enum { TOIE1, OCIE1A, OCIE1B };                             // TIMSK1
+enum { TOV1, OCF1A, OCF1B };                                // TIFR1
+enum { PCIE0, PCIE1, PCIE2, PCIE3 };                        // PCICR
+enum { PCIF0, PCIF1, PCIF2, PCIF3 };                        // PCIFR
+enum { PCINT8, PCINT9, PCINT10, PCINT11, PCINT12, PCINT13, PCINT14, PCINT15 };  // PCMSK1
+enum { ADPS0, ADPS1, ADPS2, ADIE, ADIF, ADATE, ADSC, ADEN }; // ADCSRA
+enum { MPCM0, U2X0, UPE0, DOR0, FE0, UDRE0, TXC0, RXC0 };   // UCSR0A
+enum { TXB80, RXB80, UCSZ02, TXEN0, RXEN0, UDRIE0, TXCIE0, RXCIE0 };  // UCSR0B
+enum { UCPOL0, UCSZ00, UCSZ01, USBS0, UPM00, UPM01 };       // UCSR0C
+enum { SREG_C, SREG_Z, SREG_N, SREG_V, SREG_S, SREG_H, SREG_T, SREG_I };
+
+// Interrupts ***********************************************************************
+#define sei() (SREG |= (1<<SREG_I))         ///< Enable interrupts
+#define cli() (SREG &= ~(1<<SREG_I))        ///< Disable interrupts
+
+/**
+ * @brief The ISR keeps its vector name as symbol, so a host harness can call it.
+ */
+#define HAL_ISR(vector) __asm__(#vector) __attribute__((__used__))
+
+// Sleep modes **********************************************************************
+#define SLEEP_MODE_IDLE 0
+#define set_sleep_mode(mode)    ((void)(mode))
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()             do { if(HostHardware::sleepHook) HostHardware::sleepHook(); } while(0)
+
+// Flash ****************************************************************************
+#define PROGMEM
+#define pgm_read_byte(address)  (*reinterpret_cast<const uint8_t*>(address))
+
+// EEPROM ***************************************************************************
+#define EEMEM __attribute__((__section__("hal_eeprom")))    ///< Emulated EEPROM, see HostHardware::eraseEeprom()
+
+inline int eeprom_is_ready() { return 1; }
+inline uint8_t eeprom_read_byte(const uint8_t *address) { return *address; }
+inline void eeprom_read_block(void *data, const void *address, const size_t len) { memcpy(data, address, len); }
+inline void eeprom_write_byte(uint8_t *address, const uint8_t value) { *address = value; }
+inline void eeprom_update_byte(uint8_t *address, const uint8_t value) { *address = value; }
+
+// CRC ******************************************************************************
+/**
+ * @brief CRC-8 with the polynomial 0x07, same as in avr-libc.
+ * @param[in] crc (uint8_t): Current CRC.
+ * @param[in] data (const uint8_t): Next byte.
+ * @return (uint8_t): The updated CRC.
+ */
+inline uint8_t _crc8_ccitt_update(uint8_t crc, const uint8_t data)
+{
+    crc ^= data;
+    for(uint8_t i=0; i<8; i++)
+        crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+    return crc;
+}
+
+#endif // HAL_HOST_H
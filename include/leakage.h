@@ -0,0 +1,54 @@
+/**
+ * @file leakage.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the Leakage hooks & the leakage macros.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef LEAKAGE_H
+#define LEAKAGE_H
+
+#include "defs.h"
+
+#ifdef LEAKAGE
+#ifdef __AVR__
+#error "LEAKAGE is only supported by the host build."
+#endif
+
+/**
+ * @brief Hooks, that observe the intermediates of the AES decryption on the host, e.g. to simulate power traces.
+ *
+ * Every byte of a state, that AES::addRoundKey(), AES::invMixCols() (each accumulated product) & AES::invByteSub()
+ * write, is passed to #onWrite with its old & new value, in the order of the writes. With MASKING, these are the
+ * masked values. The dummy ops of Hiding are passed to #onIdle with their number of NOPs. After the AddRoundKey of
+ * each round, the whole state is passed to #onRound with the index of the round key, from #ROUNDS down to 0.
+ * Like the emulated hardware, the hooks are global.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class Leakage
+{
+public:
+    static void (*onWrite)(const uint8_t before, const uint8_t after);  ///< Called for every written intermediate, if set
+    static void (*onIdle)(const uint8_t nops);                          ///< Called for every dummy op, if set
+    static void (*onRound)(const uint8_t round, const state_t state);   ///< Called after every AddRoundKey, if set
+};
+
+#define LEAK_BEFORE(name, value)    const uint8_t name = (value)                                        ///< Keep the old value of an intermediate, if LEAKAGE is defined
+#define LEAK_WRITE(before, after)   do { if(Leakage::onWrite) Leakage::onWrite(before, after); } while(0) ///< Report a written intermediate, if LEAKAGE is defined
+#define LEAK_IDLE(nops)             do { if(Leakage::onIdle) Leakage::onIdle(nops); } while(0)          ///< Report a dummy op, if LEAKAGE is defined
+#define LEAK_ROUND(round, states, nStates) do { if(Leakage::onRound) for(uint8_t s=0; s<(nStates); s++) Leakage::onRound(round, (states)[s]); } while(0) ///< Report the states after an AddRoundKey, if LEAKAGE is defined
+#else
+#define LEAK_BEFORE(name, value)                                                                        ///< Keep the old value of an intermediate, if LEAKAGE is defined
+#define LEAK_WRITE(before, after)                                                                       ///< Report a written intermediate, if LEAKAGE is defined
+#define LEAK_IDLE(nops)                                                                                 ///< Report a dummy op, if LEAKAGE is defined
+#define LEAK_ROUND(round, states, nStates)                                                              ///< Report the states after an AddRoundKey, if LEAKAGE is defined
+#endif // LEAKAGE
+
+#endif // LEAKAGE_H
@@ -0,0 +1,36 @@
+/**
+ * @file logEvents.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the events of the Logger, shared with the host-side decoder (tools/log).
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef LOG_EVENTS_H
+#define LOG_EVENTS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Events the Logger writes into its ring buffer.
+ *
+ * Each record consists of the event id, the length of the payload & the payload itself.
+ * Multi-byte values in a payload are little-endian. New events must only be appended,
+ * so older logs can still be decoded.
+ */
+enum class LogEvent : uint8_t
+{
+    DROPPED             = 0x01, ///< Records were dropped, because the buffer was full. Payload: number of records (uint8_t)
+    BOOT                = 0x02, ///< The Logger was initialized. No payload
+    PIN_NOT_INPUT       = 0x03, ///< A pin change occurred, while the I/O-Pin was set to output. No payload
+    MISSED_START_BIT    = 0x04, ///< A pin change occurred, that was not a start bit (or an error signal). No payload
+    COMMAND_REJECTED    = 0x05, ///< A command was rejected. Payload: the status word (2 bytes)
+    HEADER_MISMATCH     = 0x06, ///< A header byte did not match. Payload: received byte, expected byte, position
+    RECEIVED_DATA       = 0x07, ///< Data to decrypt was received. Payload: the data
+    DECRYPTED_DATA      = 0x08, ///< Data was decrypted. Payload: the decrypted data
+    PROFILE_PHASE       = 0x09  ///< Measurements of a profiled phase. Payload: phase index, count, min, max & last cycles (uint16_t), total cycles (uint32_t)
+};
+
+#endif // LOG_EVENTS_H
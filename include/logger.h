@@ -1,9 +1,9 @@
 /**
  * @file logger.h
- * 
+ *
  * @authors Philipp Karg (philipp.karg@tum.de)
- * 
- * @brief File containing a Logger class using UART.
+ *
+ * @brief File containing a Logger class, that buffers binary log records in SRAM.
  * @date 02.06.2022
  * @copyright Philipp Karg 2022
  */
@@ -14,26 +14,39 @@
 #include <string.h>
 
 #include "defs.h"
+#include "logEvents.h"
 
 /**
- * @brief Logger class that outputs logs over USART.
+ * @brief Logger class that writes binary log records into a ring buffer in SRAM.
+ *
+ * A record consists of a ::LogEvent, the length of the payload & the raw payload bytes, so logging only costs
+ * a few cycles per byte. The records are formatted on the host by the decoder in `tools/log`.
+ * If the buffer is full, records are dropped & counted in a LogEvent::DROPPED record.
+ *
+ * - If LOG_USART is defined, the buffer is drained over USART by the data-register-empty interrupt.
+ * - Otherwise, the Terminal reads the records with a GET DATA command (see Protocol::TAG_LOG).
+ *
+ * Logging is safe in interrupt service routines.
  *
  * @authors Philipp Karg (philipp.karg@tum.de)
- * 
+ *
  * @date 02.06.2022
  * @copyright Philipp Karg 2022
  */
 class Logger
 {
 public:
+    static constexpr uint8_t BUFFER_SIZE = 128;     ///< Size of the ring buffer, must be a power of 2
+
     /**
      * @brief Construct a new Logger object.
      */
     Logger() = default;
 
     /**
-     * @brief Initialize USART.
-     * 
+     * @brief Initialize the Logger & write a LogEvent::BOOT record.
+     *
+     * If LOG_USART is defined, initialize USART:
      * -# Enable double speed.
      * -# Set baud-rate in both UBRR registers with #UBRR0_VALUE.
      * -# Enable the transmitter.
@@ -42,46 +55,69 @@ public:
     void init();
 
     /**
-     * @brief Functor to log a string.
-     * @param[in] str (const char*): String to log. 
+     * @brief Functor to log an event.
+     * @param[in] event (const ::LogEvent): Event to log.
+     * @param[in] data (const uint8_t*): Payload of the event.
+     * @param[in] len (const uint8_t): Length of the payload.
      */
-    void operator()(const char* str) const { sendStr(str); }
+    void operator()(const LogEvent event, const uint8_t *data = nullptr, const uint8_t len = 0) const;
 
+    #ifndef LOG_USART
     /**
-     * @brief Functor to log an array of hex-values.
-     * @param[in] arr (const uint8_t*): Array of hex values to log. 
-     * @param[in] len (const uint8_t): Length of the array.
+     * @brief Copy the oldest complete records without removing them from the buffer.
+     * @param[out] data (uint8_t*): Buffer for the records.
+     * @param[in] maxLen (const uint8_t): Size of @p data.
+     * @return (uint8_t): Number of copied bytes.
      */
-    void operator()(const uint8_t* arr, const uint8_t len) const;
+    static uint8_t read(uint8_t *data, const uint8_t maxLen);
+
+    /**
+     * @brief Remove the oldest @p len bytes from the buffer, after they were read with read().
+     * @param[in] len (const uint8_t): Number of bytes to remove.
+     */
+    static void remove(const uint8_t len);
+    #endif
 
 private:
     /**
      * @brief UBRR0 value for initializing USART.
-     * 
+     *
      * This value was found through trial and error.
      * According to the data-sheet, this value should be calculated as the following:
      * UBRR0 = f_clk/(16*BAUD) - 1
      * However this did not work with the provided clock-frequency of 3276800 in the manual.
      */
     static constexpr uint16_t UBRR0_VALUE = F_CPU/(8*BAUD)-1;
+    static constexpr uint8_t INDEX_MASK = BUFFER_SIZE-1;    ///< Mask to wrap an index around the ring buffer
+
+    static uint8_t mBuffer[BUFFER_SIZE];    ///< The ring buffer
+    static volatile uint8_t mHead;          ///< Index of the next byte to write
+    static volatile uint8_t mTail;          ///< Index of the oldest byte
+    static uint8_t mDropped;                ///< Number of dropped records, that were not logged yet
+
+    /**
+     * @brief Get the number of free bytes in the buffer.
+     * @return (uint8_t): Number of free bytes.
+     */
+    static uint8_t freeBytes() { return INDEX_MASK - ((mHead - mTail) & INDEX_MASK); }
 
     /**
-     * @brief Transmit a single character over USART.
-     * 
-     * -# Wait for an empty transmit buffer.
-     * -# Write @p c into the buffer.
-     * 
-     * @param[in] c (const char): Character to send.
+     * @brief Append a record to the buffer.
+     * @pre Interrupts have to be disabled & the record has to fit into the buffer.
+     * @param[in] event (const ::LogEvent): Event of the record.
+     * @param[in] data (const uint8_t*): Payload of the record.
+     * @param[in] len (const uint8_t): Length of the payload.
      */
-    void sendChar(const char c) const;
+    static void put(const LogEvent event, const uint8_t *data, const uint8_t len);
 
+    #ifdef LOG_USART
     /**
-     * @brief Transmit a string over USART.
-     * 
-     * Continuously call sendChar() and send each character of @p str.
-     * @param[in] str (const char*): String to send.
+     * @brief Interrupt Service Routine for an empty USART data register.
+     *
+     * Send the oldest byte of the buffer or disable the interrupt, if the buffer is empty.
      */
-    void sendStr(const char* str) const;
+    static void serviceRoutine() HAL_ISR(__vector_21);
+    #endif
 };
 
-#endif // LOGGER_H
\ No newline at end of file
+#endif // LOGGER_H
@@ -0,0 +1,137 @@
+/**
+ * @file profiler.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the Profiler class & the profiling macros.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "defs.h"
+
+#ifdef PROFILING
+#include <stddef.h>
+#include <string.h>
+
+#include "cycleCounter.h"
+
+// Logger
+#ifdef DEBUG
+#include "logger.h"
+#endif
+
+/**
+ * @brief Class that measures the cycles spent in each phase of the AES decryption.
+ *
+ * Each phase is timed with the CycleCounter, which has to be running (it is started by AES::decrypt()).
+ * For every phase, the number of calls, the minimum, maximum & total number of cycles & a histogram are kept
+ * in a single record in SRAM. Its address is fixed at link time & can be found with
+ * `avr-nm -C atmega644.elf | grep Profiler::mRecord`, e.g. to read it in a simulator.
+ * The record can also be read with a GET DATA command (see Protocol::TAG_PROFILE).
+ *
+ * If PROFILING_TRIGGER is defined, the start of each phase is additionally marked on the trigger (JP5) pin:
+ * While the pin is high during a decryption, phase n is marked by n+1 short low pulses.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class Profiler
+{
+public:
+    /**
+     * @brief Phases of the AES decryption.
+     */
+    enum class Phase : uint8_t
+    {
+        ADD_ROUND_KEY   = 0,    ///< AES::addRoundKey()
+        INV_SHIFT_ROWS  = 1,    ///< AES::invShiftRows()
+        INV_BYTE_SUB    = 2,    ///< AES::invByteSub()
+        INV_MIX_COLS    = 3,    ///< AES::invMixCols()
+        MASKING_INIT    = 4,    ///< Initializing the masks & masking the keys & state
+        HIDING_INIT     = 5     ///< Initializing the dummy ops & shuffling the S-Box access
+    };
+
+    static constexpr uint8_t NUM_PHASES     = 6;    ///< Number of phases
+    static constexpr uint8_t HISTOGRAM_BINS = 12;   ///< Number of histogram bins per phase
+    static constexpr uint8_t HISTOGRAM_SHIFT= 5;    ///< Bin i>0 counts the calls with 2^(i+HISTOGRAM_SHIFT-1) to 2^(i+HISTOGRAM_SHIFT)-1 cycles, bin 0 all faster calls
+    static constexpr uint8_t RECORD_VERSION = 1;    ///< Version of #record_t
+
+    /**
+     * @brief Measurements of a single phase. All values are little-endian & saturate instead of overflowing.
+     */
+    struct __attribute__((__packed__)) phase_t
+    {
+        uint16_t count;                         ///< Number of calls
+        uint16_t minCycles;                     ///< Minimum number of cycles per call
+        uint16_t maxCycles;                     ///< Maximum number of cycles per call
+        uint16_t lastCycles;                    ///< Number of cycles of the last call
+        uint32_t totalCycles;                   ///< Total number of cycles of all calls
+        uint16_t histogram[HISTOGRAM_BINS];     ///< Histogram of the number of cycles per call
+    };
+
+    /**
+     * @brief Record of all measurements, as it is sent to the Terminal.
+     */
+    struct __attribute__((__packed__)) record_t
+    {
+        uint8_t version;                        ///< Version of the record format, #RECORD_VERSION
+        phase_t phases[NUM_PHASES];             ///< Measurements of each phase, indexed by ::Phase
+    };
+
+    /**
+     * @brief Clear all measurements & calibrate the overhead of a measurement.
+     * @pre Timer1 must not be used by the Communication class in the meantime.
+     */
+    static void init();
+
+    /**
+     * @brief Mark the beginning of @p phase.
+     * @param[in] phase (const ::Phase): The phase that begins.
+     */
+    static void begin(const Phase phase);
+
+    /**
+     * @brief Mark the end of @p phase & add the elapsed cycles to its measurements.
+     * @param[in] phase (const ::Phase): The phase that ends.
+     */
+    static void end(const Phase phase);
+
+    /**
+     * @brief Get the record of all measurements.
+     * @return (const @ref record_t&): The measurements.
+     */
+    static const record_t &record() { return mRecord; }
+
+    #ifdef DEBUG
+    /**
+     * @brief Log the number of calls, the minimum, maximum, last & total number of cycles of each phase.
+     * @param[in] logger (const Logger&): Logger to use.
+     */
+    static void log(const Logger &logger);
+    #endif
+
+private:
+    static record_t mRecord;                    ///< All measurements
+    static uint32_t mStart[NUM_PHASES];         ///< Cycle count at the beginning of each phase
+    static uint8_t mOverhead;                   ///< Number of cycles a measurement adds to each phase
+
+    /**
+     * @brief Construct a new Profiler object.
+     */
+    Profiler() = default;
+};
+
+#define PROFILE_BEGIN(phase)    Profiler::begin(Profiler::Phase::phase)     ///< Mark the beginning of a phase, if PROFILING is defined
+#define PROFILE_END(phase)      Profiler::end(Profiler::Phase::phase)       ///< Mark the end of a phase, if PROFILING is defined
+#else
+#define PROFILE_BEGIN(phase)                                                ///< Mark the beginning of a phase, if PROFILING is defined
+#define PROFILE_END(phase)                                                  ///< Mark the end of a phase, if PROFILING is defined
+#endif // PROFILING
+
+#endif // PROFILER_H
\ No newline at end of file
@@ -48,6 +48,29 @@ public:
     static constexpr byte_t RESPONSE_DECRYPTED[]= {0x61, 0x10};                     ///< Response that is sent after the data to decrypt has been received
     static constexpr byte_t RESPONSE_DATA_OUT[] = {0x9d, 0x00};                     ///< Response after sending the decrypted data
     static constexpr uint8_t RESPONSE_LENGTH    = 2;                                ///< Response length
+    // Header fields
+    static constexpr uint8_t CLA_INDEX          = 0;                                ///< Index of the class byte in a header
+    static constexpr uint8_t INS_INDEX          = 1;                                ///< Index of the instruction byte in a header
+    static constexpr uint8_t P1_INDEX           = 2;                                ///< Index of parameter P1 in a header
+    static constexpr uint8_t P2_INDEX           = 3;                                ///< Index of parameter P2 in a header
+    static constexpr uint8_t P3_INDEX           = 4;                                ///< Index of parameter P3 (length) in a header
+    // Instructions
+    static constexpr byte_t INS_DECRYPT         = INS_DATA_IN;                      ///< Instruction to receive data to decrypt (P1 = 0x00, P2 = key slot)
+    static constexpr byte_t INS_LOAD_KEY        = 0xd8;                             ///< Instruction to load a key into a key slot (P1 = 0x00, P2 = key slot)
+    static constexpr byte_t INS_GET_DATA        = 0xca;                             ///< Instruction to read data objects from the card (P1 = 0x00, P2 = tag)
+    // GET DATA tags
+    static constexpr byte_t TAG_COUNTERS        = 0x01;                             ///< GET DATA tag of the Statistics::record_t
+    static constexpr byte_t TAG_PROFILE         = 0x02;                             ///< GET DATA tag of the Profiler::record_t, if PROFILING is defined
+    static constexpr byte_t TAG_LOG             = 0x03;                             ///< GET DATA tag of the Logger records, if DEBUG but not LOG_USART is defined
+    // Status words
+    static constexpr byte_t SW_OK[]             = {0x90, 0x00};                     ///< Command completed successfully
+    static constexpr byte_t SW_WRONG_LENGTH[]   = {0x67, 0x00};                     ///< Wrong length in P3
+    static constexpr byte_t SW_WRONG_LE         = 0x6c;                             ///< First status byte for a wrong length in P3, the second byte is the correct length
+    static constexpr byte_t SW_NOT_FOUND[]      = {0x6a, 0x88};                     ///< Referenced data (e.g. a GET DATA tag or an empty key slot) not found
+    static constexpr byte_t SW_WRONG_P1P2[]     = {0x6b, 0x00};                     ///< Wrong parameters P1-P2
+    static constexpr byte_t SW_BUSY[]           = {0x69, 0x85};                     ///< Conditions of use not satisfied, e.g. another key is still being loaded
+    static constexpr byte_t SW_INS_UNKNOWN[]    = {0x6d, 0x00};                     ///< Instruction not supported
+    static constexpr byte_t SW_CLA_UNKNOWN[]    = {0x6e, 0x00};                     ///< Class not supported
 };
 
 #endif // PROTOCOL_H
\ No newline at end of file
@@ -0,0 +1,133 @@
+/**
+ * @file scheduler.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the Scheduler class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "defs.h"
+
+/**
+ * @brief Small cooperative scheduler that is used instead of busy-waiting.
+ *
+ * Whenever the card has to wait for an interrupt (e.g. for the next bit or byte of a transfer),
+ * it calls waitFor(). While waiting, the scheduler runs single steps of the registered background jobs,
+ * e.g. refreshing the masks for the next decryption. If no job has any work left,
+ * the CPU is put into idle sleep mode until the next interrupt (Timer1 or the I/O-Pin's pin-change interrupt) wakes it up.
+ *
+ * Jobs are not preempted. A single step of a job should therefore finish well within one ETU (372 clock cycles),
+ * otherwise the card might miss the start bit of the next byte.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class Scheduler
+{
+public:
+    /**
+     * @brief Type definition for a background job.
+     *
+     * A job performs a single, short step of its work each time it is called.
+     * It returns true as long as it has work left to do & false once it is idle.
+     */
+    typedef bool (*job_t)(void *context);
+
+    static constexpr uint8_t MAX_JOBS = 4;  ///< Maximum number of background jobs
+
+    /**
+     * @brief Register a background job.
+     * @param[in] job (@ref job_t): Job to run while waiting.
+     * @param[in] context (void*): Context that is passed to @p job on every call.
+     * @return (bool): Whether the job was registered, false if #MAX_JOBS jobs are already registered.
+     */
+    static bool addJob(job_t job, void *context);
+
+    /**
+     * @brief Run a single step of the next job that has work left to do.
+     *
+     * Jobs are called round-robin. Nothing is run if global interrupts are disabled (e.g. inside an ISR)
+     * or if yield() is called from within a job.
+     * @return (bool): Whether any job still has work left to do.
+     */
+    static bool yield();
+
+    /**
+     * @brief Wait until the bit @p pos of @p reg is set to @p value by an ISR.
+     *
+     * -# If @p runJobs is true & a job has work left, run a single step of it by calling yield().
+     * -# Otherwise put the CPU to sleep until the next interrupt.
+     * -# Repeat until the bit equals @p value.
+     *
+     * It is always inlined, so with a constant I/O register like #COMM_FLAGS & a constant @p pos, the flag is polled
+     * with a single SBIS/SBIC instead of loading the register through a pointer & shifting the bit mask at runtime.
+     * @pre Global interrupts have to be enabled.
+     * @param[in] reg (const volatile uint8_t&): Register holding the flag, e.g. #COMM_FLAGS.
+     * @param[in] pos (const uint8_t): Position of the flag, that is set by an ISR.
+     * @param[in] value (const bool): Value to wait for.
+     * @param[in] runJobs (const bool): Whether jobs may be run while waiting.
+     *            Set this to false if the caller has to react to the flag within a single ETU.
+     */
+    static inline __attribute__((__always_inline__)) void waitFor(const volatile uint8_t &reg, const uint8_t pos,
+                                                                  const bool value, const bool runJobs)
+    {
+        while(static_cast<bool>(GET_BIT(reg, pos)) != value)
+        {
+            // Only sleep if there is nothing left to precompute
+            if(!runJobs || !yield())
+                sleep(reg, pos, value);
+        }
+    }
+
+private:
+    /**
+     * @brief Structure for a registered job.
+     */
+    struct entry_t
+    {
+        job_t job;      ///< Job function
+        void *context;  ///< Context passed to the job
+    };
+
+    static entry_t mJobs[MAX_JOBS];     ///< Registered jobs
+    static uint8_t mNumJobs;            ///< Number of registered jobs
+    static uint8_t mNextJob;            ///< Index of the job to run next
+    static bool mRunning;               ///< Whether a job is currently running
+
+    /**
+     * @brief Put the CPU into idle sleep mode, unless the bit @p pos of @p reg already equals @p value.
+     *
+     * The flag is checked with interrupts disabled. Since the instruction after sei() is always executed
+     * before any pending interrupt, an interrupt can't slip in between the check & going to sleep.
+     * @param[in] reg (const volatile uint8_t&): Register holding the flag.
+     * @param[in] pos (const uint8_t): Position of the flag, that is set by an ISR.
+     * @param[in] value (const bool): Value to wait for.
+     */
+    static inline __attribute__((__always_inline__)) void sleep(const volatile uint8_t &reg, const uint8_t pos, const bool value)
+    {
+        set_sleep_mode(SLEEP_MODE_IDLE);    // Timers & pin-change interrupts keep running
+        cli();
+        if(static_cast<bool>(GET_BIT(reg, pos)) != value)
+        {
+            sleep_enable();
+            sei();                          // The next instruction is executed before any pending interrupt
+            sleep_cpu();
+            sleep_disable();
+        }
+        sei();
+    }
+
+    /**
+     * @brief Construct a new Scheduler object.
+     */
+    Scheduler() = default;
+};
+
+#endif // SCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,107 @@
+/**
+ * @file statistics.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the Statistics class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <string.h>
+
+#include "defs.h"
+
+/**
+ * @brief Class that keeps performance & link-quality counters of the card.
+ *
+ * The counters are updated by the Communication & AES classes & can be read by the Terminal
+ * with a GET DATA command (see Protocol::INS_GET_DATA & Protocol::TAG_COUNTERS).
+ * They are stored in the `.noinit` section, so they survive a warm reset by the Terminal.
+ * After a power-on reset, the counters are cleared by init().
+ * All counters saturate instead of overflowing.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class Statistics
+{
+public:
+    /**
+     * @brief Record of all counters, as it is sent to the Terminal.
+     *
+     * All values are little-endian. The cycle counts are CPU clock cycles, measured with the CycleCounter.
+     */
+    struct __attribute__((__packed__)) record_t
+    {
+        uint8_t  version;           ///< Version of the record format, #RECORD_VERSION
+        uint32_t blocksDecrypted;   ///< Number of decrypted blocks
+        uint16_t txRetransmits;     ///< Number of bytes that were re-sent, because the Terminal indicated a parity error
+        uint16_t rxParityErrors;    ///< Number of received bytes with a parity error
+        uint16_t headerMismatches;  ///< Number of received protocol headers, that did not match the expected header
+        uint32_t minDecryptCycles;  ///< Minimum number of cycles per decryption
+        uint32_t avgDecryptCycles;  ///< Average number of cycles per decryption, see #AVG_WEIGHT_SHIFT
+        uint32_t maxDecryptCycles;  ///< Maximum number of cycles per decryption
+        uint16_t commandsRejected;  ///< Number of commands, that were rejected with a status word
+    };
+
+    static constexpr uint8_t RECORD_VERSION = 2;    ///< Version of #record_t
+
+    /**
+     * @brief Initialize the counters.
+     *
+     * If the counters don't contain valid data (e.g. after a power-on reset), clear them.
+     */
+    static void init();
+
+    /**
+     * @brief Count a decrypted block.
+     * @param[in] cycles (const uint32_t): Number of cycles the decryption took.
+     */
+    static void blockDecrypted(const uint32_t cycles);
+
+    /**
+     * @brief Count a byte that had to be re-sent.
+     */
+    static void txRetransmit() { if(mRecord.txRetransmits != UINT16_MAX) mRecord.txRetransmits++; }
+
+    /**
+     * @brief Count a received byte with a parity error.
+     */
+    static void rxParityError() { if(mRecord.rxParityErrors != UINT16_MAX) mRecord.rxParityErrors++; }
+
+    /**
+     * @brief Count a received protocol header, that did not match the expected header.
+     */
+    static void headerMismatch() { if(mRecord.headerMismatches != UINT16_MAX) mRecord.headerMismatches++; }
+
+    /**
+     * @brief Count a command, that was rejected with a status word, e.g. an unknown instruction or a wrong length.
+     */
+    static void commandRejected() { if(mRecord.commandsRejected != UINT16_MAX) mRecord.commandsRejected++; }
+
+    /**
+     * @brief Copy the current counters.
+     * @param[out] record (@ref record_t&): Copy of the counters.
+     */
+    static void read(record_t &record);
+
+private:
+    static constexpr uint16_t MAGIC = 0x5c47;      ///< Marks the counters as valid
+    static constexpr uint8_t AVG_WEIGHT_SHIFT = 4; ///< The average is weighted exponentially with 1/2^AVG_WEIGHT_SHIFT per block
+
+    static uint16_t mMagic;         ///< Equals #MAGIC, if #mRecord contains valid data
+    static record_t mRecord;        ///< The counters
+
+    /**
+     * @brief Construct a new Statistics object.
+     */
+    Statistics() = default;
+};
+
+#endif // STATISTICS_H
\ No newline at end of file
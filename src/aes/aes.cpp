@@ -1,41 +1,106 @@
 #include "aes.h"
 
+constexpr uint8_t AES::PARALLEL_BLOCKS;
 uint8_t AES::mRCs[ROUNDS] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
 
 // **********************************************************************************
 // Public Methods *******************************************************************
 // **********************************************************************************
-AES::AES(const aes_key_t masterKey)
+bool AES::selectKey(const uint8_t slot)
 {
-    // If MASKING is defined, create key schedule for mOriginalSubKeys
+    if(slot == mSlot && mGeneration == KeyStore::generation()) return true;
+    // If MASKING is defined, read the key schedule into mOriginalSubKeys
     #ifdef MASKING
-    createKeySchedule(masterKey, mOriginalSubKeys);
+    const bool valid = KeyStore::read(slot, mOriginalSubKeys);
     #else
-    createKeySchedule(masterKey, mSubkeys);
+    const bool valid = KeyStore::read(slot, mSubkeys);
     #endif
+    mSlot = valid ? slot : NO_SLOT;
+    mGeneration = KeyStore::generation();
+    return valid;
 }
 
 void AES::decrypt(uint8_t *cipher)
 {
-    state_t state = {};
-    uint8_t inByte = 0;
-    // Read cipher column by column
-    for(uint8_t col=0; col<WORD_BYTES; col++)
-        for(uint8_t row=0; row<WORD_BYTES; row++)
-            state[row][col] = cipher[inByte++];
+    CycleCounter::start();
+    initCountermeasures();
+    decryptGroup<1>(cipher, cipher);
+    Statistics::blockDecrypted(CycleCounter::stop());
+}
+
+void AES::decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks)
+{
+    if(nBlocks == 0) return;
+    CycleCounter::start();
+    initCountermeasures();
+
+    // Decrypt the blocks in groups of PARALLEL_BLOCKS & the rest one by one
+    size_t block = 0;
+    for(; nBlocks - block >= PARALLEL_BLOCKS; block += PARALLEL_BLOCKS)
+        decryptGroup<PARALLEL_BLOCKS>(&in[block*STATE_BYTES], &out[block*STATE_BYTES]);
+    for(; block < nBlocks; block++)
+        decryptGroup<1>(&in[block*STATE_BYTES], &out[block*STATE_BYTES]);
+
+    const uint32_t cycles = CycleCounter::stop() / nBlocks;
+    for(block=0; block<nBlocks; block++)
+        Statistics::blockDecrypted(cycles);
+}
+
+#if defined(MASKING) || defined(SHUFFLING) || defined(DUMMY_OPS)
+bool AES::precompute(void *aes)
+{
+    AES *self = static_cast<AES*>(aes);
+    // Refresh the masks first & the hiding operations afterwards,
+    // so only a single RNG is seeded from the ADC at a time.
+    #ifdef MASKING
+    if(self->mMasking.refreshStep()) return true;
+    #endif
+    #if defined(SHUFFLING) || defined(DUMMY_OPS)
+    if(self->mHiding.refreshStep()) return true;
+    #endif
+    return false;
+}
+#endif
+
+void AES::createRoundKey(sub_keys_t subKeys, const uint8_t keyIndex)
+{
+    // g-function
+    uint8_t g[WORD_BYTES] =
+    {
+        static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][13]]) ^ mRCs[keyIndex-1]),
+        static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][14]])),
+        static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][15]])),
+        static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][12]]))
+    };
+    // Add g-function to first 4 bytes
+    for(uint8_t i=0; i<WORD_BYTES; i++)
+        subKeys[keyIndex][i] = subKeys[keyIndex-1][i] ^ g[i];
 
+    // For the other bytes, x-or the value from the last subkey
+    // with the byte from the previous word from the current key
+    // E.g: subKeys[1][4] = subKeys[0][4] ^ subKeys[1][0]
+    for(uint8_t i=WORD_BYTES; i<KEY_BYTES; i++)
+        subKeys[keyIndex][i] = subKeys[keyIndex-1][i] ^ subKeys[keyIndex][i-WORD_BYTES];
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+void AES::initCountermeasures()
+{
     // Init Masking *****************************************************************
     #ifdef MASKING
+    PROFILE_BEGIN(MASKING_INIT);
     // Init the masks
     mMasking.init();
     // Mask the keys
     mMasking.maskSubKeys(mOriginalSubKeys, mSubkeys);
-    // Mask the State
-    mMasking.invMaskState(state);
+    PROFILE_END(MASKING_INIT);
     #endif
 
     // Init Hiding *******************************************************************
     #if defined(SHUFFLING) || defined(DUMMY_OPS)
+    PROFILE_BEGIN(HIDING_INIT);
     mHiding.init();
     #endif
 
@@ -43,75 +108,80 @@ void AES::decrypt(uint8_t *cipher)
     #ifdef SHUFFLING
     mHiding.shuffleSBoxAccess(mShuffledSBoxIndices);
     #endif
+    #if defined(SHUFFLING) || defined(DUMMY_OPS)
+    PROFILE_END(HIDING_INIT);
+    #endif
+}
 
-    // Start Decryption **************************************************************
-    // Round 10
-    addRoundKey(mSubkeys[ROUNDS], state);
-    invShiftRows(state);
-    invByteSub(state);
+template<uint8_t N>
+void AES::decryptGroup(const uint8_t *in, uint8_t *out)
+{
+    state_t states[N];
+    // Read cipher column by column
+    for(uint8_t s=0; s<N; s++)
+        for(uint8_t col=0; col<WORD_BYTES; col++)
+            for(uint8_t row=0; row<WORD_BYTES; row++)
+                states[s][row][col] = *in++;
 
-    // Rounds 9-1
-    for(uint8_t round=ROUNDS-1; round>0; round--)
-    {
-        addRoundKey(mSubkeys[round], state);
-        invMixCols(state);
-        // Re-Mask state after inverse MixCol
-        #ifdef MASKING
-        mMasking.invReMaskState(state);
-        #endif
-        invShiftRows(state);
-        invByteSub(state);
-    }
+    // Mask the states
+    #ifdef MASKING
+    for(uint8_t s=0; s<N; s++)
+        mMasking.invMaskState(states[s]);
+    #endif
+    // Each group gets the dummy ops of a whole decryption
+    #ifdef DUMMY_OPS
+    mHiding.restartDummyOps();
+    #endif
 
-    // Last round
-    addRoundKey(mSubkeys[0], state);
+    decryptStates(states);
 
-    // Unmask the state
+    // Unmask the states
     #ifdef MASKING
-    mMasking.invUnMaskState(state);
+    for(uint8_t s=0; s<N; s++)
+        mMasking.invUnMaskState(states[s]);
     #endif
 
-    // Read decrypted data back into cipher array ***********************************
-    inByte = 0;
-    for(uint8_t col=0; col<WORD_BYTES; col++)
-        for(uint8_t row=0; row<WORD_BYTES; row++)
-            cipher[inByte++] = state[row][col];
+    // Write the decrypted data column by column
+    for(uint8_t s=0; s<N; s++)
+        for(uint8_t col=0; col<WORD_BYTES; col++)
+            for(uint8_t row=0; row<WORD_BYTES; row++)
+                *out++ = states[s][row][col];
 }
 
-// **********************************************************************************
-// Private Methods ******************************************************************
-// **********************************************************************************
-// Key Schedule *********************************************************************
-void AES::createKeySchedule(const aes_key_t masterKey, sub_keys_t subKeys) const
+template<uint8_t N>
+void AES::decryptStates(state_t (&states)[N])
 {
-    // The first sub-key is the master-key itself
-    memcpy(subKeys[0], masterKey, KEY_BYTES*sizeof(uint8_t));
+    // Round 10
+    addRoundKey(mSubkeys[ROUNDS], states);
+    LEAK_ROUND(ROUNDS, states, N);
+    invShiftRows(states);
+    invByteSub(states);
 
-    for(uint8_t keyIndex=1; keyIndex <= ROUNDS; keyIndex++)
+    // Rounds 9-1
+    for(uint8_t round=ROUNDS-1; round>0; round--)
     {
-        // g-function
-        uint8_t g[WORD_BYTES] =
-        {
-            static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][13]]) ^ mRCs[keyIndex-1]),
-            static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][14]])),
-            static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][15]])),
-            static_cast<uint8_t>(pgm_read_byte(&LUT::S_BOX[subKeys[keyIndex-1][12]]))
-        };
-        // Add g-function to first 4 bytes
-        for(uint8_t i=0; i<WORD_BYTES; i++)
-            subKeys[keyIndex][i] = subKeys[keyIndex-1][i] ^ g[i];
-
-        // For the other bytes, x-or the value from the last subkey
-        // with the byte from the previous word from the current key
-        // E.g: subKeys[1][4] = subKeys[0][4] ^ subKeys[1][0]
-        for(uint8_t i=WORD_BYTES; i<KEY_BYTES; i++)
-            subKeys[keyIndex][i] = subKeys[keyIndex-1][i] ^ subKeys[keyIndex][i-WORD_BYTES];
+        addRoundKey(mSubkeys[round], states);
+        LEAK_ROUND(round, states, N);
+        invMixCols(states);
+        // Re-Mask state after inverse MixCol
+        #ifdef MASKING
+        for(uint8_t s=0; s<N; s++)
+            mMasking.invReMaskState(states[s]);
+        #endif
+        invShiftRows(states);
+        invByteSub(states);
     }
+
+    // Last round
+    addRoundKey(mSubkeys[0], states);
+    LEAK_ROUND(0, states, N);
 }
 
 // Key Addition Layer ***************************************************************
-void AES::addRoundKey(const aes_key_t roundKey, state_t state)
+template<uint8_t N>
+void AES::addRoundKey(const aes_key_t roundKey, state_t (&states)[N])
 {
+    PROFILE_BEGIN(ADD_ROUND_KEY);
     // Perform some NOPs before the actual operation
     #if defined(DUMMY_OPS)
     mHiding.dummyOp();
@@ -120,44 +190,76 @@ void AES::addRoundKey(const aes_key_t roundKey, state_t state)
     uint8_t keyByte = 0;
     // Add key column by column
     for(uint8_t col=0; col<WORD_BYTES; col++)
+    {
         for(uint8_t row=0; row<WORD_BYTES; row++)
-            // Add each byte of the round key to the state in GF(2^8)
-            state[row][col] ^= roundKey[keyByte++];
+        {
+            // Add each byte of the round key to the states in GF(2^8)
+            const uint8_t key = roundKey[keyByte++];
+            for(uint8_t s=0; s<N; s++)
+            {
+                states[s][row][col] ^= key;
+                LEAK_WRITE(states[s][row][col] ^ key, states[s][row][col]);
+            }
+        }
+    }
+    PROFILE_END(ADD_ROUND_KEY);
 }
 
 // Diffusion Layer ******************************************************************
-void AES::invMixCols(state_t state)
+template<uint8_t N>
+void AES::invMixCols(state_t (&states)[N])
 {
+    PROFILE_BEGIN(INV_MIX_COLS);
     // Perform some NOPs before the actual operation
     #if defined(DUMMY_OPS)
     mHiding.dummyOp();
     #endif
 
-    // Do a matrix matrix multiplication of the inverse Mix-Column matrix & state matrix
-    state_t tempState = {};
+    // Do a matrix matrix multiplication of the inverse Mix-Column matrix & each state matrix,
+    // the multiplications of the states are independent
+    state_t tempStates[N] = {};
     for(uint8_t col=0; col<WORD_BYTES; col++)
+    {
         for(uint8_t row=0; row<WORD_BYTES; row++)
+        {
             for(uint8_t element=0; element<WORD_BYTES; element++)
-                tempState[row][col] ^= AESMath::ffMul(LUT::INV_MIX_COL_MATRIX[row][element], state[element][col]);
+            {
+                const uint8_t factor = LUT::INV_MIX_COL_MATRIX[row][element];
+                for(uint8_t s=0; s<N; s++)
+                {
+                    const uint8_t product = AESMath::ffMul(factor, states[s][element][col]);
+                    tempStates[s][row][col] ^= product;
+                    LEAK_WRITE(tempStates[s][row][col] ^ product, tempStates[s][row][col]);
+                }
+            }
+        }
+    }
 
-    memcpy(state, tempState, sizeof(state_t));
+    memcpy(states, tempStates, sizeof(tempStates));
+    PROFILE_END(INV_MIX_COLS);
 }
 
-void AES::invShiftRows(state_t state)
+template<uint8_t N>
+void AES::invShiftRows(state_t (&states)[N])
 {
+    PROFILE_BEGIN(INV_SHIFT_ROWS);
     // Perform some NOPs before the actual operation
     #if defined(DUMMY_OPS)
     mHiding.dummyOp();
     #endif
 
     // Shift each row right by the row number, 0 for the first row, 1 for the second row etc.
-    for(uint8_t row=0; row<WORD_BYTES; row++)
-        AESMath::rightRotateArray(state[row], WORD_BYTES, row);
+    for(uint8_t s=0; s<N; s++)
+        for(uint8_t row=0; row<WORD_BYTES; row++)
+            AESMath::rightRotateArray(states[s][row], WORD_BYTES, row);
+    PROFILE_END(INV_SHIFT_ROWS);
 }
 
 // Byte Substitution layer **********************************************************
-void AES::invByteSub(state_t state)
+template<uint8_t N>
+void AES::invByteSub(state_t (&states)[N])
 {
+    PROFILE_BEGIN(INV_BYTE_SUB);
     #ifdef DUMMY_OPS
     // Perform some NOPs before the actual operation
     mHiding.dummyOp();
@@ -170,22 +272,32 @@ void AES::invByteSub(state_t state)
         index = mShuffledSBoxIndices[i];
         // The row number is index mod 4, e.g. for 4 the row number is 0.
         // The column number is index / 4, e.g. for 4 the column number is 1.
-        #ifdef MASKING
-        state[index%4][index/4] = mMasking.getInvMaskedSBoxValue(state[index%4][index/4]);
-        #else
-        state[index%4][index/4] = pgm_read_byte(&LUT::INV_S_BOX[state[index%4][index/4]]);
-        #endif
+        for(uint8_t s=0; s<N; s++)
+        {
+            LEAK_BEFORE(before, states[s][index%4][index/4]);
+            #ifdef MASKING
+            states[s][index%4][index/4] = mMasking.getInvMaskedSBoxValue(states[s][index%4][index/4]);
+            #else
+            states[s][index%4][index/4] = pgm_read_byte(&LUT::INV_S_BOX[states[s][index%4][index/4]]);
+            #endif
+            LEAK_WRITE(before, states[s][index%4][index/4]);
+        }
     }
     #else
     // Access the S-Box column by column
     for(uint8_t col=0; col<WORD_BYTES; col++)
         for(uint8_t row=0; row<WORD_BYTES; row++)
-            #ifdef MASKING
-            state[row][col] = mMasking.getInvMaskedSBoxValue(state[row][col]);
-            #else
-            state[row][col] = pgm_read_byte(&LUT::INV_S_BOX[state[row][col]]);
-            #endif
+            for(uint8_t s=0; s<N; s++)
+            {
+                LEAK_BEFORE(before, states[s][row][col]);
+                #ifdef MASKING
+                states[s][row][col] = mMasking.getInvMaskedSBoxValue(states[s][row][col]);
+                #else
+                states[s][row][col] = pgm_read_byte(&LUT::INV_S_BOX[states[s][row][col]]);
+                #endif
+                LEAK_WRITE(before, states[s][row][col]);
+            }
     #endif
-
+    PROFILE_END(INV_BYTE_SUB);
 }
 
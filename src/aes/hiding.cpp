@@ -6,24 +6,74 @@ uint8_t Hiding::DEFAULT_INV_SBOX_INDICES[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 1
 
 void Hiding::init()
 {
-    // Seed RNG *********************************************************************
-    mRNG.seed();
-
-    // Init dummy ops ***************************************************************
+    // Finish the refresh that was started in the background
+    while(refreshStep());
+    // Consume the dummy ops, so the next refresh creates new ones
+    mRefreshPhase = RefreshPhase::SEED;
     #ifdef DUMMY_OPS
-    uint8_t remainingDummyOps = MAX_NUMBER_NO_OPS;
-    // Create an array of random numbers
-    for(uint8_t i=0; i<NUMBER_OPS-1; i++)
+    mNoOpCounter = 0;
+    #endif
+}
+
+bool Hiding::refreshStep()
+{
+    switch(mRefreshPhase)
     {
-        mNumbersDummyOps[i] = mRNG.rand() % (remainingDummyOps/6);
-        remainingDummyOps -= mNumbersDummyOps[i];
-    }
-    mNumbersDummyOps[NUMBER_OPS-1] = remainingDummyOps;
+        // Seed RNG *****************************************************************
+        case RefreshPhase::SEED:
+        {
+            if(mRefreshIndex == 0) mRNG.startSeed();
+            mRefreshIndex = 1;
+            if(mRNG.seedStep())
+            {
+                mRefreshIndex = 0;
+                #ifdef DUMMY_OPS
+                mRemainingDummyOps = MAX_NUMBER_NO_OPS;
+                mRefreshPhase = RefreshPhase::CREATE_NUMBERS;
+                #else
+                mRefreshPhase = RefreshPhase::READY;
+                #endif
+            }
+        }
+        break;
 
-    // With this approach, the first few array entries are more likely to be bigger.
-    // Therefore we also shuffle the array, to eliminate this bias.
-    shuffleArray(mNumbersDummyOps, NUMBER_OPS);
-    #endif
+        // Init dummy ops ***********************************************************
+        #ifdef DUMMY_OPS
+        case RefreshPhase::CREATE_NUMBERS:
+        {
+            // Create an array of random numbers
+            for(uint8_t i=0; i<REFRESH_CHUNK && mRefreshIndex<NUMBER_OPS-1; i++, mRefreshIndex++)
+            {
+                mNumbersDummyOps[mRefreshIndex] = mRNG.rand() % (mRemainingDummyOps/6);
+                mRemainingDummyOps -= mNumbersDummyOps[mRefreshIndex];
+            }
+            if(mRefreshIndex >= NUMBER_OPS-1)
+            {
+                mNumbersDummyOps[NUMBER_OPS-1] = mRemainingDummyOps;
+                mRefreshPhase = RefreshPhase::SHUFFLE_NUMBERS;
+                mRefreshIndex = 0;
+            }
+        }
+        break;
+
+        case RefreshPhase::SHUFFLE_NUMBERS:
+        {
+            // With this approach, the first few array entries are more likely to be bigger.
+            // Therefore we also shuffle the array, to eliminate this bias.
+            shuffleArray(mNumbersDummyOps, NUMBER_OPS, mRefreshIndex, REFRESH_CHUNK);
+            mRefreshIndex += REFRESH_CHUNK;
+            if(mRefreshIndex >= NUMBER_OPS-1)
+            {
+                mRefreshPhase = RefreshPhase::READY;
+                mRefreshIndex = 0;
+            }
+        }
+        break;
+        #endif
+
+        default: break;
+    }
+    return (mRefreshPhase != RefreshPhase::READY);
 }
 
 #ifdef SHUFFLING
@@ -40,19 +90,20 @@ void Hiding::shuffleSBoxAccess(uint8_t indices[])
 void Hiding::dummyOp()
 {
     // Execute as many dummy ops as specified in the array
+    LEAK_IDLE(mNumbersDummyOps[mNoOpCounter]);
     for(uint8_t i=0; i<mNumbersDummyOps[mNoOpCounter]; i++)
         __asm__("nop");
     mNoOpCounter++;
 }
 #endif
 
-void Hiding::shuffleArray(uint8_t array[], const uint8_t size)
+void Hiding::shuffleArray(uint8_t array[], const uint8_t size, const uint8_t first, const uint8_t count)
 {
     // Shuffle the array with Fisher-Yates shuffle
     uint8_t j=0;
-    for(uint8_t i=0; i<size-1; i++)
+    for(uint8_t i=first; i<first+count && i<size-1; i++)
     {
-        j = i + mRNG.rand() / (MAX_RAND / (size - i) + 1);;
+        j = i + mRNG.rand() / (MAX_RAND / (size - i) + 1);
         AESMath::swap(array[i], array[j]);
     }
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "host/aesNI.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "aes.h"
+#include "keyStore.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#define AES_NI_TARGET __attribute__((target("aes,sse2")))  ///< Compile a function with AES-NI, without a global flag
+#endif
+
+constexpr uint8_t AESNI::PARALLEL_BLOCKS;
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void AESNI::setKey(const aes_key_t key)
+{
+    sub_keys_t subKeys;
+    memcpy(subKeys[0], key, KEY_BYTES);
+    for(uint8_t i=1; i<=ROUNDS; i++)
+        AES::createRoundKey(subKeys, i);
+    expand(subKeys);
+    memset(subKeys, 0, sizeof(subKeys));
+}
+
+bool AESNI::selectKey(const uint8_t slot)
+{
+    sub_keys_t subKeys;
+    if(!KeyStore::read(slot, subKeys)) return false;
+    expand(subKeys);
+    memset(subKeys, 0, sizeof(subKeys));
+    return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+bool AESNI::supported()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes");
+}
+
+AES_NI_TARGET void AESNI::decrypt(uint8_t *cipher) const
+{
+    const __m128i *keys = reinterpret_cast<const __m128i*>(mRoundKeys);
+    __m128i state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cipher)), _mm_load_si128(&keys[0]));
+    for(uint8_t round=1; round<ROUNDS; round++)
+        state = _mm_aesdec_si128(state, _mm_load_si128(&keys[round]));
+    state = _mm_aesdeclast_si128(state, _mm_load_si128(&keys[ROUNDS]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(cipher), state);
+}
+
+AES_NI_TARGET void AESNI::decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const
+{
+    const __m128i *keys = reinterpret_cast<const __m128i*>(mRoundKeys);
+    const __m128i *source = reinterpret_cast<const __m128i*>(in);
+    __m128i *destination = reinterpret_cast<__m128i*>(out);
+    size_t block = 0;
+
+    // PARALLEL_BLOCKS independent blocks per round, so the latency of AESDEC is hidden
+    for(; block + PARALLEL_BLOCKS <= nBlocks; block += PARALLEL_BLOCKS)
+    {
+        __m128i state[PARALLEL_BLOCKS];
+        __m128i key = _mm_load_si128(&keys[0]);
+        for(uint8_t i=0; i<PARALLEL_BLOCKS; i++)
+            state[i] = _mm_xor_si128(_mm_loadu_si128(&source[block + i]), key);
+        for(uint8_t round=1; round<ROUNDS; round++)
+        {
+            key = _mm_load_si128(&keys[round]);
+            for(uint8_t i=0; i<PARALLEL_BLOCKS; i++)
+                state[i] = _mm_aesdec_si128(state[i], key);
+        }
+        key = _mm_load_si128(&keys[ROUNDS]);
+        for(uint8_t i=0; i<PARALLEL_BLOCKS; i++)
+            _mm_storeu_si128(&destination[block + i], _mm_aesdeclast_si128(state[i], key));
+    }
+
+    // Remaining blocks one by one
+    for(; block < nBlocks; block++)
+    {
+        if(out != in) memcpy(&destination[block], &source[block], STATE_BYTES);
+        decrypt(reinterpret_cast<uint8_t*>(&destination[block]));
+    }
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+AES_NI_TARGET void AESNI::expand(const sub_keys_t subKeys)
+{
+    // The decryption starts with the last subkey, the keys of the inner rounds are transformed with InvMixColumns
+    __m128i *keys = reinterpret_cast<__m128i*>(mRoundKeys);
+    for(uint8_t round=0; round<=ROUNDS; round++)
+    {
+        const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(subKeys[ROUNDS-round]));
+        _mm_store_si128(&keys[round], (round > 0 && round < ROUNDS) ? _mm_aesimc_si128(key) : key);
+    }
+}
+#else
+// AES-NI is only available on x86, the methods are never called, since supported() is false
+bool AESNI::supported()
+{
+    return false;
+}
+
+void AESNI::decrypt(uint8_t *) const
+{
+    abort();
+}
+
+void AESNI::decryptBlocks(const uint8_t *, uint8_t *, const size_t) const
+{
+    abort();
+}
+
+void AESNI::expand(const sub_keys_t)
+{
+    abort();
+}
+#endif
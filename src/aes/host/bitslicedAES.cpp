@@ -0,0 +1,275 @@
+#include "host/bitslicedAES.h"
+
+#include <string.h>
+
+#include "aes.h"
+#include "keyStore.h"
+
+constexpr uint8_t BitslicedAES::BATCH_BLOCKS;
+
+namespace
+{
+    typedef uint64_t byte_slices_t[8];  ///< Bitsliced byte: slice j holds bit j of the byte of each block
+
+    /**
+     * @brief Transpose an 8x8 bit matrix, whose rows are the bytes of @p x.
+     * @param[in] x (uint64_t): The matrix, bit j of byte k is row k, column j.
+     * @return (uint64_t): The transposed matrix, bit k of byte j is the former row k, column j.
+     */
+    inline uint64_t transpose8(uint64_t x)
+    {
+        uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+        x ^= t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+        x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+        x ^= t ^ (t << 28);
+        return x;
+    }
+
+    /**
+     * @brief Reduce a product of two polynomials modulo the irreducible polynomial x^8 + x^4 + x^3 + x + 1.
+     * @param[inout] p (uint64_t*): The 15 coefficients of the product, destroyed.
+     * @param[out] c (byte_slices_t): The reduced polynomial.
+     */
+    inline void reduce(uint64_t *p, byte_slices_t c)
+    {
+        // x^k = x^(k-8) * (x^4 + x^3 + x + 1)
+        for(uint8_t k=14; k>=8; k--)
+        {
+            p[k-4] ^= p[k];
+            p[k-5] ^= p[k];
+            p[k-7] ^= p[k];
+            p[k-8] ^= p[k];
+        }
+        memcpy(c, p, sizeof(byte_slices_t));
+    }
+
+    /**
+     * @brief Multiply two bitsliced elements of GF(2^8).
+     * @param[in] a (const byte_slices_t): The first factor.
+     * @param[in] b (const byte_slices_t): The second factor.
+     * @param[out] c (byte_slices_t): The product. Must not be @p a or @p b.
+     */
+    inline void gfMul(const byte_slices_t a, const byte_slices_t b, byte_slices_t c)
+    {
+        uint64_t p[15] = {};
+        for(uint8_t i=0; i<8; i++)
+            for(uint8_t j=0; j<8; j++)
+                p[i+j] ^= a[i] & b[j];
+        reduce(p, c);
+    }
+
+    /**
+     * @brief Square a bitsliced element of GF(2^8), which is linear.
+     * @param[in] a (const byte_slices_t): The element.
+     * @param[out] c (byte_slices_t): The square. Must not be @p a.
+     */
+    inline void gfSquare(const byte_slices_t a, byte_slices_t c)
+    {
+        uint64_t p[15] = {};
+        for(uint8_t i=0; i<8; i++)
+            p[2*i] = a[i];
+        reduce(p, c);
+    }
+
+    /**
+     * @brief Inverse S-Box as a circuit: the inverse affine transformation followed by the inversion x^254.
+     * @param[inout] x (byte_slices_t): The bitsliced bytes to substitute.
+     */
+    inline void invSubByte(byte_slices_t x)
+    {
+        // Inverse affine transformation: b_i = x_(i+2) ^ x_(i+5) ^ x_(i+7) ^ bit i of 0x05
+        byte_slices_t t;
+        for(uint8_t i=0; i<8; i++)
+            t[i] = x[(i+2) & 7] ^ x[(i+5) & 7] ^ x[(i+7) & 7];
+        t[0] = ~t[0];
+        t[2] = ~t[2];
+
+        // x^254 = x^-1 (& 0 for 0)
+        byte_slices_t x2, x3, x6, x12, x14, x15, x30, x60, x120, x240;
+        gfSquare(t, x2);
+        gfMul(x2, t, x3);
+        gfSquare(x3, x6);
+        gfSquare(x6, x12);
+        gfMul(x12, x3, x15);
+        gfMul(x12, x2, x14);
+        gfSquare(x15, x30);
+        gfSquare(x30, x60);
+        gfSquare(x60, x120);
+        gfSquare(x120, x240);
+        gfMul(x240, x14, x);
+    }
+
+    /**
+     * @brief Multiply a bitsliced element of GF(2^8) by x.
+     * @param[in] a (const byte_slices_t): The element.
+     * @param[out] b (byte_slices_t): The product. Must not be @p a.
+     */
+    inline void xtime(const byte_slices_t a, byte_slices_t b)
+    {
+        b[0] = a[7];
+        b[1] = a[0] ^ a[7];
+        b[2] = a[1];
+        b[3] = a[2] ^ a[7];
+        b[4] = a[3] ^ a[7];
+        b[5] = a[4];
+        b[6] = a[5];
+        b[7] = a[6];
+    }
+
+    /**
+     * @brief XOR two bitsliced bytes.
+     * @param[in] a (const byte_slices_t): The first byte.
+     * @param[in] b (const byte_slices_t): The second byte.
+     * @param[out] c (byte_slices_t): The sum.
+     */
+    inline void add(const byte_slices_t a, const byte_slices_t b, byte_slices_t c)
+    {
+        for(uint8_t j=0; j<8; j++)
+            c[j] = a[j] ^ b[j];
+    }
+
+    /**
+     * @brief Inverse MixColumn sublayer of a single column.
+     *
+     * InvMixColumns equals MixColumns after adding 4*(a0+a2) to a0 & a2 & 4*(a1+a3) to a1 & a3.
+     * @param[inout] a (byte_slices_t*): The 4 bytes of the column.
+     */
+    inline void invMixColumn(byte_slices_t *a)
+    {
+        byte_slices_t sum, x, u, v;
+        add(a[0], a[2], sum);
+        xtime(sum, x);
+        xtime(x, u);
+        add(a[1], a[3], sum);
+        xtime(sum, x);
+        xtime(x, v);
+        add(a[0], u, a[0]);
+        add(a[2], u, a[2]);
+        add(a[1], v, a[1]);
+        add(a[3], v, a[3]);
+
+        // MixColumns: b_r = a_r + (a0 + a1 + a2 + a3) + 2*(a_r + a_(r+1))
+        byte_slices_t all, b[WORD_BYTES];
+        add(a[0], a[1], sum);
+        add(a[2], a[3], x);
+        add(sum, x, all);
+        for(uint8_t r=0; r<WORD_BYTES; r++)
+        {
+            add(a[r], a[(r+1) & 3], sum);
+            xtime(sum, x);
+            add(a[r], all, b[r]);
+            add(b[r], x, b[r]);
+        }
+        memcpy(a, b, sizeof(b));
+    }
+}
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void BitslicedAES::setKey(const aes_key_t key)
+{
+    sub_keys_t subKeys;
+    memcpy(subKeys[0], key, KEY_BYTES);
+    for(uint8_t i=1; i<=ROUNDS; i++)
+        AES::createRoundKey(subKeys, i);
+    expand(subKeys);
+    memset(subKeys, 0, sizeof(subKeys));
+}
+
+bool BitslicedAES::selectKey(const uint8_t slot)
+{
+    sub_keys_t subKeys;
+    if(!KeyStore::read(slot, subKeys)) return false;
+    expand(subKeys);
+    memset(subKeys, 0, sizeof(subKeys));
+    return true;
+}
+
+void BitslicedAES::decrypt(uint8_t *cipher) const
+{
+    decryptBatch(cipher, cipher, 1);
+}
+
+void BitslicedAES::decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const
+{
+    for(size_t block=0; block<nBlocks; block+=BATCH_BLOCKS)
+    {
+        const size_t batch = (nBlocks - block < BATCH_BLOCKS) ? nBlocks - block : BATCH_BLOCKS;
+        decryptBatch(&in[block*STATE_BYTES], &out[block*STATE_BYTES], batch);
+    }
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+void BitslicedAES::expand(const sub_keys_t subKeys)
+{
+    for(uint8_t round=0; round<=ROUNDS; round++)
+        for(uint8_t i=0; i<STATE_BYTES; i++)
+            for(uint8_t j=0; j<8; j++)
+                mRoundKeys[round][i][j] = 0 - static_cast<uint64_t>((subKeys[round][i] >> j) & 0x01);
+}
+
+void BitslicedAES::decryptBatch(const uint8_t *in, uint8_t *out, const size_t nBlocks) const
+{
+    // Bitslice the blocks, 8 blocks & a byte at a time by transposing 8x8 bit matrices
+    slices_t state = {};
+    for(uint8_t i=0; i<STATE_BYTES; i++)
+    {
+        for(uint8_t group=0; group<BATCH_BLOCKS/8; group++)
+        {
+            uint64_t x = 0;
+            for(uint8_t k=0; k<8; k++)
+            {
+                const size_t block = group*8 + k;
+                if(block < nBlocks) x |= static_cast<uint64_t>(in[block*STATE_BYTES + i]) << (8*k);
+            }
+            x = transpose8(x);
+            for(uint8_t j=0; j<8; j++)
+                state[i][j] |= ((x >> (8*j)) & 0xff) << (8*group);
+        }
+    }
+
+    // Rounds
+    for(uint8_t i=0; i<STATE_BYTES; i++)
+        add(state[i], mRoundKeys[ROUNDS][i], state[i]);
+    for(int8_t round=ROUNDS-1; round>=0; round--)
+    {
+        // InvShiftRows: byte (row r, column c) comes from column c-r. InvSubBytes & AddRoundKey.
+        slices_t next;
+        for(uint8_t col=0; col<WORD_BYTES; col++)
+        {
+            for(uint8_t row=0; row<WORD_BYTES; row++)
+            {
+                uint64_t *byte = next[col*WORD_BYTES + row];
+                memcpy(byte, state[((col - row) & 3)*WORD_BYTES + row], sizeof(byte_slices_t));
+                invSubByte(byte);
+                add(byte, mRoundKeys[round][col*WORD_BYTES + row], byte);
+            }
+        }
+        if(round > 0)
+            for(uint8_t col=0; col<WORD_BYTES; col++)
+                invMixColumn(&next[col*WORD_BYTES]);
+        memcpy(state, next, sizeof(slices_t));
+    }
+
+    // Transpose back
+    for(uint8_t i=0; i<STATE_BYTES; i++)
+    {
+        for(uint8_t group=0; group<BATCH_BLOCKS/8; group++)
+        {
+            uint64_t x = 0;
+            for(uint8_t j=0; j<8; j++)
+                x |= ((state[i][j] >> (8*group)) & 0xff) << (8*j);
+            x = transpose8(x);
+            for(uint8_t k=0; k<8; k++)
+            {
+                const size_t block = group*8 + k;
+                if(block < nBlocks) out[block*STATE_BYTES + i] = static_cast<uint8_t>(x >> (8*k));
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#include "host/hostAES.h"
+
+#include <string.h>
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+HostAES::Engine HostAES::best()
+{
+    // The result doesn't change, so the CPU is only checked once
+    static const Engine engine = AESNI::supported() ? Engine::AES_NI : (VPermAES::supported() ? Engine::VPERM : Engine::T_TABLE);
+    return engine;
+}
+
+bool HostAES::supported(const Engine engine)
+{
+    switch(engine)
+    {
+        case Engine::T_TABLE:   return true;
+        case Engine::AES_NI:    return AESNI::supported();
+        case Engine::BITSLICED: return true;
+        case Engine::VPERM:     return VPermAES::supported();
+    }
+    return false;
+}
+
+const char *HostAES::name(const Engine engine)
+{
+    switch(engine)
+    {
+        case Engine::T_TABLE:   return "TTableAES";
+        case Engine::AES_NI:    return "AESNI";
+        case Engine::BITSLICED: return "BitslicedAES";
+        case Engine::VPERM:     return "VPermAES";
+    }
+    return "unknown";
+}
+
+void HostAES::setKey(const aes_key_t key)
+{
+    switch(mEngine)
+    {
+        case Engine::T_TABLE:   mTTable.setKey(key); break;
+        case Engine::AES_NI:    mAESNI.setKey(key); break;
+        case Engine::BITSLICED: mBitsliced.setKey(key); break;
+        case Engine::VPERM:     mVPerm.setKey(key); break;
+    }
+}
+
+bool HostAES::selectKey(const uint8_t slot)
+{
+    switch(mEngine)
+    {
+        case Engine::T_TABLE:   return mTTable.selectKey(slot);
+        case Engine::AES_NI:    return mAESNI.selectKey(slot);
+        case Engine::BITSLICED: return mBitsliced.selectKey(slot);
+        case Engine::VPERM:     return mVPerm.selectKey(slot);
+    }
+    return false;
+}
+
+void HostAES::decrypt(uint8_t *cipher) const
+{
+    switch(mEngine)
+    {
+        case Engine::T_TABLE:   mTTable.decrypt(cipher); break;
+        case Engine::AES_NI:    mAESNI.decrypt(cipher); break;
+        case Engine::BITSLICED: mBitsliced.decrypt(cipher); break;
+        case Engine::VPERM:     mVPerm.decrypt(cipher); break;
+    }
+}
+
+void HostAES::decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const
+{
+    switch(mEngine)
+    {
+        case Engine::T_TABLE:
+            for(size_t block=0; block<nBlocks; block++)
+            {
+                if(out != in) memcpy(&out[block*STATE_BYTES], &in[block*STATE_BYTES], STATE_BYTES);
+                mTTable.decrypt(&out[block*STATE_BYTES]);
+            }
+            break;
+        case Engine::AES_NI:
+            mAESNI.decryptBlocks(in, out, nBlocks);
+            break;
+        case Engine::BITSLICED:
+            mBitsliced.decryptBlocks(in, out, nBlocks);
+            break;
+        case Engine::VPERM:
+            mVPerm.decryptBlocks(in, out, nBlocks);
+            break;
+    }
+}
@@ -0,0 +1,135 @@
+#include "host/tTableAES.h"
+
+#include <string.h>
+
+#include "aes.h"
+#include "aesMath.h"
+#include "keyStore.h"
+#include "lut.h"
+
+namespace
+{
+    /**
+     * @brief Load a big-endian column.
+     * @param[in] bytes (const uint8_t*): The 4 bytes of the column.
+     * @return (uint32_t): The column, with the first byte in the most significant byte.
+     */
+    inline uint32_t load32(const uint8_t *bytes)
+    {
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+             | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+    }
+
+    /**
+     * @brief Store a big-endian column.
+     * @param[out] bytes (uint8_t*): The 4 bytes of the column.
+     * @param[in] word (const uint32_t): The column.
+     */
+    inline void store32(uint8_t *bytes, const uint32_t word)
+    {
+        bytes[0] = static_cast<uint8_t>(word >> 24);
+        bytes[1] = static_cast<uint8_t>(word >> 16);
+        bytes[2] = static_cast<uint8_t>(word >> 8);
+        bytes[3] = static_cast<uint8_t>(word);
+    }
+}
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void TTableAES::setKey(const aes_key_t key)
+{
+    sub_keys_t subKeys;
+    memcpy(subKeys[0], key, KEY_BYTES);
+    for(uint8_t i=1; i<=ROUNDS; i++)
+        AES::createRoundKey(subKeys, i);
+    expand(subKeys);
+    memset(subKeys, 0, sizeof(subKeys));
+}
+
+bool TTableAES::selectKey(const uint8_t slot)
+{
+    sub_keys_t subKeys;
+    if(!KeyStore::read(slot, subKeys)) return false;
+    expand(subKeys);
+    memset(subKeys, 0, sizeof(subKeys));
+    return true;
+}
+
+void TTableAES::decrypt(uint8_t *cipher) const
+{
+    const tables_t &t = tables();
+    uint32_t s0 = load32(cipher)      ^ mRoundKeys[0][0];
+    uint32_t s1 = load32(cipher + 4)  ^ mRoundKeys[0][1];
+    uint32_t s2 = load32(cipher + 8)  ^ mRoundKeys[0][2];
+    uint32_t s3 = load32(cipher + 12) ^ mRoundKeys[0][3];
+
+    // Rounds 1 to 9: Row i of the result comes from column c-i, since InvShiftRows rotates row i by i to the right
+    for(uint8_t round=1; round<ROUNDS; round++)
+    {
+        const uint32_t *key = mRoundKeys[round];
+        const uint32_t t0 = t.td[0][s0 >> 24] ^ t.td[1][(s3 >> 16) & 0xff] ^ t.td[2][(s2 >> 8) & 0xff] ^ t.td[3][s1 & 0xff] ^ key[0];
+        const uint32_t t1 = t.td[0][s1 >> 24] ^ t.td[1][(s0 >> 16) & 0xff] ^ t.td[2][(s3 >> 8) & 0xff] ^ t.td[3][s2 & 0xff] ^ key[1];
+        const uint32_t t2 = t.td[0][s2 >> 24] ^ t.td[1][(s1 >> 16) & 0xff] ^ t.td[2][(s0 >> 8) & 0xff] ^ t.td[3][s3 & 0xff] ^ key[2];
+        const uint32_t t3 = t.td[0][s3 >> 24] ^ t.td[1][(s2 >> 16) & 0xff] ^ t.td[2][(s1 >> 8) & 0xff] ^ t.td[3][s0 & 0xff] ^ key[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    // Last round without InvMixColumns
+    const uint32_t *key = mRoundKeys[ROUNDS];
+    store32(cipher,      ((static_cast<uint32_t>(t.td4[s0 >> 24]) << 24) | (static_cast<uint32_t>(t.td4[(s3 >> 16) & 0xff]) << 16)
+                        | (static_cast<uint32_t>(t.td4[(s2 >> 8) & 0xff]) << 8) | t.td4[s1 & 0xff]) ^ key[0]);
+    store32(cipher + 4,  ((static_cast<uint32_t>(t.td4[s1 >> 24]) << 24) | (static_cast<uint32_t>(t.td4[(s0 >> 16) & 0xff]) << 16)
+                        | (static_cast<uint32_t>(t.td4[(s3 >> 8) & 0xff]) << 8) | t.td4[s2 & 0xff]) ^ key[1]);
+    store32(cipher + 8,  ((static_cast<uint32_t>(t.td4[s2 >> 24]) << 24) | (static_cast<uint32_t>(t.td4[(s1 >> 16) & 0xff]) << 16)
+                        | (static_cast<uint32_t>(t.td4[(s0 >> 8) & 0xff]) << 8) | t.td4[s3 & 0xff]) ^ key[2]);
+    store32(cipher + 12, ((static_cast<uint32_t>(t.td4[s3 >> 24]) << 24) | (static_cast<uint32_t>(t.td4[(s2 >> 16) & 0xff]) << 16)
+                        | (static_cast<uint32_t>(t.td4[(s1 >> 8) & 0xff]) << 8) | t.td4[s0 & 0xff]) ^ key[3]);
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+void TTableAES::expand(const sub_keys_t subKeys)
+{
+    const tables_t &t = tables();
+    // The decryption starts with the last subkey
+    for(uint8_t round=0; round<=ROUNDS; round++)
+    {
+        for(uint8_t col=0; col<WORD_BYTES; col++)
+        {
+            uint32_t word = load32(&subKeys[ROUNDS-round][col*WORD_BYTES]);
+            // InvMixColumns of the key: Td contains the inverse S-Box, so it is cancelled by the S-Box
+            if(round > 0 && round < ROUNDS)
+                word = t.td[0][pgm_read_byte(&LUT::S_BOX[word >> 24])] ^ t.td[1][pgm_read_byte(&LUT::S_BOX[(word >> 16) & 0xff])]
+                     ^ t.td[2][pgm_read_byte(&LUT::S_BOX[(word >> 8) & 0xff])] ^ t.td[3][pgm_read_byte(&LUT::S_BOX[word & 0xff])];
+            mRoundKeys[round][col] = word;
+        }
+    }
+}
+
+const TTableAES::tables_t &TTableAES::tables()
+{
+    // Thread-safe initialization on the first call
+    static const tables_t tables = []()
+    {
+        tables_t t;
+        for(uint16_t x=0; x<SBOX_BYTES; x++)
+        {
+            // Column (0e, 09, 0d, 0b) * InvS[x], i.e. InvMixColumns of (InvS[x], 0, 0, 0)
+            const uint8_t s = pgm_read_byte(&LUT::INV_S_BOX[x]);
+            const uint32_t word = (static_cast<uint32_t>(AESMath::ffMul(s, 0x0e)) << 24) | (static_cast<uint32_t>(AESMath::ffMul(s, 0x09)) << 16)
+                                | (static_cast<uint32_t>(AESMath::ffMul(s, 0x0d)) << 8) | AESMath::ffMul(s, 0x0b);
+            t.td[0][x] = word;
+            t.td[1][x] = (word >> 8) | (word << 24);
+            t.td[2][x] = (word >> 16) | (word << 16);
+            t.td[3][x] = (word >> 24) | (word << 8);
+            t.td4[x] = s;
+        }
+        return t;
+    }();
+    return tables;
+}
@@ -0,0 +1,367 @@
+#include "host/vpermAES.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "aes.h"
+#include "aesMath.h"
+#include "keyStore.h"
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void VPermAES::setKey(const aes_key_t key)
+{
+    sub_keys_t subKeys;
+    memcpy(subKeys[0], key, KEY_BYTES);
+    for(uint8_t i=1; i<=ROUNDS; i++)
+        AES::createRoundKey(subKeys, i);
+    memcpy(mRoundKeys, subKeys, sizeof(subKeys));
+    memset(subKeys, 0, sizeof(subKeys));
+}
+
+bool VPermAES::selectKey(const uint8_t slot)
+{
+    sub_keys_t subKeys;
+    if(!KeyStore::read(slot, subKeys)) return false;
+    memcpy(mRoundKeys, subKeys, sizeof(subKeys));
+    memset(subKeys, 0, sizeof(subKeys));
+    return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#define SSSE3_TARGET __attribute__((target("ssse3")))     ///< Compile a function with SSSE3, without a global flag
+#define AVX2_TARGET __attribute__((target("avx2")))       ///< Compile a function with AVX2, without a global flag
+
+namespace
+{
+    constexpr uint8_t NIBBLE_TABLES = 14;   ///< Number of nibble tables
+    constexpr uint8_t NO_NIBBLE = 0x80;     ///< Table entry for 1/0, PSHUFB returns 0 for indices with the MSB set
+
+    /**
+     * @brief The nibble tables, each 16 bytes for a PSHUFB.
+     */
+    struct tables_t
+    {
+        alignas(16) uint8_t inLow[16];      ///< Low nibble of the input: Inverse affine transformation & change to the basis (b, b^16)
+        alignas(16) uint8_t inHigh[16];     ///< High nibble of the input, without the constant of the affine transformation
+        alignas(16) uint8_t inv[16];        ///< 1/x in GF(2^4)
+        alignas(16) uint8_t cDiv[16];       ///< c/x in GF(2^4), with c = (b + b^16)^2 / b^17
+        alignas(16) uint8_t out1[16];       ///< Contribution of the first coordinate to the inverse, in the polynomial basis
+        alignas(16) uint8_t out2[16];       ///< Contribution of the second coordinate to the inverse
+        alignas(16) uint8_t mulLow[4][16];  ///< Low nibble times 0e, 0b, 0d & 09
+        alignas(16) uint8_t mulHigh[4][16]; ///< High nibble times 0e, 0b, 0d & 09
+    };
+    static_assert(sizeof(tables_t) == NIBBLE_TABLES*16, "The nibble tables must be packed");
+
+    // Byte shuffles: InvShiftRows (row r of column c comes from column c-r) & rotations within the columns
+    alignas(16) const uint8_t INV_SHIFT_ROWS[16] = {0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3};
+    alignas(16) const uint8_t ROTATE[3][16] = {{1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12},
+                                               {2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13},
+                                               {3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14}};
+
+    /**
+     * @brief Calculate the inverse in GF(2^8).
+     * @param[in] x (const uint8_t): The element.
+     * @return (uint8_t): 1/x, 0 for 0.
+     */
+    uint8_t gfInverse(const uint8_t x)
+    {
+        // x^254 = x^-1
+        uint8_t result = 1;
+        uint8_t square = x;
+        for(uint8_t exponent=254; exponent>0; exponent>>=1)
+        {
+            if(exponent & 0x01) result = AESMath::ffMul(result, square);
+            square = AESMath::ffMul(square, square);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Get the nibble tables, which are calculated on the first call.
+     *
+     * A byte x = i*b + j*b^16 with i, j in GF(2^4) has the norm N = x^17 = n*(k^2 + c*i*j) with k = i + j,
+     * n = b^17 & c = (b + b^16)^2 / n. The inverse is x^-1 = x^16 / N = (j*b + i*b^16) / N. The kernel calculates
+     * io = 1/(1/i + c/k) + j = N/(n*((1+c)*i + j)) & jo = 1/(1/j + c/k) + i = N/(n*(i + (1+c)*j)), whose inverses are
+     * linear in i/N & j/N, so x^-1 = out1[io] + out2[jo]. 1/0 is #NO_NIBBLE, which covers i, j or k = 0.
+     * @return (const tables_t&): The tables.
+     */
+    const tables_t &tables()
+    {
+        // Thread-safe initialization on the first call
+        static const tables_t tables = []()
+        {
+            tables_t t;
+
+            // GF(2^4) is the subfield {z : z^16 = z}, its nibble representation is a basis of it over GF(2)
+            uint8_t basis[4] = {};
+            const auto combine = [&basis](const uint8_t bits)
+            {
+                uint8_t z = 0;
+                for(uint8_t i=0; i<4; i++)
+                    if(bits & (1 << i)) z ^= basis[i];
+                return z;
+            };
+            uint8_t size = 0;
+            for(uint16_t z=1; z<SBOX_BYTES && size<4; z++)
+            {
+                uint8_t power = static_cast<uint8_t>(z);
+                for(uint8_t i=0; i<4; i++) power = AESMath::ffMul(power, power);
+                bool spanned = (power != z);
+                for(uint8_t bits=0; bits<(1 << size); bits++)
+                    spanned |= (combine(bits) == z);
+                if(!spanned) basis[size++] = static_cast<uint8_t>(z);
+            }
+            uint8_t element[16];
+            uint8_t nibble[SBOX_BYTES] = {};
+            for(uint8_t x=0; x<16; x++)
+            {
+                element[x] = combine(x);
+                nibble[element[x]] = x;
+            }
+
+            // Normal basis (b, b^16): any b outside of GF(2^4)
+            uint8_t b = 2;
+            uint8_t b16 = b;
+            for(;; b++)
+            {
+                b16 = b;
+                for(uint8_t i=0; i<4; i++) b16 = AESMath::ffMul(b16, b16);
+                if(b16 != b) break;
+            }
+            const uint8_t n = AESMath::ffMul(b, b16);
+            const uint8_t c = AESMath::ffMul(AESMath::ffMul(b ^ b16, b ^ b16), gfInverse(n));
+            const uint8_t invC2 = gfInverse(AESMath::ffMul(c, c));
+            const uint8_t w1 = AESMath::ffMul(b ^ AESMath::ffMul(1 ^ c, b16), invC2);
+            const uint8_t w2 = AESMath::ffMul(AESMath::ffMul(1 ^ c, b) ^ b16, invC2);
+
+            // Coordinates of all bytes in the normal basis, as i | j << 4
+            uint8_t coordinates[SBOX_BYTES];
+            for(uint8_t i=0; i<16; i++)
+                for(uint8_t j=0; j<16; j++)
+                    coordinates[AESMath::ffMul(element[i], b) ^ AESMath::ffMul(element[j], b16)] = i | (j << 4);
+
+            // Inverse affine transformation: y_i = x_(i+2) + x_(i+5) + x_(i+7) + bit i of 05, followed by the change of basis
+            const auto input = [&coordinates](const uint8_t x)
+            {
+                const uint8_t y = static_cast<uint8_t>((x << 1) | (x >> 7)) ^ static_cast<uint8_t>((x << 3) | (x >> 5))
+                                ^ static_cast<uint8_t>((x << 6) | (x >> 2)) ^ 0x05;
+                return coordinates[y];
+            };
+
+            const uint8_t factors[4] = {0x0e, 0x0b, 0x0d, 0x09};
+            for(uint8_t x=0; x<16; x++)
+            {
+                t.inLow[x] = input(x);
+                t.inHigh[x] = input(static_cast<uint8_t>(x << 4)) ^ input(0);
+                t.inv[x] = (x == 0) ? NO_NIBBLE : nibble[gfInverse(element[x])];
+                t.cDiv[x] = (x == 0) ? NO_NIBBLE : nibble[AESMath::ffMul(c, gfInverse(element[x]))];
+                const uint8_t inverse = gfInverse(AESMath::ffMul(n, element[x]));
+                t.out1[x] = AESMath::ffMul(inverse, w1);
+                t.out2[x] = AESMath::ffMul(inverse, w2);
+                for(uint8_t m=0; m<4; m++)
+                {
+                    t.mulLow[m][x] = AESMath::ffMul(x, factors[m]);
+                    t.mulHigh[m][x] = AESMath::ffMul(static_cast<uint8_t>(x << 4), factors[m]);
+                }
+            }
+            return t;
+        }();
+        return tables;
+    }
+
+    /**
+     * @brief Decrypt @p N states of 128 bits with SSSE3.
+     * @param[inout] state (__m128i(&)[N]): The states.
+     * @param[in] roundKeys (const uint8_t(*)[16]): The round keys, in the order of the key schedule.
+     */
+    template<size_t N>
+    SSSE3_TARGET void decrypt128(__m128i (&state)[N], const uint8_t (*roundKeys)[STATE_BYTES])
+    {
+        const tables_t &t = tables();
+        const __m128i *table = reinterpret_cast<const __m128i*>(&t);
+        __m128i v[NIBBLE_TABLES];
+        for(uint8_t i=0; i<NIBBLE_TABLES; i++) v[i] = _mm_load_si128(&table[i]);
+        const __m128i mask = _mm_set1_epi8(0x0f);
+        const __m128i shiftRows = _mm_load_si128(reinterpret_cast<const __m128i*>(INV_SHIFT_ROWS));
+        const __m128i rotate1 = _mm_load_si128(reinterpret_cast<const __m128i*>(ROTATE[0]));
+        const __m128i rotate2 = _mm_load_si128(reinterpret_cast<const __m128i*>(ROTATE[1]));
+        const __m128i rotate3 = _mm_load_si128(reinterpret_cast<const __m128i*>(ROTATE[2]));
+
+        __m128i key = _mm_load_si128(reinterpret_cast<const __m128i*>(roundKeys[ROUNDS]));
+        for(size_t s=0; s<N; s++) state[s] = _mm_xor_si128(state[s], key);
+        for(int8_t round=ROUNDS-1; round>=0; round--)
+        {
+            key = _mm_load_si128(reinterpret_cast<const __m128i*>(roundKeys[round]));
+            for(size_t s=0; s<N; s++)
+            {
+                // InvShiftRows & InvSubBytes (see tables())
+                const __m128i x = _mm_shuffle_epi8(state[s], shiftRows);
+                const __m128i in = _mm_xor_si128(_mm_shuffle_epi8(v[0], _mm_and_si128(x, mask)),
+                                                 _mm_shuffle_epi8(v[1], _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+                const __m128i i = _mm_and_si128(in, mask);
+                const __m128i j = _mm_and_si128(_mm_srli_epi16(in, 4), mask);
+                const __m128i ck = _mm_shuffle_epi8(v[3], _mm_xor_si128(i, j));
+                const __m128i io = _mm_xor_si128(_mm_shuffle_epi8(v[2], _mm_xor_si128(_mm_shuffle_epi8(v[2], i), ck)), j);
+                const __m128i jo = _mm_xor_si128(_mm_shuffle_epi8(v[2], _mm_xor_si128(_mm_shuffle_epi8(v[2], j), ck)), i);
+                __m128i y = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(v[4], io), _mm_shuffle_epi8(v[5], jo)), key);
+                if(round == 0)
+                {
+                    state[s] = y;
+                    continue;
+                }
+
+                // InvMixColumns: 0e*a_r + 0b*a_(r+1) + 0d*a_(r+2) + 09*a_(r+3)
+                const __m128i low = _mm_and_si128(y, mask);
+                const __m128i high = _mm_and_si128(_mm_srli_epi16(y, 4), mask);
+                y = _mm_xor_si128(_mm_shuffle_epi8(v[6], low), _mm_shuffle_epi8(v[10], high));
+                y = _mm_xor_si128(y, _mm_shuffle_epi8(_mm_xor_si128(_mm_shuffle_epi8(v[7], low), _mm_shuffle_epi8(v[11], high)), rotate1));
+                y = _mm_xor_si128(y, _mm_shuffle_epi8(_mm_xor_si128(_mm_shuffle_epi8(v[8], low), _mm_shuffle_epi8(v[12], high)), rotate2));
+                state[s] = _mm_xor_si128(y, _mm_shuffle_epi8(_mm_xor_si128(_mm_shuffle_epi8(v[9], low), _mm_shuffle_epi8(v[13], high)), rotate3));
+            }
+        }
+    }
+
+    /**
+     * @brief Decrypt @p N pairs of states with AVX2, the same as decrypt128() on both 128-bit lanes.
+     * @param[inout] state (__m256i(&)[N]): The pairs of states.
+     * @param[in] roundKeys (const uint8_t(*)[16]): The round keys, in the order of the key schedule.
+     */
+    template<size_t N>
+    AVX2_TARGET void decrypt256(__m256i (&state)[N], const uint8_t (*roundKeys)[STATE_BYTES])
+    {
+        const tables_t &t = tables();
+        const __m128i *table = reinterpret_cast<const __m128i*>(&t);
+        __m256i v[NIBBLE_TABLES];
+        for(uint8_t i=0; i<NIBBLE_TABLES; i++) v[i] = _mm256_broadcastsi128_si256(_mm_load_si128(&table[i]));
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+        const __m256i shiftRows = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(INV_SHIFT_ROWS)));
+        const __m256i rotate1 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(ROTATE[0])));
+        const __m256i rotate2 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(ROTATE[1])));
+        const __m256i rotate3 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(ROTATE[2])));
+
+        __m256i key = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(roundKeys[ROUNDS])));
+        for(size_t s=0; s<N; s++) state[s] = _mm256_xor_si256(state[s], key);
+        for(int8_t round=ROUNDS-1; round>=0; round--)
+        {
+            key = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(roundKeys[round])));
+            for(size_t s=0; s<N; s++)
+            {
+                const __m256i x = _mm256_shuffle_epi8(state[s], shiftRows);
+                const __m256i in = _mm256_xor_si256(_mm256_shuffle_epi8(v[0], _mm256_and_si256(x, mask)),
+                                                    _mm256_shuffle_epi8(v[1], _mm256_and_si256(_mm256_srli_epi16(x, 4), mask)));
+                const __m256i i = _mm256_and_si256(in, mask);
+                const __m256i j = _mm256_and_si256(_mm256_srli_epi16(in, 4), mask);
+                const __m256i ck = _mm256_shuffle_epi8(v[3], _mm256_xor_si256(i, j));
+                const __m256i io = _mm256_xor_si256(_mm256_shuffle_epi8(v[2], _mm256_xor_si256(_mm256_shuffle_epi8(v[2], i), ck)), j);
+                const __m256i jo = _mm256_xor_si256(_mm256_shuffle_epi8(v[2], _mm256_xor_si256(_mm256_shuffle_epi8(v[2], j), ck)), i);
+                __m256i y = _mm256_xor_si256(_mm256_xor_si256(_mm256_shuffle_epi8(v[4], io), _mm256_shuffle_epi8(v[5], jo)), key);
+                if(round == 0)
+                {
+                    state[s] = y;
+                    continue;
+                }
+
+                const __m256i low = _mm256_and_si256(y, mask);
+                const __m256i high = _mm256_and_si256(_mm256_srli_epi16(y, 4), mask);
+                y = _mm256_xor_si256(_mm256_shuffle_epi8(v[6], low), _mm256_shuffle_epi8(v[10], high));
+                y = _mm256_xor_si256(y, _mm256_shuffle_epi8(_mm256_xor_si256(_mm256_shuffle_epi8(v[7], low), _mm256_shuffle_epi8(v[11], high)), rotate1));
+                y = _mm256_xor_si256(y, _mm256_shuffle_epi8(_mm256_xor_si256(_mm256_shuffle_epi8(v[8], low), _mm256_shuffle_epi8(v[12], high)), rotate2));
+                state[s] = _mm256_xor_si256(y, _mm256_shuffle_epi8(_mm256_xor_si256(_mm256_shuffle_epi8(v[9], low), _mm256_shuffle_epi8(v[13], high)), rotate3));
+            }
+        }
+    }
+
+    /**
+     * @brief Decrypt blocks with AVX2, 2 registers of 2 blocks at a time.
+     * @param[in] in (const uint8_t*): The ciphertexts.
+     * @param[out] out (uint8_t*): The plaintexts.
+     * @param[in] nBlocks (const size_t): Number of blocks, a multiple of 4.
+     * @param[in] roundKeys (const uint8_t(*)[16]): The round keys.
+     */
+    AVX2_TARGET void decryptBlocksAVX2(const uint8_t *in, uint8_t *out, const size_t nBlocks, const uint8_t (*roundKeys)[STATE_BYTES])
+    {
+        const __m256i *source = reinterpret_cast<const __m256i*>(in);
+        __m256i *destination = reinterpret_cast<__m256i*>(out);
+        for(size_t pair=0; pair<nBlocks/2; pair+=2)
+        {
+            __m256i state[2] = {_mm256_loadu_si256(&source[pair]), _mm256_loadu_si256(&source[pair + 1])};
+            decrypt256(state, roundKeys);
+            _mm256_storeu_si256(&destination[pair], state[0]);
+            _mm256_storeu_si256(&destination[pair + 1], state[1]);
+        }
+    }
+}
+
+bool VPermAES::supported()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+bool VPermAES::supportedAVX2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+SSSE3_TARGET void VPermAES::decrypt(uint8_t *cipher) const
+{
+    __m128i state[1] = {_mm_loadu_si128(reinterpret_cast<const __m128i*>(cipher))};
+    decrypt128(state, mRoundKeys);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(cipher), state[0]);
+}
+
+SSSE3_TARGET void VPermAES::decryptBlocks(const uint8_t *in, uint8_t *out, const size_t nBlocks) const
+{
+    // The CPU doesn't change, so it is only checked once
+    static const bool avx2 = supportedAVX2();
+    size_t block = 0;
+    if(avx2)
+    {
+        block = nBlocks & ~static_cast<size_t>(3);
+        decryptBlocksAVX2(in, out, block, mRoundKeys);
+    }
+
+    // 2 independent blocks with SSSE3, then a single one
+    const __m128i *source = reinterpret_cast<const __m128i*>(in);
+    __m128i *destination = reinterpret_cast<__m128i*>(out);
+    for(; block + 2 <= nBlocks; block += 2)
+    {
+        __m128i state[2] = {_mm_loadu_si128(&source[block]), _mm_loadu_si128(&source[block + 1])};
+        decrypt128(state, mRoundKeys);
+        _mm_storeu_si128(&destination[block], state[0]);
+        _mm_storeu_si128(&destination[block + 1], state[1]);
+    }
+    if(block < nBlocks)
+    {
+        __m128i state[1] = {_mm_loadu_si128(&source[block])};
+        decrypt128(state, mRoundKeys);
+        _mm_storeu_si128(&destination[block], state[0]);
+    }
+}
+#else
+// SSSE3 & AVX2 are only available on x86, decrypt() & decryptBlocks() are never called, since supported() is false
+bool VPermAES::supported()
+{
+    return false;
+}
+
+bool VPermAES::supportedAVX2()
+{
+    return false;
+}
+
+void VPermAES::decrypt(uint8_t *) const
+{
+    abort();
+}
+
+void VPermAES::decryptBlocks(const uint8_t *, uint8_t *, const size_t) const
+{
+    abort();
+}
+#endif
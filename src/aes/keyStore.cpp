@@ -0,0 +1,143 @@
+#include "keyStore.h"
+#include "aes.h"
+
+const aes_key_t KeyStore::DEFAULT_KEY = {0xff, 0xcd, 0x13, 0xbd, 0xd3, 0xc8, 0x7f, 0xb4, 0x41, 0x25, 0xe8, 0x46, 0x18, 0xfa, 0xb7, 0xd4};
+uint8_t KeyStore::mDirectory[NUM_SLOTS] EEMEM;
+KeyStore::slot_t KeyStore::mSlots[PHYSICAL_SLOTS] EEMEM;
+
+sub_keys_t KeyStore::mStaging = {};
+uint8_t KeyStore::mStagingSlot = EMPTY;
+uint8_t KeyStore::mStagingChecksum = 0;
+uint8_t KeyStore::mSpare = 0;
+uint8_t KeyStore::mGeneration = 0;
+KeyStore::LoadPhase KeyStore::mLoadPhase = KeyStore::LoadPhase::IDLE;
+uint8_t KeyStore::mLoadIndex = 0;
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void KeyStore::init(const aes_key_t defaultKey)
+{
+    const uint8_t physical = physicalSlot(0);
+    mSpare = findSpare(0, physical);
+    // Only the directory entry is checked, reading & verifying the whole slot would delay the first command
+    if(physical == EMPTY) load(0, defaultKey);
+}
+
+bool KeyStore::load(const uint8_t slot, const aes_key_t key)
+{
+    if(slot >= NUM_SLOTS || busy()) return false;
+    // The first sub-key is the master-key itself, the others are created by expandStep()
+    memcpy(mStaging[0], key, KEY_BYTES*sizeof(uint8_t));
+    mStagingSlot = slot;
+    mLoadIndex = 1;
+    mLoadPhase = LoadPhase::EXPAND;
+    mGeneration++;
+    return true;
+}
+
+bool KeyStore::loadStep(void *context)
+{
+    (void) context;
+    switch(mLoadPhase)
+    {
+        case LoadPhase::EXPAND:
+            expandStep();
+            break;
+
+        case LoadPhase::WRITE:
+        {
+            if(!eeprom_is_ready()) break;
+            uint8_t *slot = reinterpret_cast<uint8_t*>(&mSlots[mSpare]);
+            if(mLoadIndex < sizeof(sub_keys_t))
+            {
+                const uint8_t value = reinterpret_cast<const uint8_t*>(mStaging)[mLoadIndex];
+                mStagingChecksum = _crc8_ccitt_update(mStagingChecksum, value);
+                eeprom_update_byte(slot + mLoadIndex++, value);
+            }
+            else
+            {
+                eeprom_update_byte(&mSlots[mSpare].checksum, mStagingChecksum);
+                mLoadPhase = LoadPhase::COMMIT;
+            }
+        }
+        break;
+
+        case LoadPhase::COMMIT:
+        {
+            if(!eeprom_is_ready()) break;
+            // The old physical slot of the slot becomes the spare one
+            const uint8_t spare = findSpare(mStagingSlot, mSpare);
+            eeprom_update_byte(&mDirectory[mStagingSlot], mSpare);
+            mSpare = spare;
+            // The slot is read from EEPROM from now on, so the key must not stay in SRAM
+            volatile uint8_t *staging = reinterpret_cast<volatile uint8_t*>(mStaging);
+            for(uint8_t i=0; i<sizeof(sub_keys_t); i++) staging[i] = 0;
+            mStagingSlot = EMPTY;
+            mLoadPhase = LoadPhase::IDLE;
+        }
+        break;
+
+        default:
+            break;
+    }
+    return busy();
+}
+
+bool KeyStore::read(const uint8_t slot, sub_keys_t subKeys)
+{
+    if(slot >= NUM_SLOTS) return false;
+
+    // The staging buffer is up to date & faster to read than the EEPROM
+    if(slot == mStagingSlot)
+    {
+        while(expandStep());
+        memcpy(subKeys, mStaging, sizeof(sub_keys_t));
+        return true;
+    }
+
+    const uint8_t physical = physicalSlot(slot);
+    if(physical == EMPTY) return false;
+    eeprom_read_block(subKeys, mSlots[physical].subKeys, sizeof(sub_keys_t));
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(subKeys);
+    uint8_t checksum = 0;
+    for(uint8_t i=0; i<sizeof(sub_keys_t); i++)
+        checksum = _crc8_ccitt_update(checksum, bytes[i]);
+    return (checksum == eeprom_read_byte(&mSlots[physical].checksum));
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+uint8_t KeyStore::physicalSlot(const uint8_t slot)
+{
+    const uint8_t physical = eeprom_read_byte(&mDirectory[slot]);
+    return (physical < PHYSICAL_SLOTS) ? physical : EMPTY;
+}
+
+uint8_t KeyStore::findSpare(const uint8_t slot, const uint8_t physical)
+{
+    bool used[PHYSICAL_SLOTS] = {};
+    for(uint8_t i=0; i<NUM_SLOTS; i++)
+    {
+        const uint8_t entry = (i == slot) ? physical : physicalSlot(i);
+        if(entry != EMPTY) used[entry] = true;
+    }
+    // There is always one more physical slot than slots
+    uint8_t spare = 0;
+    while(used[spare]) spare++;
+    return spare;
+}
+
+bool KeyStore::expandStep()
+{
+    if(mLoadPhase != LoadPhase::EXPAND) return false;
+    AES::createRoundKey(mStaging, mLoadIndex++);
+    if(mLoadIndex <= ROUNDS) return true;
+
+    // The key schedule is complete, write it to the spare physical slot
+    mLoadPhase = LoadPhase::WRITE;
+    mLoadIndex = 0;
+    mStagingChecksum = 0;
+    return false;
+}
@@ -4,23 +4,72 @@
 // **********************************************************************************
 void Masking::init()
 {
-    // Seed RNG
-    mRNG.seed();
-    // Compute SubBytes mask
-    mSubByteMask.input = mRNG.rand();
-    mSubByteMask.output = mRNG.rand();
-    // Init S-Box
-    initInvMaskedSBox(mInvMaskedSBox, mSubByteMask);
+    // Finish the refresh that was started in the background
+    while(refreshStep());
+    // Consume the masks, so the next refresh creates new ones
+    mRefreshPhase = RefreshPhase::SEED;
+}
 
-    // Compute MixCols masks
-    for(uint8_t i = 0; i < 4; i++)
+bool Masking::refreshStep()
+{
+    switch(mRefreshPhase)
     {
-        mMixColMasks[i].output = mRNG.rand();
-        mMixColMasks[i].input = 0;
-    }
-    initMixColInputMask(mMixColMasks);
+        case RefreshPhase::SEED:
+        {
+            // Seed RNG
+            if(mRefreshIndex == 0) mRNG.startSeed();
+            mRefreshIndex = 1;
+            if(mRNG.seedStep())
+            {
+                mRefreshPhase = RefreshPhase::MASKS;
+                mRefreshIndex = 0;
+            }
+        }
+        break;
 
+        case RefreshPhase::MASKS:
+        {
+            // Compute SubBytes mask
+            mSubByteMask.input = mRNG.rand();
+            mSubByteMask.output = mRNG.rand();
+            // Compute MixCols output masks
+            for(uint8_t i = 0; i < 4; i++)
+            {
+                mMixColMasks[i].output = mRNG.rand();
+                mMixColMasks[i].input = 0;
+            }
+            mRefreshPhase = RefreshPhase::S_BOX;
+        }
+        break;
 
+        case RefreshPhase::S_BOX:
+        {
+            // Init S-Box chunk by chunk
+            initInvMaskedSBox(mInvMaskedSBox, mSubByteMask, mRefreshIndex, REFRESH_SBOX_CHUNK);
+            mRefreshIndex += REFRESH_SBOX_CHUNK;
+            if(mRefreshIndex >= SBOX_BYTES)
+            {
+                mRefreshPhase = RefreshPhase::MIX_COL_MASKS;
+                mRefreshIndex = 0;
+            }
+        }
+        break;
+
+        case RefreshPhase::MIX_COL_MASKS:
+        {
+            // Compute MixCols input masks one by one
+            initMixColInputMask(mMixColMasks, mRefreshIndex++);
+            if(mRefreshIndex >= WORD_BYTES)
+            {
+                mRefreshPhase = RefreshPhase::READY;
+                mRefreshIndex = 0;
+            }
+        }
+        break;
+
+        default: break;
+    }
+    return (mRefreshPhase != RefreshPhase::READY);
 }
 
 void Masking::maskSubKeys(const sub_keys_t subKeys, sub_keys_t maskedSubKeys) const
@@ -65,18 +114,17 @@ void Masking::invUnMaskState(state_t state) const
 // **********************************************************************************
 // Private Methods ******************************************************************
 // **********************************************************************************
-void Masking::initInvMaskedSBox(uint8_t maskedSBox[], const mask_t &subByteMask) const
+void Masking::initInvMaskedSBox(uint8_t maskedSBox[], const mask_t &subByteMask, const uint16_t first, const uint16_t count) const
 {
     // See Power Analysis Attacks p. 239: S_m(x ^ m') = S(x) ^ m (inverted since we are doing decryption).
-    for(uint16_t i=0; i<SBOX_BYTES; i++)
+    for(uint16_t i=first; i<first+count && i<SBOX_BYTES; i++)
         maskedSBox[i ^ subByteMask.output] = pgm_read_byte(&LUT::INV_S_BOX[i]) ^ subByteMask.input;
 }
 
-void Masking::initMixColInputMask(mask_t mixColMasks[]) const
+void Masking::initMixColInputMask(mask_t mixColMasks[], const uint8_t row) const
 {
     // Do a matrix vector multiplication of the inverse Mix-Column matrix & output mask vector.
     // We are computing the input masks instead of the output masks since we are doing decryption.
-    for(uint8_t row=0; row<WORD_BYTES; row++)
-        for(uint8_t element=0; element<WORD_BYTES; element++)
-            mixColMasks[row].input ^= AESMath::ffMul(LUT::INV_MIX_COL_MATRIX[row][element], mixColMasks[element].output);
+    for(uint8_t element=0; element<WORD_BYTES; element++)
+        mixColMasks[row].input ^= AESMath::ffMul(LUT::INV_MIX_COL_MATRIX[row][element], mixColMasks[element].output);
 }
\ No newline at end of file
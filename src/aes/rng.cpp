@@ -5,17 +5,42 @@ void RNG::init()
     ADCSRA = (1 << ADPS2) | (1 << ADPS0);   // ADC clock prescaler divide by 32
     SET_BIT(ADCSRA, ADEN);                  // Enable ADC0
 
-    // Dummy read
+    // Dummy read, that initializes the analog circuitry. It does not have to be awaited:
+    // seedStep() waits for it to finish & throws away the result, because no RNG started it.
     SET_BIT(ADCSRA, ADSC);                  // Start ADC conversion
-    while(GET_BIT(ADCSRA, ADSC));           // Wait for conversion to finish
-    (void) ADCL;                            // Throw away the result
 }
 
 void RNG::seed()
+{
+    startSeed();
+    while(!seedStep());
+}
+
+void RNG::startSeed()
 {
     mRand = 0;
-    for(uint8_t i=0; i<8; i++)      // Seed the RNG
-        mRand |= (readADC() << i);
+    mSeedBits = 0;
+}
+
+bool RNG::seedStep()
+{
+    if(mSeedBits >= SEED_BITS) return true;
+    if(GET_BIT(ADCSRA, ADSC)) return false;     // Conversion is still running
+
+    if(mConverting)
+    {
+        // Add the LSB of the finished conversion to the seed
+        uint16_t adcValue = ADCL;
+        adcValue |= (ADCH << 8);
+        mRand |= ((adcValue & 0x01) << mSeedBits++);
+        mConverting = false;
+    }
+    if(mSeedBits < SEED_BITS)
+    {
+        SET_BIT(ADCSRA, ADSC);                  // Start the next ADC conversion
+        mConverting = true;
+    }
+    return (mSeedBits >= SEED_BITS);
 }
 
 uint8_t RNG::rand()
@@ -24,13 +49,3 @@ uint8_t RNG::rand()
     mRand ^= (mRand >> 5);
     return mRand ^= (mRand << 3);
 }
-
-bit_t RNG::readADC()
-{
-    SET_BIT(ADCSRA, ADSC);          // Start ADC conversion
-    while (GET_BIT(ADCSRA, ADSC));  // Wait until conversion is finished
-    uint16_t adcValue = ADCL;
-    adcValue |= (ADCH << 8);
-    return (adcValue & 0x01);       // Return the LSB of the ADC value
-}
-
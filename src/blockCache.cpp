@@ -0,0 +1,55 @@
+#include "blockCache.h"
+
+BlockCache::entry_t BlockCache::mEntries[SIZE] = {};
+uint8_t BlockCache::mNext = 0;
+uint8_t BlockCache::mReserved = NONE;
+uint8_t BlockCache::mReservedTag = EMPTY;
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+bool BlockCache::lookup(const uint8_t slot, byte_t *data)
+{
+    const uint8_t tag = slot + 1;
+    uint8_t checksum = 0;
+    for(uint8_t i=0; i<STATE_BYTES; i++)
+        checksum = _crc8_ccitt_update(checksum, data[i]);
+
+    // Only compare the whole block, if the tag & the checksum match
+    for(uint8_t i=0; i<SIZE; i++)
+    {
+        const entry_t &entry = mEntries[i];
+        if(entry.tag == tag && entry.checksum == checksum && memcmp(entry.cipher, data, STATE_BYTES) == 0)
+        {
+            memcpy(data, entry.plain, STATE_BYTES);
+            mReserved = NONE;
+            return true;
+        }
+    }
+
+    // Reserve the oldest entry, it becomes valid once the plaintext is stored
+    entry_t &entry = mEntries[mNext];
+    entry.tag = EMPTY;
+    entry.checksum = checksum;
+    memcpy(entry.cipher, data, STATE_BYTES);
+    mReserved = mNext;
+    mReservedTag = tag;
+    if(++mNext >= SIZE) mNext = 0;
+    return false;
+}
+
+void BlockCache::store(const byte_t *data)
+{
+    if(mReserved == NONE) return;
+    entry_t &entry = mEntries[mReserved];
+    memcpy(entry.plain, data, STATE_BYTES);
+    entry.tag = mReservedTag;
+    mReserved = NONE;
+}
+
+void BlockCache::invalidate()
+{
+    // Don't keep plaintexts of the old key in SRAM
+    memset(mEntries, 0, sizeof(mEntries));
+    mReserved = NONE;
+}
@@ -3,12 +3,8 @@
 // **********************************************************************************
 // Timer Methods ********************************************************************
 // **********************************************************************************
-Communication *Communication::Timer::mComm = 0;
-
-void Communication::Timer::init(Communication *comm)
+void Communication::Timer::init()
 {
-    // Init Communication object ****************************************************
-    mComm = comm;
     // Timer settings ***************************************************************
     // Timer/Counter control register description (ATmega644 data sheet p.125-132):
     // ------------------------------------------------------------------------------
@@ -31,148 +27,105 @@ void Communication::Timer::init(Communication *comm)
 
 void Communication::Timer::serviceRoutine()
 {
-    if(!mComm) return;
-    switch(mComm->mDirection)
+    if(!GET_BIT(COMM_FLAGS, FLAG_DIRECTION_INPUT))
     {
-        case PinDir::OUTPUT:
+        if(GET_BIT(COMM_FLAGS, FLAG_PARITY_ERROR))
         {
-            if(mComm->mParityError)
-            {
-                IOPin::setLevel(0); // Indicate an error in the stop bit
-                stop();             // Stop the timer
-                // Wait for the next interrupt on the I/O-Pin
-                IOPin::setDirection(PinDir::INPUT);
-                IOPin::setInterrupt(true);
-            }
-            else
-            {
-                // Send a 0 or 1 depending on the next bit to send
-                IOPin::setLevel(mComm->mOutputBit);
-                mComm->mBitSent = true;
-            }
+            IOPin::setLevel(0); // Indicate an error in the stop bit
+            stop();             // Stop the timer
+            CLR_BIT(COMM_FLAGS, FLAG_PARITY_ERROR);
+            // Wait for the next interrupt on the I/O-Pin
+            IOPin::setDirection(PinDir::INPUT);
+            IOPin::setInterrupt(true);
         }
-        break;
-        
-        case PinDir::INPUT:
+        else
+        {
+            // Send a 0 or 1 depending on the next bit to send
+            IOPin::setLevel(GET_BIT(COMM_FLAGS, FLAG_OUTPUT_BIT));
+            SET_BIT(COMM_FLAGS, FLAG_BIT_SENT);
+        }
+    }
+    // When checking for tranmission errors, stop timer & receive a single bit
+    else if(GET_BIT(COMM_FLAGS, FLAG_CHECK_ERRORS))
+    {
+        stop();
+        if(sampleBit()) SET_BIT(COMM_FLAGS, FLAG_ERROR_BIT);
+        else            CLR_BIT(COMM_FLAGS, FLAG_ERROR_BIT);
+        CLR_BIT(COMM_FLAGS, FLAG_CHECK_ERRORS);
+    }
+    else
+    {
+        const uint8_t counter = COMM_BIT_COUNTER;
+        // After receiving the first data bit, set the match value to 1 ETU
+        if(counter == 0)
+            setMatchValue(ETU);
+        // Read the current bit
+        bit_t currBit = sampleBit();
+        // Bits 0:7 are the data bits. Shift them into the current byte, LSB first
+        if(counter < 8)
+            COMM_INPUT_BYTE = (COMM_INPUT_BYTE >> 1) | (currBit ? 0x80 : 0x00);
+        // Bit 8 is the parity bit
+        else
         {
-            // When checking for tranmission errors, stop timer & receive a single bit
-            if(mComm->mCheckErrors)
+            // If the received parity bit is wrong, set the I/O-Pin
+            // to 0 during the stop bit.
+            if(currBit != getParity(COMM_INPUT_BYTE))
             {
-                stop();
-                mComm->mErrorBit = sampleBit();
-                mComm->mCheckErrors = false;
+                SET_BIT(COMM_FLAGS, FLAG_PARITY_ERROR);
+                Statistics::rxParityError();
+                IOPin::setDirection(PinDir::OUTPUT);
             }
+            // Otherwise, the byte transfer is done & the timer can be stopped
             else
             {
-                // After receiving the first data bit, set the match value to 1 ETU
-                if(mComm->mInputBitCounter == 0)
-                    setMatchValue(ETU);
-                // Read the current bit
-                bit_t currBit = sampleBit();
-                // Bits 0:7 are the data bits. Add them to the current byte
-                if(mComm->mInputBitCounter < 8)
-                    mComm->mInputByte |= (currBit << mComm->mInputBitCounter);
-                // Bit 8 is the parity bit
-                else
-                {
-                    // If the received parity bit is wrong, set the I/O-Pin
-                    // to 0 during the stop bit.
-                    if(currBit != getParity(mComm->mInputByte))
-                    {
-                        mComm->mParityError = true;
-                        IOPin::setDirection(PinDir::OUTPUT);
-                    }
-                    // Otherwise, the byte transfer is done & the timer can be stopped
-                    else
-                    {
-                        stop();
-                        mComm->mByteReceived = true;
-                    }
-                }
-                mComm->mInputBitCounter++;
+                stop();
+                SET_BIT(COMM_FLAGS, FLAG_BYTE_RECEIVED);
             }
         }
-        break;
-
-        default: break;
+        COMM_BIT_COUNTER = counter + 1;
     }
 }
 
 // **********************************************************************************
 // IOPin Methods ********************************************************************
 // **********************************************************************************
-Communication *Communication::IOPin::mComm = 0;
-
-void Communication::IOPin::init(Communication *comm)
+void Communication::IOPin::init()
 {
-    // Init Communication object ****************************************************
-    mComm = comm;
     // Pin settings *****************************************************************
     setDirection(PinDir::INPUT);    // Set direction to input
     setLevel(true);                 // Activate pull-up resistor
 }
 
+#if defined(DEBUG) || !defined(__AVR__)
 void Communication::IOPin::serviceRoutine()
 {
-    if(!mComm) return;
-    if(GET_BIT(PINB, PINB6) == 0 && mComm->mDirection == PinDir::INPUT)
+    if(GET_BIT(PINB, PINB6) == 0 && GET_BIT(COMM_FLAGS, FLAG_DIRECTION_INPUT))
     {
         // Immediately start timer 
         Timer::start();
-        // Set the match value to 1.5*ETU - 50 to sample each bit in the middle
-        Timer::setMatchValue(Timer::ETU*1.5-50);
+        // Set the match value to sample each bit in the middle
+        Timer::setMatchValue(Timer::START_BIT_MATCH);
         // Reset input bit counter & input byte
-        mComm->mInputBitCounter = 0;
-        mComm->mInputByte = 0x00;
+        COMM_BIT_COUNTER = 0;
+        COMM_INPUT_BYTE = 0x00;
         // Disable the interrupt for the I/O-Pin until the next start bit
         setInterrupt(false);
     }
     #ifdef DEBUG
     else
     {
-        if(mComm->mDirection != PinDir::INPUT)
-            mComm->mLog("The I/O-Pin should be set to input right now!\r\n");
+        const Logger log;
+        if(!GET_BIT(COMM_FLAGS, FLAG_DIRECTION_INPUT))
+            log(LogEvent::PIN_NOT_INPUT);
         else
-            mComm->mLog("We either missed the start-bit, or just indicated an error-bit.\r\n");
+            log(LogEvent::MISSED_START_BIT);
     }
     #endif
 }
-
-void Communication::IOPin::setLevel(const bit_t bit)
-{
-    if(bit) SET_BIT(PORTB, PB6);    // Set Pin to high
-    else    CLR_BIT(PORTB, PB6);    // Set Pin to low
-}
-
-void Communication::IOPin::setDirection(const PinDir direction)
-{
-    switch(direction)
-    {
-        case PinDir::INPUT:
-            CLR_BIT(DDRB, DDB6);    // Set direction for I/O-Pin to input
-            break;
-        case PinDir::OUTPUT:
-            SET_BIT(DDRB, DDB6);    // Set direction for I/O-Pin to output
-            break;
-        default:
-            break;
-    }
-    mComm->mDirection = direction;  // Set mDirection
-}
-
-void Communication::IOPin::setInterrupt(const bool enabled)
-{
-    if(enabled)
-    {
-        SET_BIT(PCICR, PCIE1);      // Enable interrupts for pins PCINT15:8
-        SET_BIT(PCMSK1, PCINT14);   // Enable interrupts for PinB6
-    }
-    else
-    {
-        CLR_BIT(PCICR, PCIE1);      // Disable interrupts for Pins PCINT15:8    
-        CLR_BIT(PCMSK1, PCINT14);   // Disable interrupts for PinB6
-    }
-}
+#else
+// The ISR itself is written in assembly in communicationISR.S
+const uint16_t Communication::IOPin::mStartBitMatch = Communication::Timer::START_BIT_MATCH;
+#endif
 
 // **********************************************************************************
 // Communication Methods ************************************************************
@@ -182,6 +135,13 @@ constexpr byte_t Protocol::DATA_IN_HEADER[];
 constexpr byte_t Protocol::DATA_OUT_HEADER[];
 constexpr byte_t Protocol::RESPONSE_DECRYPTED[];
 constexpr byte_t Protocol::RESPONSE_DATA_OUT[];
+constexpr byte_t Protocol::SW_OK[];
+constexpr byte_t Protocol::SW_WRONG_LENGTH[];
+constexpr byte_t Protocol::SW_NOT_FOUND[];
+constexpr byte_t Protocol::SW_WRONG_P1P2[];
+constexpr byte_t Protocol::SW_BUSY[];
+constexpr byte_t Protocol::SW_INS_UNKNOWN[];
+constexpr byte_t Protocol::SW_CLA_UNKNOWN[];
 
 // **********************************************************************************
 // Public Methods *******************************************************************
@@ -189,20 +149,47 @@ constexpr byte_t Protocol::RESPONSE_DATA_OUT[];
 
 Communication::Communication()
 {
+    // Init ISR-shared state *******************************************************
+    COMM_FLAGS = (1<<FLAG_BIT_SENT);
+    COMM_BIT_COUNTER = 0;
+    COMM_INPUT_BYTE = 0x00;
     // Init Timer class *************************************************************
-    Timer::init(this);
+    Timer::init();
     // Init IOPin class *************************************************************
-    IOPin::init(this);
+    IOPin::init();
 }
 
-void Communication::receiveDataToDecrypt(byte_t *data)
+bool Communication::receiveCommand(byte_t *header)
 {
     // Receive header
-    receiveProtocolHeader(Protocol::DATA_IN_HEADER);
-    // Receive key byte by byte & send ACK
-    for(uint8_t i=0; i<KEY_BYTES; i++)
+    for(uint8_t i=0; i<Protocol::HEADER_LENGTH; i++)
+        header[i] = receiveByte();
+    // Check the class byte
+    if(header[Protocol::CLA_INDEX] != Protocol::DATA_IN_HEADER[Protocol::CLA_INDEX])
     {
-        sendByte(Protocol::ACK_DATA_IN);    // Send OxEF (the last byte will not have an ACK)
+        rejectCommand(Protocol::SW_CLA_UNKNOWN);
+        return false;
+    }
+    return true;
+}
+
+void Communication::rejectCommand(const byte_t *status)
+{
+    Statistics::commandRejected();
+    #ifdef DEBUG
+    mLog(LogEvent::COMMAND_REJECTED, status, Protocol::RESPONSE_LENGTH);
+    #endif
+    sendStatus(status);
+}
+
+void Communication::receiveData(const byte_t *header, byte_t *data)
+{
+    // Receive data byte by byte & send the inverted instruction byte as ACK before each byte,
+    // e.g. 0xEF for Protocol::INS_DATA_IN
+    const byte_t ack = header[Protocol::INS_INDEX] ^ 0xff;
+    for(uint8_t i=0; i<header[Protocol::P3_INDEX]; i++)
+    {
+        sendByte(ack);                      // Send ACK
         data[i] = receiveByte();            // Receive byte
     }
 }
@@ -221,15 +208,33 @@ void Communication::sendDecryptedData(const byte_t *data)
     sendBytes(Protocol::RESPONSE_DATA_OUT, Protocol::RESPONSE_LENGTH);
 }
 
+void Communication::sendResponseData(const byte_t *header, const byte_t *data, const uint8_t len)
+{
+    // Tell the Terminal the correct length
+    if(header[Protocol::P3_INDEX] != len)
+    {
+        sendByte(Protocol::SW_WRONG_LE);
+        sendByte(len);
+        return;
+    }
+    // Send Acknowledge
+    sendByte(header[Protocol::INS_INDEX]);
+    // Send the data & the status
+    sendBytes(data, len);
+    sendStatus(Protocol::SW_OK);
+}
+
 // **********************************************************************************
 // Private Methods ******************************************************************
 // **********************************************************************************
 
 void Communication::sendBit(const bit_t bit)
 {
-    while(!mBitSent);   // Wait for the last bit to be sent
-    mBitSent = false;   // Set #mBitSent to false
-    mOutputBit = bit;   // Send next bit
+    Scheduler::waitFor(COMM_FLAGS, FLAG_BIT_SENT, true, false);    // Wait for the last bit to be sent
+    CLR_BIT(COMM_FLAGS, FLAG_BIT_SENT);
+    // Send next bit
+    if(bit) SET_BIT(COMM_FLAGS, FLAG_OUTPUT_BIT);
+    else    CLR_BIT(COMM_FLAGS, FLAG_OUTPUT_BIT);
 }
 
 void Communication::sendByte(const byte_t byte)
@@ -250,22 +255,23 @@ void Communication::sendByte(const byte_t byte)
             sendBit(byte & mask);           // Send each data bit individually
         sendBit(getParity(byte));           // Send parity (1 if number of set bits is odd, 0 otherwise)
         sendBit(STOP_BIT);                  // Send stop bit (1)
-        while(!mBitSent);                   // Assure that stop bit was sent correctly
+        Scheduler::waitFor(COMM_FLAGS, FLAG_BIT_SENT, true, false);    // Assure that stop bit was sent correctly
         
         // Check for errors *********************************************************
-        mCheckErrors = true;
-        mErrorBit = 1;                      // Set error bit to true, to ensure it is read correctly
+        SET_BIT(COMM_FLAGS, FLAG_CHECK_ERRORS);
+        SET_BIT(COMM_FLAGS, FLAG_ERROR_BIT);    // Set error bit to true, to ensure it is read correctly
         Timer::setMatchValue(Timer::ETU-50);// Set match value to 372-50 to make sure we don't miss the error indication
         IOPin::setDirection(PinDir::INPUT); // Now receiving data
         Timer::start();                     // Start timer to check for errors
-        while(mCheckErrors);                // Wait until the error-bit is read
-    } while(!mErrorBit);
+        Scheduler::waitFor(COMM_FLAGS, FLAG_CHECK_ERRORS, false, false);   // Wait until the error-bit is read
+        if(!GET_BIT(COMM_FLAGS, FLAG_ERROR_BIT)) Statistics::txRetransmit();
+    } while(!GET_BIT(COMM_FLAGS, FLAG_ERROR_BIT));
 
     // End of transfer **************************************************************
     Timer::stop();                          // Stop the timer
 }
 
-bit_t Communication::sampleBit()
+inline bit_t Communication::sampleBit()
 {
     int8_t majority = 0;
     // Sample 3x & make majority decision (see Wolfgang Rank, Smart Card Handbook p. 247)
@@ -280,35 +286,33 @@ byte_t Communication::receiveByte()
     // Set I/O-Pin to input & enable interrupt
     IOPin::setDirection(PinDir::INPUT);
     IOPin::setInterrupt(true);
-    mByteReceived = false;
-    // Wait until the byte was received correctly
-    while(!mByteReceived);
-    return mInputByte;
+    CLR_BIT(COMM_FLAGS, FLAG_BYTE_RECEIVED);
+    // Wait until the byte was received correctly & run background jobs in the meantime
+    Scheduler::waitFor(COMM_FLAGS, FLAG_BYTE_RECEIVED, true, true);
+    return COMM_INPUT_BYTE;
 }
 
 void Communication::receiveProtocolHeader(const byte_t *header)
 {
-    #ifdef DEBUG
     byte_t receivedByte = 0x00;
-    char msg[70];
-    #endif
+    bool mismatch = false;
     for(uint8_t i=0; i<Protocol::HEADER_LENGTH; i++)
     {
-        // Some debugging output
-        #ifdef DEBUG
         receivedByte = receiveByte();
         if(receivedByte != header[i])
         {
-            sprintf(msg, "Received wrong byte 0x%X instead of 0x%X at sequence position %d.\r\n", receivedByte, header[i], i);
-            mLog(msg);
+            mismatch = true;
+            // Some debugging output
+            #ifdef DEBUG
+            const uint8_t mismatchInfo[] = {receivedByte, header[i], i};
+            mLog(LogEvent::HEADER_MISMATCH, mismatchInfo, sizeof(mismatchInfo));
+            #endif
         }
-        #else
-        receiveByte();
-        #endif
     }
+    if(mismatch) Statistics::headerMismatch();
 }
 
-bit_t Communication::getParity(byte_t byte)
+inline bit_t Communication::getParity(byte_t byte)
 {
     byte ^= byte >> 4;
     byte ^= byte >> 2;
@@ -0,0 +1,54 @@
+#include "cycleCounter.h"
+
+volatile uint16_t CycleCounter::mOverflows = 0;
+uint8_t CycleCounter::mSavedTCCR1B = 0;
+uint8_t CycleCounter::mSavedTIMSK1 = 0;
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void CycleCounter::start()
+{
+    // Save the Timer1 configuration of the Communication class
+    mSavedTCCR1B = TCCR1B;
+    mSavedTIMSK1 = TIMSK1;
+    // Stop the timer & switch to normal mode with overflow interrupts
+    TCCR1B = 0x00;
+    TIMSK1 = (1<<TOIE1);
+    TIFR1 = (1<<TOV1);      // Writing a one clears only the pending overflow
+    TCNT1 = 0x0000;
+    mOverflows = 0;
+    // Start the timer without a prescaler
+    SET_BIT(TCCR1B, CS10);
+}
+
+uint32_t CycleCounter::now()
+{
+    const uint8_t sreg = SREG;
+    cli();
+    uint16_t low = TCNT1;
+    uint16_t high = mOverflows;
+    // An overflow happened, but its ISR has not run yet
+    if(GET_BIT(TIFR1, TOV1) && low < 0x8000) high++;
+    SREG = sreg;
+    return (static_cast<uint32_t>(high) << 16) | low;
+}
+
+uint32_t CycleCounter::stop()
+{
+    const uint32_t cycles = now();
+    // Restore the Timer1 configuration of the Communication class
+    TCCR1B = 0x00;
+    TIMSK1 = mSavedTIMSK1;
+    TIFR1 = (1<<OCF1A);     // Clear only a compare match, that happened while counting
+    TCCR1B = mSavedTCCR1B;
+    return cycles;
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+void CycleCounter::overflowRoutine()
+{
+    mOverflows++;
+}
\ No newline at end of file
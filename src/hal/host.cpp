@@ -0,0 +1,70 @@
+#include "hal/hal.h"
+
+HostRegister<uint8_t> HostHardware::portB;
+HostRegister<uint8_t> HostHardware::ddrB;
+HostRegister<uint8_t> HostHardware::pinB;
+HostRegister<uint8_t> HostHardware::tccr1A;
+HostRegister<uint8_t> HostHardware::tccr1B;
+HostRegister<uint8_t> HostHardware::timsk1;
+HostRegister<uint8_t> HostHardware::tifr1;
+HostRegister<uint16_t> HostHardware::tcnt1;
+HostRegister<uint16_t> HostHardware::ocr1A;
+HostRegister<uint8_t> HostHardware::pcicr;
+HostRegister<uint8_t> HostHardware::pcifr;
+HostRegister<uint8_t> HostHardware::pcmsk1;
+HostRegister<uint8_t> HostHardware::adcsrA;
+HostRegister<uint8_t> HostHardware::admux;
+HostRegister<uint8_t> HostHardware::adcL;
+HostRegister<uint8_t> HostHardware::adcH;
+HostRegister<uint8_t> HostHardware::ucsr0A;
+HostRegister<uint8_t> HostHardware::ucsr0B;
+HostRegister<uint8_t> HostHardware::ucsr0C;
+HostRegister<uint8_t> HostHardware::ubrr0H;
+HostRegister<uint8_t> HostHardware::ubrr0L;
+HostRegister<uint8_t> HostHardware::udr0;
+HostRegister<uint8_t> HostHardware::sreg;
+HostRegister<uint8_t> HostHardware::mcusr;
+volatile uint8_t HostHardware::gpior0 = 0;
+volatile uint8_t HostHardware::gpior1 = 0;
+volatile uint8_t HostHardware::gpior2 = 0;
+void (*HostHardware::sleepHook)() = nullptr;
+
+// The linker provides the bounds of the emulated EEPROM
+extern uint8_t __start_hal_eeprom[] __attribute__((__weak__));
+extern uint8_t __stop_hal_eeprom[] __attribute__((__weak__));
+
+namespace
+{
+    /**
+     * @brief Finish an ADC conversion as soon as it is started, with noise in the LSBs.
+     * @param[in] reg (HostRegister<uint8_t>&): ADCSRA.
+     */
+    void convert(HostRegister<uint8_t> &reg)
+    {
+        static uint16_t noise = 0xace1;
+        if(!(reg.value & (1<<ADSC))) return;
+        // 16-bit Galois LFSR
+        noise = (noise >> 1) ^ (-(noise & 1u) & 0xb400u);
+        HostHardware::adcL.value = static_cast<uint8_t>(0x80 | (noise & 0x0f));
+        HostHardware::adcH.value = 0x01;
+        reg.value = static_cast<uint8_t>((reg.value & ~(1<<ADSC)) | (1<<ADIF));
+    }
+
+    /**
+     * @brief Set up the emulated hardware before main() is called.
+     */
+    struct PowerOn
+    {
+        PowerOn()
+        {
+            HostHardware::adcsrA.onWrite = convert;
+            HostHardware::eraseEeprom();
+        }
+    } powerOn;
+}
+
+void HostHardware::eraseEeprom()
+{
+    if(__start_hal_eeprom && __stop_hal_eeprom)
+        memset(__start_hal_eeprom, 0xff, __stop_hal_eeprom - __start_hal_eeprom);
+}
@@ -0,0 +1,5 @@
+#include "leakage.h"
+
+void (*Leakage::onWrite)(const uint8_t before, const uint8_t after) = nullptr;
+void (*Leakage::onIdle)(const uint8_t nops) = nullptr;
+void (*Leakage::onRound)(const uint8_t round, const state_t state) = nullptr;
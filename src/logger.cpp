@@ -1,7 +1,13 @@
 #include "logger.h"
 
+uint8_t Logger::mBuffer[BUFFER_SIZE] = {};
+volatile uint8_t Logger::mHead = 0;
+volatile uint8_t Logger::mTail = 0;
+uint8_t Logger::mDropped = 0;
+
 void Logger::init()
 {
+    #ifdef LOG_USART
     // Enable 2x speed
     SET_BIT(UCSR0A, U2X0);
     // Set baud rate
@@ -12,29 +18,87 @@ void Logger::init()
     // Set frame format: 8 data-bits, 1 stop-bit
     UCSR0C |= (3<<UCSZ00);
     CLR_BIT(UCSR0C, USBS0);
+    #endif
+    (*this)(LogEvent::BOOT);
 }
 
-void Logger::operator()(const uint8_t *arr, const uint8_t len) const
+void Logger::operator()(const LogEvent event, const uint8_t *data, const uint8_t len) const
 {
-    char msg[4];
-    for(uint8_t i=0; i<len; i++)
+    const uint8_t sreg = SREG;
+    cli();
+    // Report dropped records first, as soon as there is space again
+    if(mDropped && freeBytes() >= 3)
     {
-        sprintf(msg, " %x", arr[i]);
-        sendStr(msg);
+        put(LogEvent::DROPPED, &mDropped, sizeof(mDropped));
+        mDropped = 0;
     }
-    sendStr("\r\n");
-}   
+    if(freeBytes() >= len + 2)
+        put(event, data, len);
+    else if(mDropped != UINT8_MAX)
+        mDropped++;
+    #ifdef LOG_USART
+    // Start draining the buffer, once the transmitter is enabled
+    if(GET_BIT(UCSR0B, TXEN0)) SET_BIT(UCSR0B, UDRIE0);
+    #endif
+    SREG = sreg;
+}
+
+#ifndef LOG_USART
+uint8_t Logger::read(uint8_t *data, const uint8_t maxLen)
+{
+    const uint8_t sreg = SREG;
+    cli();
+    // Only copy complete records
+    uint8_t len = 0;
+    const uint8_t used = (mHead - mTail) & INDEX_MASK;
+    while(len < used)
+    {
+        const uint8_t recordLen = mBuffer[(mTail + len + 1) & INDEX_MASK] + 2;
+        if(len + recordLen > maxLen) break;
+        len += recordLen;
+    }
+    for(uint8_t i=0; i<len; i++)
+        data[i] = mBuffer[(mTail + i) & INDEX_MASK];
+    SREG = sreg;
+    return len;
+}
 
-void Logger::sendChar(const char data) const
+void Logger::remove(const uint8_t len)
 {
-    // Wait for empty transmit buffer
-    while (!(GET_BIT(UCSR0A, UDRE0)));
-    // Put data into buffer, sends the data
-    UDR0 = data;
+    const uint8_t sreg = SREG;
+    cli();
+    mTail = (mTail + len) & INDEX_MASK;
+    SREG = sreg;
 }
+#endif
 
-void Logger::sendStr(const char* str) const
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+void Logger::put(const LogEvent event, const uint8_t *data, const uint8_t len)
 {
-    while(*str != '\0')
-        sendChar(*str++);
-}
\ No newline at end of file
+    uint8_t head = mHead;
+    mBuffer[head] = static_cast<uint8_t>(event);
+    head = (head + 1) & INDEX_MASK;
+    mBuffer[head] = len;
+    head = (head + 1) & INDEX_MASK;
+    for(uint8_t i=0; i<len; i++)
+    {
+        mBuffer[head] = data[i];
+        head = (head + 1) & INDEX_MASK;
+    }
+    mHead = head;
+}
+
+#ifdef LOG_USART
+void Logger::serviceRoutine()
+{
+    if(mHead != mTail)
+    {
+        UDR0 = mBuffer[mTail];
+        mTail = (mTail + 1) & INDEX_MASK;
+    }
+    else
+        CLR_BIT(UCSR0B, UDRIE0);    // Buffer is empty
+}
+#endif
@@ -1,10 +1,3 @@
-#ifdef __cplusplus
-extern "C" {
-#include <avr/io.h>
-#include <util/delay.h>
-}
-#endif
-
 #ifdef DEBUG
 #include "logger.h"
 #endif
@@ -12,12 +5,43 @@ extern "C" {
 #include "defs.h"
 #include "aes.h"
 #include "communication.h"
+#include "scheduler.h"
+#include "statistics.h"
+#include "profiler.h"
+#include "keyStore.h"
+
+#ifdef BLOCK_CACHE
+#include "blockCache.h"
+#endif
+
+#if defined(PROFILING) && defined(DEBUG)
+static constexpr uint8_t PROFILE_LOG_INTERVAL = 64;    ///< Number of decrypted blocks after which the Profiler measurements are logged
+#endif
 
 int main()
 {
     // Initialization ***************************************************************
     // Communication Protocol
     Communication comm;
+    byte_t header[Protocol::HEADER_LENGTH] = {};
+
+    // Performance & link-quality counters
+    Statistics::init();
+
+    // Global interrupts
+    sei();
+
+    // Send ATR
+    // ISO 7816-3 requires the ATR within 40000 clock cycles after the reset, so it is sent as soon as
+    // the Communication is ready. Everything else is initialized afterwards or lazily in the background.
+    comm.sendATR();
+
+    #ifdef PROFILING
+    Profiler::init();
+    #if defined(DEBUG)
+    uint8_t profiledBlocks = 0;
+    #endif
+    #endif
 
     // RNG
     #if defined(MASKING) || defined(SHUFFLING) || defined(DUMMY_OPS)
@@ -27,50 +51,181 @@ int main()
     // Setting direction trigger (JP5) pin
     SET_BIT(DDRB, DDB4);
     
+    // Key slots, the default key is only loaded into slot 0, if it is empty
+    KeyStore::init(KeyStore::DEFAULT_KEY);
+    // Load keys in the background
+    Scheduler::addJob(KeyStore::loadStep, nullptr);
+
     // AES
-    uint8_t key[] = { 0xff, 0xcd, 0x13, 0xbd, 0xd3, 0xc8, 0x7f, 0xb4, 0x41, 0x25, 0xe8, 0x46, 0x18, 0xfa, 0xb7, 0xd4 };
-    AES aes(key);
+    AES aes;
     uint8_t cipher[STATE_BYTES] = {};
 
+    // Precompute the countermeasures for the next decryption while waiting for the Terminal
+    #if defined(MASKING) || defined(SHUFFLING) || defined(DUMMY_OPS)
+    Scheduler::addJob(AES::precompute, &aes);
+    #endif
+
     // Logger
     #ifdef DEBUG
     Logger log;
     log.init();
     #endif
-
-    // Global interrupts
-    sei();
-
-    // Send ATR
-    comm.sendATR();
     
     // Infinite loop ****************************************************************
     while(1)
     {
-        // Receive data to decrypt
-        comm.receiveDataToDecrypt(cipher);
+        // Receive the next command
+        if(!comm.receiveCommand(header)) continue;
 
-        // Received data
-        #ifdef DEBUG
-        log("Received data to decrypt: ");
-        log(cipher, KEY_BYTES);
-        #endif
+        switch(header[Protocol::INS_INDEX])
+        {
+            // Decrypt a block **********************************************************
+            case Protocol::INS_DECRYPT:
+            {
+                if(header[Protocol::P3_INDEX] != STATE_BYTES)
+                {
+                    comm.rejectCommand(Protocol::SW_WRONG_LENGTH);
+                    break;
+                }
+                if(header[Protocol::P1_INDEX] != 0x00 || header[Protocol::P2_INDEX] >= KeyStore::NUM_SLOTS)
+                {
+                    comm.rejectCommand(Protocol::SW_WRONG_P1P2);
+                    break;
+                }
+                // Select the key slot
+                if(!aes.selectKey(header[Protocol::P2_INDEX]))
+                {
+                    comm.rejectCommand(Protocol::SW_NOT_FOUND);
+                    break;
+                }
 
-        // Setting value of trigger (JP5) pin
-        SET_BIT(PORTB, PB4);
-    
-        // Decrypt data
-        aes.decrypt(cipher);
-
-        // Clearing value of trigger (JP5) pin
-        CLR_BIT(PORTB, PB4);
-        
-        // Decrypted data
-        #ifdef DEBUG
-        log("Decrypted data: ");
-        log(cipher, KEY_BYTES);
-        #endif
-        // Send the decrypted data back
-        comm.sendDecryptedData(cipher);
+                // Receive data to decrypt
+                comm.receiveDataToDecrypt(cipher);
+
+                // Received data
+                #ifdef DEBUG
+                log(LogEvent::RECEIVED_DATA, cipher, KEY_BYTES);
+                #endif
+
+                // Answer a retransmitted block from the cache
+                #ifdef BLOCK_CACHE
+                if(!BlockCache::lookup(header[Protocol::P2_INDEX], cipher))
+                #endif
+                {
+                    // Setting value of trigger (JP5) pin
+                    SET_BIT(PORTB, PB4);
+                
+                    // Decrypt data
+                    aes.decrypt(cipher);
+
+                    // Clearing value of trigger (JP5) pin
+                    CLR_BIT(PORTB, PB4);
+
+                    #ifdef BLOCK_CACHE
+                    BlockCache::store(cipher);
+                    #endif
+                }
+                
+                // Decrypted data
+                #ifdef DEBUG
+                log(LogEvent::DECRYPTED_DATA, cipher, KEY_BYTES);
+                #endif
+                // Send the decrypted data back
+                comm.sendDecryptedData(cipher);
+
+                // Log the cycles per phase every now & then
+                #if defined(PROFILING) && defined(DEBUG)
+                if(++profiledBlocks >= PROFILE_LOG_INTERVAL)
+                {
+                    Profiler::log(log);
+                    profiledBlocks = 0;
+                }
+                #endif
+            }
+            break;
+
+            // Load a key into a slot ************************************************
+            case Protocol::INS_LOAD_KEY:
+            {
+                if(header[Protocol::P3_INDEX] != KEY_BYTES)
+                {
+                    comm.rejectCommand(Protocol::SW_WRONG_LENGTH);
+                    break;
+                }
+                if(header[Protocol::P1_INDEX] != 0x00 || header[Protocol::P2_INDEX] >= KeyStore::NUM_SLOTS)
+                {
+                    comm.rejectCommand(Protocol::SW_WRONG_P1P2);
+                    break;
+                }
+                if(KeyStore::busy())
+                {
+                    comm.rejectCommand(Protocol::SW_BUSY);
+                    break;
+                }
+
+                // Receive the key & expand & store it in the background
+                uint8_t newKey[KEY_BYTES];
+                comm.receiveData(header, newKey);
+                KeyStore::load(header[Protocol::P2_INDEX], newKey);
+                memset(newKey, 0, KEY_BYTES);
+                #ifdef BLOCK_CACHE
+                BlockCache::invalidate();
+                #endif
+                comm.sendStatus(Protocol::SW_OK);
+            }
+            break;
+
+            // Read counters & measurements *********************************************
+            case Protocol::INS_GET_DATA:
+            {
+                if(header[Protocol::P1_INDEX] != 0x00)
+                {
+                    comm.rejectCommand(Protocol::SW_NOT_FOUND);
+                    break;
+                }
+                switch(header[Protocol::P2_INDEX])
+                {
+                    case Protocol::TAG_COUNTERS:
+                    {
+                        Statistics::record_t record;
+                        Statistics::read(record);
+                        comm.sendResponseData(header, reinterpret_cast<const byte_t*>(&record), sizeof(record));
+                    }
+                    break;
+
+                    #ifdef PROFILING
+                    case Protocol::TAG_PROFILE:
+                        comm.sendResponseData(header, reinterpret_cast<const byte_t*>(&Profiler::record()), sizeof(Profiler::record_t));
+                        break;
+                    #endif
+
+                    #if defined(DEBUG) && !defined(LOG_USART)
+                    case Protocol::TAG_LOG:
+                    {
+                        // Read as many complete records as requested, the Terminal is told the correct length otherwise
+                        uint8_t records[Logger::BUFFER_SIZE];
+                        const uint8_t len = Logger::read(records, header[Protocol::P3_INDEX] < Logger::BUFFER_SIZE ? header[Protocol::P3_INDEX] : Logger::BUFFER_SIZE);
+                        if(len == 0)
+                            comm.sendStatus(Protocol::SW_OK);
+                        else
+                        {
+                            comm.sendResponseData(header, records, len);
+                            if(len == header[Protocol::P3_INDEX]) Logger::remove(len);
+                        }
+                    }
+                    break;
+                    #endif
+
+                    default:
+                        comm.rejectCommand(Protocol::SW_NOT_FOUND);
+                        break;
+                }
+            }
+            break;
+
+            default:
+                comm.rejectCommand(Protocol::SW_INS_UNKNOWN);
+                break;
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "profiler.h"
+
+Profiler::record_t Profiler::mRecord = {};
+uint32_t Profiler::mStart[NUM_PHASES] = {};
+uint8_t Profiler::mOverhead = 0;
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void Profiler::init()
+{
+    memset(&mRecord, 0, sizeof(record_t));
+    mRecord.version = RECORD_VERSION;
+    for(uint8_t i=0; i<NUM_PHASES; i++)
+        mRecord.phases[i].minCycles = UINT16_MAX;
+
+    // Measure an empty phase to calibrate the overhead
+    mOverhead = 0;
+    CycleCounter::start();
+    begin(Phase::ADD_ROUND_KEY);
+    end(Phase::ADD_ROUND_KEY);
+    CycleCounter::stop();
+    mOverhead = mRecord.phases[0].lastCycles;
+
+    memset(&mRecord.phases[0], 0, sizeof(phase_t));
+    mRecord.phases[0].minCycles = UINT16_MAX;
+}
+
+void Profiler::begin(const Phase phase)
+{
+    const uint8_t index = static_cast<uint8_t>(phase);
+    #ifdef PROFILING_TRIGGER
+    // Mark the phase with index+1 low pulses on the trigger (JP5) pin
+    for(uint8_t i=0; i<=index; i++)
+    {
+        CLR_BIT(PORTB, PB4);
+        __asm__("nop");
+        SET_BIT(PORTB, PB4);
+        __asm__("nop");
+    }
+    #endif
+    mStart[index] = CycleCounter::now();
+}
+
+void Profiler::end(const Phase phase)
+{
+    const uint32_t now = CycleCounter::now();
+    const uint8_t index = static_cast<uint8_t>(phase);
+    phase_t &measurement = mRecord.phases[index];
+
+    // Elapsed cycles without the overhead of the measurement itself
+    uint32_t elapsed = now - mStart[index];
+    elapsed = (elapsed > mOverhead) ? elapsed - mOverhead : 0;
+    const uint16_t cycles = (elapsed > UINT16_MAX) ? UINT16_MAX : elapsed;
+
+    // Update the measurements
+    if(measurement.count != UINT16_MAX) measurement.count++;
+    if(cycles < measurement.minCycles) measurement.minCycles = cycles;
+    if(cycles > measurement.maxCycles) measurement.maxCycles = cycles;
+    measurement.lastCycles = cycles;
+    if(measurement.totalCycles <= UINT32_MAX - cycles) measurement.totalCycles += cycles;
+
+    // The bin is the bit-length of the cycles shifted by HISTOGRAM_SHIFT
+    uint8_t bin = 0;
+    for(uint16_t value = cycles >> HISTOGRAM_SHIFT; value && bin < HISTOGRAM_BINS-1; value >>= 1)
+        bin++;
+    if(measurement.histogram[bin] != UINT16_MAX) measurement.histogram[bin]++;
+}
+
+#ifdef DEBUG
+void Profiler::log(const Logger &logger)
+{
+    // Phase index followed by the count, min, max, last & total cycles of the phase
+    uint8_t payload[1 + offsetof(phase_t, histogram)];
+    for(uint8_t i=0; i<NUM_PHASES; i++)
+    {
+        if(mRecord.phases[i].count == 0) continue;
+        payload[0] = i;
+        memcpy(&payload[1], &mRecord.phases[i], offsetof(phase_t, histogram));
+        logger(LogEvent::PROFILE_PHASE, payload, sizeof(payload));
+    }
+}
+#endif
@@ -0,0 +1,36 @@
+#include "scheduler.h"
+
+Scheduler::entry_t Scheduler::mJobs[MAX_JOBS] = {};
+uint8_t Scheduler::mNumJobs = 0;
+uint8_t Scheduler::mNextJob = 0;
+bool Scheduler::mRunning = false;
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+bool Scheduler::addJob(job_t job, void *context)
+{
+    if(mNumJobs >= MAX_JOBS) return false;
+    mJobs[mNumJobs].job = job;
+    mJobs[mNumJobs].context = context;
+    mNumJobs++;
+    return true;
+}
+
+bool Scheduler::yield()
+{
+    // Never run jobs from within an ISR or another job
+    if(mRunning || !GET_BIT(SREG, SREG_I)) return false;
+
+    mRunning = true;
+    bool busy = false;
+    // Call the jobs round-robin, until one of them has work left
+    for(uint8_t i=0; i<mNumJobs && !busy; i++)
+    {
+        entry_t &entry = mJobs[mNextJob];
+        if(++mNextJob >= mNumJobs) mNextJob = 0;
+        busy = entry.job(entry.context);
+    }
+    mRunning = false;
+    return busy;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "statistics.h"
+
+uint16_t Statistics::mMagic __attribute__((section(".noinit")));
+Statistics::record_t Statistics::mRecord __attribute__((section(".noinit")));
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void Statistics::init()
+{
+    if(mMagic == MAGIC && mRecord.version == RECORD_VERSION) return;
+    // Clear the counters after a power-on reset
+    memset(&mRecord, 0, sizeof(record_t));
+    mRecord.version = RECORD_VERSION;
+    mRecord.minDecryptCycles = UINT32_MAX;
+    mMagic = MAGIC;
+}
+
+void Statistics::blockDecrypted(const uint32_t cycles)
+{
+    if(mRecord.blocksDecrypted == 0)
+        mRecord.avgDecryptCycles = cycles;
+    else if(cycles >= mRecord.avgDecryptCycles)
+        mRecord.avgDecryptCycles += (cycles - mRecord.avgDecryptCycles) >> AVG_WEIGHT_SHIFT;
+    else
+        mRecord.avgDecryptCycles -= (mRecord.avgDecryptCycles - cycles) >> AVG_WEIGHT_SHIFT;
+
+    if(cycles < mRecord.minDecryptCycles) mRecord.minDecryptCycles = cycles;
+    if(cycles > mRecord.maxDecryptCycles) mRecord.maxDecryptCycles = cycles;
+    if(mRecord.blocksDecrypted != UINT32_MAX) mRecord.blocksDecrypted++;
+}
+
+void Statistics::read(record_t &record)
+{
+    // The parity errors are counted in an ISR
+    const uint8_t sreg = SREG;
+    cli();
+    memcpy(&record, &mRecord, sizeof(record_t));
+    SREG = sreg;
+}
\ No newline at end of file
@@ -0,0 +1,306 @@
+/**
+ * @file aesBench.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Micro-benchmarks of the firmware's AES, Masking, Hiding & RNG & of the host AES engines on the host.
+ *
+ * Usage: `aesBench_<variant> [minTimeMs]`
+ *
+ * Each benchmark is run in batches until at least `minTimeMs` (default 50) have passed.
+ * The median of 5 batches is reported. The results are printed as a single JSON object:
+ *
+ *     {"variant": "masking", "defines": ["MASKING"], "benchmarks": [
+ *         {"name": "decrypt", "unit": "block", "ns_per_op": 1234.5, "ops_per_s": 810045.4, "allocations": 0}, ...]}
+ *
+ * `allocations` counts the calls of malloc() & operator new during the benchmark, which should always be 0,
+ * since the firmware never allocates memory. It is -1 if allocations can't be counted (only glibc is supported).
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "aes.h"
+#include "aesMath.h"
+#include "keyStore.h"
+#include "rng.h"
+#if defined(SHUFFLING) || defined(DUMMY_OPS)
+#include "hiding.h"
+#endif
+#include "host/hostAES.h"
+
+#ifndef VARIANT
+#define VARIANT "plain"     ///< Name of the countermeasure combination, set by CMake
+#endif
+
+// Allocation counter *******************************************************************
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+
+static long gAllocations = 0;   ///< Number of calls of malloc() & operator new
+
+extern "C" void *malloc(size_t size)
+{
+    gAllocations++;
+    return __libc_malloc(size);
+}
+#else
+static long gAllocations = -1;
+#endif
+
+void *operator new(size_t size)
+{
+    void *memory = malloc(size);
+    if(!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+namespace
+{
+    typedef std::chrono::steady_clock bench_clock_t;
+
+    constexpr int BATCHES = 5;  ///< Number of measured batches per benchmark
+
+    /**
+     * @brief Result of a single benchmark.
+     */
+    struct result_t
+    {
+        const char *name;   ///< Name of the benchmark
+        const char *unit;   ///< What a single operation is
+        double nsPerOp;     ///< Median nanoseconds per operation
+        long allocations;   ///< Number of allocations during the benchmark
+    };
+
+    volatile uint8_t gSink = 0;     ///< Keeps the compiler from optimizing the benchmarks away
+    double gMinTime = 0.05;         ///< Minimum time of a batch in seconds
+
+    /**
+     * @brief Run @p op in batches & measure the median time per call.
+     * @param[in] name (const char*): Name of the benchmark.
+     * @param[in] unit (const char*): What a single operation is.
+     * @param[in] op (Op): The operation.
+     * @param[in] opsPerCall (const long): Number of operations per call of @p op, e.g. the blocks of a batch.
+     * @return (result_t): The result.
+     */
+    template<typename Op>
+    result_t measure(const char *name, const char *unit, Op op, const long opsPerCall = 1)
+    {
+        // Find a batch size, that takes at least gMinTime
+        long iterations = 1;
+        while(true)
+        {
+            const bench_clock_t::time_point start = bench_clock_t::now();
+            for(long i=0; i<iterations; i++) op();
+            const double elapsed = std::chrono::duration<double>(bench_clock_t::now() - start).count();
+            if(elapsed >= gMinTime) break;
+            iterations *= elapsed > 0 ? std::max(2l, static_cast<long>(1.2 * gMinTime / elapsed)) : 10;
+        }
+
+        const long allocations = gAllocations;
+        double nsPerOp[BATCHES];
+        for(int batch=0; batch<BATCHES; batch++)
+        {
+            const bench_clock_t::time_point start = bench_clock_t::now();
+            for(long i=0; i<iterations; i++) op();
+            nsPerOp[batch] = std::chrono::duration<double, std::nano>(bench_clock_t::now() - start).count() / (iterations * opsPerCall);
+        }
+        std::sort(nsPerOp, nsPerOp + BATCHES);
+        return {name, unit, nsPerOp[BATCHES/2], gAllocations < 0 ? -1 : gAllocations - allocations};
+    }
+
+    /**
+     * @brief Load @p key into @p slot & wait until it is written to the (emulated) EEPROM.
+     * @param[in] slot (const uint8_t): The slot.
+     * @param[in] key (const @ref aes_key_t): The key.
+     */
+    void loadKey(const uint8_t slot, const aes_key_t key)
+    {
+        KeyStore::load(slot, key);
+        while(KeyStore::loadStep(nullptr));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if(argc > 1) gMinTime = atof(argv[1]) / 1000.0;
+
+    const aes_key_t key = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    KeyStore::init(key);
+    while(KeyStore::loadStep(nullptr));
+    loadKey(0, key);
+
+    std::vector<result_t> results;
+    results.reserve(16);
+
+    // Key schedule *********************************************************************
+    sub_keys_t subKeys = {};
+    memcpy(subKeys[0], key, KEY_BYTES);
+    results.push_back(measure("keySchedule", "schedule", [&]()
+    {
+        for(uint8_t i=1; i<=ROUNDS; i++) AES::createRoundKey(subKeys, i);
+        gSink = gSink + subKeys[ROUNDS][0];
+    }));
+
+    // Construction & reading the key schedule from the KeyStore ************************
+    results.push_back(measure("construct+selectKey", "key", [&]()
+    {
+        AES aes;
+        gSink = gSink + aes.selectKey(0);
+    }));
+
+    // Decryption ***********************************************************************
+    AES aes;
+    aes.selectKey(0);
+    uint8_t block[STATE_BYTES] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+    results.push_back(measure("decrypt", "block", [&]()
+    {
+        aes.decrypt(block);
+    }));
+    #if defined(MASKING) || defined(SHUFFLING) || defined(DUMMY_OPS)
+    // On the card, the countermeasures are refreshed in the background, while waiting for the Terminal
+    results.push_back(measure("decrypt+precompute", "block", [&]()
+    {
+        while(AES::precompute(&aes));
+        aes.decrypt(block);
+    }));
+    #endif
+    // A batch of independent blocks: the countermeasures are initialized once & AES::PARALLEL_BLOCKS are interleaved
+    static uint8_t batch[64*STATE_BYTES] = {};
+    results.push_back(measure("decryptBlocks", "block", [&]()
+    {
+        aes.decryptBlocks(batch, batch, 64);
+    }, 64));
+    gSink = gSink + block[0] + batch[0];
+
+    // Host engines, without countermeasures, so they are only measured once *********
+    #if !defined(MASKING) && !defined(SHUFFLING) && !defined(DUMMY_OPS)
+    TTableAES tTable;
+    results.push_back(measure("TTableAES::setKey", "key", [&]()
+    {
+        tTable.setKey(key);
+    }));
+    results.push_back(measure("TTableAES::decrypt", "block", [&]()
+    {
+        tTable.decrypt(block);
+    }));
+    gSink = gSink + block[0];
+    if(AESNI::supported())
+    {
+        AESNI aesNI;
+        aesNI.setKey(key);
+        results.push_back(measure("AESNI::decrypt", "block", [&]()
+        {
+            aesNI.decrypt(block);
+        }));
+        // Independent blocks, so AESNI::PARALLEL_BLOCKS of them are in flight
+        static uint8_t blocks[64*STATE_BYTES] = {};
+        results.push_back(measure("AESNI::decryptBlocks", "block", [&]()
+        {
+            aesNI.decryptBlocks(blocks, blocks, 64);
+        }, 64));
+        gSink = gSink + block[0] + blocks[0];
+    }
+    if(VPermAES::supported())
+    {
+        VPermAES vperm;
+        vperm.setKey(key);
+        results.push_back(measure("VPermAES::decrypt", "block", [&]()
+        {
+            vperm.decrypt(block);
+        }));
+        // With AVX2, 2 blocks per register
+        static uint8_t blocks[64*STATE_BYTES] = {};
+        results.push_back(measure("VPermAES::decryptBlocks", "block", [&]()
+        {
+            vperm.decryptBlocks(blocks, blocks, 64);
+        }, 64));
+        gSink = gSink + block[0] + blocks[0];
+    }
+    // A whole batch of BitslicedAES::BATCH_BLOCKS blocks per pass
+    BitslicedAES bitsliced;
+    bitsliced.setKey(key);
+    static uint8_t bitslicedBlocks[BitslicedAES::BATCH_BLOCKS*STATE_BYTES] = {};
+    results.push_back(measure("BitslicedAES::decryptBlocks", "block", [&]()
+    {
+        bitsliced.decryptBlocks(bitslicedBlocks, bitslicedBlocks, BitslicedAES::BATCH_BLOCKS);
+    }, BitslicedAES::BATCH_BLOCKS));
+    gSink = gSink + bitslicedBlocks[0];
+    #endif
+
+    // Countermeasures ******************************************************************
+    #ifdef MASKING
+    Masking masking;
+    results.push_back(measure("Masking::init", "init", [&]()
+    {
+        masking.init();
+        gSink = gSink + masking.getInvMaskedSBoxValue(0);
+    }));
+    #endif
+    #if defined(SHUFFLING) || defined(DUMMY_OPS)
+    Hiding hiding;
+    results.push_back(measure("Hiding::init", "init", [&]()
+    {
+        hiding.init();
+    }));
+    #endif
+    #ifdef SHUFFLING
+    uint8_t indices[STATE_BYTES] = {};
+    results.push_back(measure("Hiding::shuffleSBoxAccess", "shuffle", [&]()
+    {
+        hiding.shuffleSBoxAccess(indices);
+        gSink = gSink + indices[0];
+    }));
+    #endif
+
+    // Helpers **************************************************************************
+    uint8_t x = 0x57;
+    results.push_back(measure("AESMath::ffMul", "mul", [&]()
+    {
+        x = AESMath::ffMul(x, 0x0e) ^ 0x13;
+    }));
+    gSink = gSink + x;
+
+    RNG rng;
+    rng.seed();
+    results.push_back(measure("RNG::rand", "byte", [&]()
+    {
+        gSink = gSink + rng.rand();
+    }));
+
+    // Output ***************************************************************************
+    printf("{\"variant\": \"%s\", \"defines\": [", VARIANT);
+    const char *separator = "";
+    #ifdef MASKING
+    printf("%s\"MASKING\"", separator);
+    separator = ", ";
+    #endif
+    #ifdef SHUFFLING
+    printf("%s\"SHUFFLING\"", separator);
+    separator = ", ";
+    #endif
+    #ifdef DUMMY_OPS
+    printf("%s\"DUMMY_OPS\"", separator);
+    #endif
+    printf("], \"benchmarks\": [\n");
+    for(size_t i=0; i<results.size(); i++)
+    {
+        const result_t &result = results[i];
+        printf("    {\"name\": \"%s\", \"unit\": \"%s\", \"ns_per_op\": %.1f, \"ops_per_s\": %.1f, \"allocations\": %ld}%s\n",
+               result.name, result.unit, result.nsPerOp, 1e9 / result.nsPerOp, result.allocations,
+               i + 1 < results.size() ? "," : "");
+    }
+    printf("]}\n");
+    return 0;
+}
@@ -0,0 +1,13 @@
+# Run the benchmarks given in BENCHMARKS (separated by |) & write their JSON objects as an array to OUTPUT
+string(REPLACE "|" ";" BENCHMARKS "${BENCHMARKS}")
+set(results)
+foreach(benchmark ${BENCHMARKS})
+    execute_process(COMMAND "${benchmark}" OUTPUT_VARIABLE result RESULT_VARIABLE status OUTPUT_STRIP_TRAILING_WHITESPACE)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "${benchmark} failed.")
+    endif()
+    list(APPEND results "${result}")
+endforeach()
+string(REPLACE ";" ",\n" results "${results}")
+file(WRITE "${OUTPUT}" "[\n${results}\n]\n")
+message(STATUS "Results written to ${OUTPUT}")
@@ -0,0 +1,294 @@
+/**
+ * @file engineCheck.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Cross-check the host AES engines against the firmware's AES.
+ *
+ * Usage: `engineCheck [keys] [blocks]`
+ *
+ * Each engine has to decrypt the FIPS-197 example vector (appendix C.1) & `blocks` (default 256) random blocks
+ * under each of `keys` (default 64) random keys exactly like AES::decrypt(). The key is set both from the master key
+ * (setKey()) & from the KeyStore (selectKey()). Engines with decryptBlocks() have to decrypt runs of 1 to 130 blocks
+ * exactly like decrypt(), in place & out of place, & so does AES::decryptBlocks() like AES::decrypt().
+ * The KeyStore has to return the complete key schedule of a slot from EEPROM after the key is committed.
+ * The tool prints the first mismatch & fails, if any engine differs.
+ * The random inputs are seeded with a constant, so a failure can be reproduced.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "aes.h"
+#include "keyStore.h"
+#include "host/hostAES.h"
+
+namespace
+{
+    const aes_key_t FIPS_KEY        = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    const uint8_t FIPS_CIPHER[]     = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+    const uint8_t FIPS_PLAIN[]      = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+    /**
+     * @brief Load @p key into slot 0 & wait until it is written to the (emulated) EEPROM.
+     * @param[in] key (const @ref aes_key_t): The key.
+     */
+    void loadKey(const aes_key_t key)
+    {
+        KeyStore::load(0, key);
+        while(KeyStore::loadStep(nullptr));
+    }
+
+    /**
+     * @brief Print a block.
+     * @param[in] name (const char*): Name of the block.
+     * @param[in] block (const uint8_t*): The 16 bytes of the block.
+     */
+    void printBlock(const char *name, const uint8_t *block)
+    {
+        fprintf(stderr, "  %-10s", name);
+        for(uint8_t i=0; i<STATE_BYTES; i++) fprintf(stderr, "%02x", block[i]);
+        fprintf(stderr, "\n");
+    }
+
+    /**
+     * @brief Check an engine against AES::decrypt().
+     * @param[in] name (const char*): Name of the engine.
+     * @param[in] prototype (const Engine&): An engine without a key, that is copied for each key.
+     * @param[in] keys (const int): Number of random keys.
+     * @param[in] blocks (const int): Number of random blocks per key.
+     * @return (bool): Whether the engine decrypted all blocks correctly.
+     */
+    template<typename Engine>
+    bool check(const char *name, const Engine &prototype, const int keys, const int blocks)
+    {
+        // FIPS-197 example vector
+        Engine engine = prototype;
+        engine.setKey(FIPS_KEY);
+        uint8_t block[STATE_BYTES];
+        memcpy(block, FIPS_CIPHER, STATE_BYTES);
+        engine.decrypt(block);
+        if(memcmp(block, FIPS_PLAIN, STATE_BYTES) != 0)
+        {
+            fprintf(stderr, "%s: FIPS-197 example vector failed.\n", name);
+            printBlock("expected", FIPS_PLAIN);
+            printBlock("got", block);
+            return false;
+        }
+
+        // Random keys & blocks
+        std::mt19937 random(0x5eed);
+        AES aes;
+        for(int k=0; k<keys; k++)
+        {
+            aes_key_t key;
+            for(uint8_t i=0; i<KEY_BYTES; i++) key[i] = static_cast<uint8_t>(random());
+            loadKey(key);
+            aes.selectKey(0);
+            Engine fromKey = prototype;
+            fromKey.setKey(key);
+            Engine fromSlot = prototype;
+            if(!fromSlot.selectKey(0))
+            {
+                fprintf(stderr, "%s: Selecting slot 0 failed.\n", name);
+                return false;
+            }
+
+            for(int b=0; b<blocks; b++)
+            {
+                uint8_t cipher[STATE_BYTES];
+                for(uint8_t i=0; i<STATE_BYTES; i++) cipher[i] = static_cast<uint8_t>(random());
+                uint8_t expected[STATE_BYTES];
+                uint8_t plainFromKey[STATE_BYTES];
+                uint8_t plainFromSlot[STATE_BYTES];
+                memcpy(expected, cipher, STATE_BYTES);
+                memcpy(plainFromKey, cipher, STATE_BYTES);
+                memcpy(plainFromSlot, cipher, STATE_BYTES);
+                aes.decrypt(expected);
+                fromKey.decrypt(plainFromKey);
+                fromSlot.decrypt(plainFromSlot);
+                if(memcmp(expected, plainFromKey, STATE_BYTES) != 0 || memcmp(expected, plainFromSlot, STATE_BYTES) != 0)
+                {
+                    fprintf(stderr, "%s: Mismatch for key %d, block %d.\n", name, k, b);
+                    printBlock("key", key);
+                    printBlock("cipher", cipher);
+                    printBlock("expected", expected);
+                    printBlock("setKey", plainFromKey);
+                    printBlock("selectKey", plainFromSlot);
+                    return false;
+                }
+            }
+        }
+        printf("%-20s ok (%d keys x %d blocks)\n", name, keys, blocks);
+        return true;
+    }
+
+    /**
+     * @brief Check the decryptBlocks() of an engine against its decrypt().
+     * @param[in] name (const char*): Name of the engine.
+     * @param[in] prototype (const Engine&): An engine without a key.
+     * @return (bool): Whether all runs of blocks were decrypted correctly.
+     */
+    template<typename Engine>
+    bool checkBlocks(const char *name, const Engine &prototype)
+    {
+        constexpr size_t MAX_BLOCKS = 130;
+        std::mt19937 random(0xb10c);
+        Engine engine = prototype;
+        aes_key_t key;
+        for(uint8_t i=0; i<KEY_BYTES; i++) key[i] = static_cast<uint8_t>(random());
+        engine.setKey(key);
+
+        uint8_t cipher[MAX_BLOCKS*STATE_BYTES];
+        uint8_t expected[MAX_BLOCKS*STATE_BYTES];
+        uint8_t outOfPlace[MAX_BLOCKS*STATE_BYTES];
+        uint8_t inPlace[MAX_BLOCKS*STATE_BYTES];
+        for(size_t nBlocks=1; nBlocks<=MAX_BLOCKS; nBlocks++)
+        {
+            for(size_t i=0; i<nBlocks*STATE_BYTES; i++) cipher[i] = static_cast<uint8_t>(random());
+            memcpy(expected, cipher, nBlocks*STATE_BYTES);
+            for(size_t block=0; block<nBlocks; block++) engine.decrypt(&expected[block*STATE_BYTES]);
+            engine.decryptBlocks(cipher, outOfPlace, nBlocks);
+            memcpy(inPlace, cipher, nBlocks*STATE_BYTES);
+            engine.decryptBlocks(inPlace, inPlace, nBlocks);
+            if(memcmp(expected, outOfPlace, nBlocks*STATE_BYTES) != 0 || memcmp(expected, inPlace, nBlocks*STATE_BYTES) != 0)
+            {
+                fprintf(stderr, "%s: decryptBlocks() differs from decrypt() for %zu blocks.\n", name, nBlocks);
+                return false;
+            }
+        }
+        printf("%-20s ok (decryptBlocks() of 1 to %zu blocks)\n", name, MAX_BLOCKS);
+        return true;
+    }
+
+    /**
+     * @brief Check, that a slot is read from EEPROM after its key is committed & that the other slots are unchanged.
+     * @return (bool): Whether all key schedules were read correctly.
+     */
+    bool checkKeyStore()
+    {
+        constexpr uint8_t SLOT = KeyStore::NUM_SLOTS - 1;
+        std::mt19937 random(0x5107);
+        sub_keys_t before;
+        if(!KeyStore::read(0, before))
+        {
+            fprintf(stderr, "KeyStore: Slot 0 is not valid.\n");
+            return false;
+        }
+        for(int k=0; k<4; k++)
+        {
+            sub_keys_t expected;
+            for(uint8_t i=0; i<KEY_BYTES; i++) expected[0][i] = static_cast<uint8_t>(random());
+            for(uint8_t i=1; i<=ROUNDS; i++) AES::createRoundKey(expected, i);
+            KeyStore::load(SLOT, expected[0]);
+            while(KeyStore::loadStep(nullptr));
+
+            sub_keys_t subKeys;
+            if(!KeyStore::read(SLOT, subKeys) || memcmp(subKeys, expected, sizeof(sub_keys_t)) != 0)
+            {
+                fprintf(stderr, "KeyStore: Slot %u differs from the key schedule after the commit of key %d.\n", SLOT, k);
+                return false;
+            }
+            AES aes;
+            uint8_t block[STATE_BYTES] = {};
+            uint8_t reference[STATE_BYTES] = {};
+            TTableAES engine;
+            engine.setKey(expected[0]);
+            if(!aes.selectKey(SLOT))
+            {
+                fprintf(stderr, "KeyStore: Selecting slot %u failed after the commit of key %d.\n", SLOT, k);
+                return false;
+            }
+            aes.decrypt(block);
+            engine.decrypt(reference);
+            if(memcmp(block, reference, STATE_BYTES) != 0)
+            {
+                fprintf(stderr, "KeyStore: Slot %u decrypts with a wrong key after the commit of key %d.\n", SLOT, k);
+                return false;
+            }
+            if(!KeyStore::read(0, subKeys) || memcmp(subKeys, before, sizeof(sub_keys_t)) != 0)
+            {
+                fprintf(stderr, "KeyStore: Slot 0 changed with the commit of key %d.\n", k);
+                return false;
+            }
+        }
+        printf("%-20s ok (key schedule from EEPROM after the commit)\n", "KeyStore");
+        return true;
+    }
+
+    /**
+     * @brief Check AES::decryptBlocks() against AES::decrypt(), like checkBlocks() for the engines.
+     * @return (bool): Whether all runs of blocks were decrypted correctly.
+     */
+    bool checkAESBlocks()
+    {
+        constexpr size_t MAX_BLOCKS = 130;
+        std::mt19937 random(0xae5);
+        aes_key_t key;
+        for(uint8_t i=0; i<KEY_BYTES; i++) key[i] = static_cast<uint8_t>(random());
+        loadKey(key);
+        AES aes;
+        aes.selectKey(0);
+
+        uint8_t cipher[MAX_BLOCKS*STATE_BYTES];
+        uint8_t expected[MAX_BLOCKS*STATE_BYTES];
+        uint8_t outOfPlace[MAX_BLOCKS*STATE_BYTES];
+        uint8_t inPlace[MAX_BLOCKS*STATE_BYTES];
+        for(size_t nBlocks=1; nBlocks<=MAX_BLOCKS; nBlocks++)
+        {
+            for(size_t i=0; i<nBlocks*STATE_BYTES; i++) cipher[i] = static_cast<uint8_t>(random());
+            memcpy(expected, cipher, nBlocks*STATE_BYTES);
+            for(size_t block=0; block<nBlocks; block++) aes.decrypt(&expected[block*STATE_BYTES]);
+            aes.decryptBlocks(cipher, outOfPlace, nBlocks);
+            memcpy(inPlace, cipher, nBlocks*STATE_BYTES);
+            aes.decryptBlocks(inPlace, inPlace, nBlocks);
+            if(memcmp(expected, outOfPlace, nBlocks*STATE_BYTES) != 0 || memcmp(expected, inPlace, nBlocks*STATE_BYTES) != 0)
+            {
+                fprintf(stderr, "AES: decryptBlocks() differs from decrypt() for %zu blocks.\n", nBlocks);
+                return false;
+            }
+        }
+        printf("%-20s ok (decryptBlocks() of 1 to %zu blocks)\n", "AES", MAX_BLOCKS);
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int keys = argc > 1 ? atoi(argv[1]) : 64;
+    const int blocks = argc > 2 ? atoi(argv[2]) : 256;
+
+    const aes_key_t initialKey = {};
+    KeyStore::init(initialKey);
+    while(KeyStore::loadStep(nullptr));
+
+    bool ok = checkKeyStore();
+    ok &= checkAESBlocks();
+    ok &= check("TTableAES", TTableAES(), keys, blocks);
+    if(AESNI::supported())
+    {
+        ok &= check("AESNI", AESNI(), keys, blocks);
+        ok &= checkBlocks("AESNI", AESNI());
+    }
+    else
+        printf("%-20s skipped, the CPU doesn't support AES-NI\n", "AESNI");
+    if(VPermAES::supported())
+    {
+        ok &= check("VPermAES", VPermAES(), keys, blocks);
+        ok &= checkBlocks("VPermAES", VPermAES());
+    }
+    else
+        printf("%-20s skipped, the CPU doesn't support SSSE3\n", "VPermAES");
+    ok &= check("BitslicedAES", BitslicedAES(), keys, blocks);
+    ok &= checkBlocks("BitslicedAES", BitslicedAES());
+    ok &= checkBlocks("HostAES(TTableAES)", HostAES(HostAES::Engine::T_TABLE));
+    const HostAES best;
+    ok &= check("HostAES", best, keys, blocks);
+    ok &= checkBlocks("HostAES", best);
+    printf("HostAES uses %s.\n", HostAES::name(best.engine()));
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file aesVariant.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Serve the firmware's AES of one countermeasure combination to the conformance harness.
+ *
+ * Usage: `aesVariant_<variant> -f fd`
+ *
+ * The countermeasures are compile-time options & the firmware's state (KeyStore, emulated hardware) is global, so
+ * every variant runs in its own process. It answers the requests of variantMessage.h on the inherited socket @p fd,
+ * until the socket is closed. The key of each request is loaded into slot 0 of the KeyStore, like the card does
+ * for LOAD KEY, & the blocks are decrypted with AES::decryptBlocks() in runs of #RUN_BLOCKS, so the countermeasures
+ * are initialized once per run instead of once per block, but still get new randomness every few blocks.
+ * The firmware is built with LEAKAGE, so the rounds of a single block can be dumped through Leakage::onRound.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "aes.h"
+#include "keyStore.h"
+#include "leakage.h"
+#include "variantMessage.h"
+
+namespace
+{
+    constexpr size_t RUN_BLOCKS = 64;   ///< Blocks per call of AES::decryptBlocks(), i.e. per initialization of the countermeasures
+    RoundDump gDump;                    ///< Dump of the current DUMP request, the Leakage hooks have no context
+
+    /**
+     * @brief Leakage::onRound hook, copy the state in the byte order of the blocks.
+     */
+    void recordRound(const uint8_t round, const state_t state)
+    {
+        for(uint8_t col=0; col<WORD_BYTES; col++)
+            for(uint8_t row=0; row<WORD_BYTES; row++)
+                gDump.rounds[ROUNDS - round][col*WORD_BYTES + row] = state[row][col];
+    }
+
+    /**
+     * @brief Read exactly @p size bytes.
+     * @return (bool): Whether all bytes were read, false at the end of the stream.
+     */
+    bool readAll(const int fd, void *data, size_t size)
+    {
+        uint8_t *bytes = static_cast<uint8_t*>(data);
+        while(size > 0)
+        {
+            const ssize_t n = read(fd, bytes, size);
+            if(n <= 0) return false;
+            bytes += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Write exactly @p size bytes to the socket.
+     * @return (bool): Whether all bytes were written, false without SIGPIPE if the harness closed the socket.
+     */
+    bool writeAll(const int fd, const void *data, size_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t*>(data);
+        while(size > 0)
+        {
+            const ssize_t n = send(fd, bytes, size, MSG_NOSIGNAL);
+            if(n <= 0) return false;
+            bytes += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 3 || strcmp(argv[1], "-f") != 0)
+    {
+        fprintf(stderr, "Usage: %s -f fd\n", argv[0]);
+        return 2;
+    }
+    const int fd = atoi(argv[2]);
+
+    VariantRequest request;
+    std::vector<uint8_t> blocks;
+    aes_key_t key = {};
+    bool loaded = false;
+    while(readAll(fd, &request, sizeof(request)))
+    {
+        if(request.blocks > VariantRequest::MAX_BLOCKS || (request.type == VariantRequest::DUMP && request.blocks != 1))
+        {
+            fprintf(stderr, "%s: Invalid request.\n", argv[0]);
+            return 1;
+        }
+        blocks.resize(static_cast<size_t>(request.blocks) * STATE_BYTES);
+        if(!readAll(fd, blocks.data(), blocks.size())) return 1;
+
+        // LOAD KEY, only if the key changed
+        if(!loaded || memcmp(key, request.key, KEY_BYTES) != 0)
+        {
+            memcpy(key, request.key, KEY_BYTES);
+            KeyStore::load(0, key);
+            while(KeyStore::loadStep(nullptr));
+            loaded = true;
+        }
+        AES aes;
+        aes.selectKey(0);
+
+        bool written = false;
+        if(request.type == VariantRequest::DUMP)
+        {
+            Leakage::onRound = recordRound;
+            aes.decrypt(blocks.data());
+            Leakage::onRound = nullptr;
+            memcpy(gDump.output, blocks.data(), STATE_BYTES);
+            written = writeAll(fd, &gDump, sizeof(gDump));
+        }
+        else
+        {
+            for(size_t block=0; block<request.blocks; block+=RUN_BLOCKS)
+            {
+                uint8_t *run = &blocks[block * STATE_BYTES];
+                aes.decryptBlocks(run, run, std::min<size_t>(RUN_BLOCKS, request.blocks - block));
+            }
+            written = writeAll(fd, blocks.data(), blocks.size());
+        }
+        if(!written) return 1;
+    }
+    return 0;
+}
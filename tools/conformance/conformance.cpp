@@ -0,0 +1,621 @@
+/**
+ * @file conformance.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Check, that every variant of the firmware's AES & every host engine decrypts exactly like the plain AES::decrypt().
+ *
+ * Usage: `conformance [-n blocks] [-b blocksPerKey] [-r seed] [-v variants] [-j processes] [-x directory]`
+ *
+ * The implementations under test are the firmware's AES of every combination of the countermeasures (`-v`, a
+ * comma-separated list, by default all 8), each in `-j` `aesVariant_<variant>` processes (see variantMessage.h),
+ * & the engines of HostAES, that the CPU supports, each in its own thread of the harness. The reference is the
+ * `plain` variant, which always runs. The processes of a variant decrypt consecutive parts of each batch, by default
+ * there are as many processes per variant, that all cores are used.
+ *
+ * -# All implementations have to decrypt the FIPS-197 examples (appendix B & C.1).
+ * -# `-n` random blocks (default 1048576) are decrypted by all implementations in batches of `-b` blocks
+ *    (default 4096) under a random key each. Every process & engine thread decrypts a batch in parallel, while the
+ *    harness creates the next batch. The results are compared with the reference, before the next batch is sent.
+ *
+ * The keys & blocks of batch i are derived from the seed (`-r`, default 1) & i only, so a failure can be reproduced.
+ * At the first divergence, the harness prints the key, the block & both plaintexts, & dumps the state after the
+ * AddRoundKey of each round for the reference & the diverging variant. A masked state matches, if it only differs by
+ * the masks, i.e. by one constant per row of the state, so the first diverging round is found in all variants.
+ * The host engines have no dumps, so only the rounds of the reference are printed for them.
+ * The exit code is 1, if any implementation diverges or a variant can't be executed or fails, which is reported
+ * with the name of the variant & its exit status.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "aes.h"
+#include "variantMessage.h"
+#include "host/hostAES.h"
+
+namespace
+{
+    /// The firmware variants, the first one is the reference
+    const char *const VARIANTS[] = {"plain", "masking", "shuffling", "dummyops", "masking_shuffling", "masking_dummyops",
+                                    "shuffling_dummyops", "masking_shuffling_dummyops"};
+    /// The engines of HostAES
+    const HostAES::Engine ENGINES[] = {HostAES::Engine::T_TABLE, HostAES::Engine::AES_NI, HostAES::Engine::VPERM, HostAES::Engine::BITSLICED};
+
+    /**
+     * @brief A known-answer test of FIPS-197.
+     */
+    struct Vector
+    {
+        const char *name;                   ///< Appendix of the example
+        uint8_t key[KEY_BYTES];             ///< The key
+        uint8_t cipher[STATE_BYTES];        ///< The ciphertext
+        uint8_t plain[STATE_BYTES];         ///< The plaintext
+    };
+
+    const Vector FIPS_VECTORS[] =
+    {
+        {"appendix B",
+         {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c},
+         {0x39, 0x25, 0x84, 0x1d, 0x02, 0xdc, 0x09, 0xfb, 0xdc, 0x11, 0x85, 0x97, 0x19, 0x6a, 0x0b, 0x32},
+         {0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34}},
+        {"appendix C.1",
+         {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f},
+         {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a},
+         {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff}}
+    };
+
+    /**
+     * @brief A batch of blocks under one key.
+     */
+    struct Batch
+    {
+        aes_key_t key;                      ///< The key
+        std::vector<uint8_t> cipher;        ///< The ciphertexts
+    };
+
+    /**
+     * @brief Read exactly @p size bytes.
+     * @return (bool): Whether all bytes were read.
+     */
+    bool readAll(const int fd, void *data, size_t size)
+    {
+        uint8_t *bytes = static_cast<uint8_t*>(data);
+        while(size > 0)
+        {
+            const ssize_t n = read(fd, bytes, size);
+            if(n <= 0) return false;
+            bytes += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Write exactly @p size bytes to a socket.
+     *
+     * A closed socket fails the write instead of raising SIGPIPE, so the harness can report the variant.
+     * @return (bool): Whether all bytes were written.
+     */
+    bool writeAll(const int fd, const void *data, size_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t*>(data);
+        while(size > 0)
+        {
+            const ssize_t n = send(fd, bytes, size, MSG_NOSIGNAL);
+            if(n <= 0) return false;
+            bytes += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief An implementation under test, the processes of a firmware variant or a host engine.
+     */
+    class Implementation
+    {
+    public:
+        /**
+         * @brief Construct a host engine.
+         * @param[in] engine (const HostAES::Engine): The engine.
+         */
+        explicit Implementation(const HostAES::Engine engine) : mName(HostAES::name(engine)), mEngine(engine) {}
+
+        /**
+         * @brief Construct a firmware variant, that is started by start().
+         * @param[in] variant (const std::string&): The variant.
+         */
+        explicit Implementation(const std::string &variant) : mName(variant), mFirmware(true) {}
+
+        Implementation(const Implementation&) = delete;
+        Implementation &operator=(const Implementation&) = delete;
+
+        /**
+         * @brief Stop the processes of a firmware variant or wait for the thread of a host engine.
+         */
+        ~Implementation()
+        {
+            if(mThread.joinable()) mThread.join();
+            for(const Process &process : mProcesses)
+            {
+                if(process.fd >= 0) close(process.fd);
+                if(process.pid > 0) waitpid(process.pid, nullptr, 0);
+            }
+        }
+
+        const std::string &name() const { return mName; }
+        bool firmware() const { return mFirmware; }
+        const std::vector<uint8_t> &plain() const { return mPlain; }
+
+        /**
+         * @brief Start the processes of a firmware variant.
+         *
+         * A child reports a failed exec through a pipe, that is closed by a successful exec (O_CLOEXEC).
+         * @param[in] directory (const std::string&): Directory of the aesVariant executables.
+         * @param[in] processes (const unsigned): Number of processes, each decrypts a part of every batch.
+         * @return (bool): Whether the processes were started & run the executable of the variant.
+         */
+        bool start(const std::string &directory, const unsigned processes)
+        {
+            if(!mFirmware) return true;
+            const std::string path = directory + "/aesVariant_" + mName;
+            for(unsigned i=0; i<processes; i++)
+            {
+                int fds[2];
+                int status[2];
+                if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+                {
+                    perror("socketpair");
+                    return false;
+                }
+                if(pipe2(status, O_CLOEXEC) != 0)
+                {
+                    perror("pipe2");
+                    close(fds[0]);
+                    close(fds[1]);
+                    return false;
+                }
+                const pid_t pid = fork();
+                if(pid == 0)
+                {
+                    // The duplicate is inherited, the other sockets of the harness are not
+                    const std::string fd = std::to_string(dup(fds[1]));
+                    execl(path.c_str(), path.c_str(), "-f", fd.c_str(), static_cast<char*>(nullptr));
+                    const int error = errno;
+                    if(write(status[1], &error, sizeof(error)) != sizeof(error)) _exit(126);
+                    _exit(127);
+                }
+                close(fds[1]);
+                close(status[1]);
+                if(pid < 0)
+                {
+                    perror("fork");
+                    close(fds[0]);
+                    close(status[0]);
+                    return false;
+                }
+                mProcesses.push_back(Process{pid, fds[0]});
+                int error = 0;
+                const bool failed = read(status[0], &error, sizeof(error)) == sizeof(error);
+                close(status[0]);
+                if(failed)
+                {
+                    fprintf(stderr, "%s: Can't execute %s: %s\n", mName.c_str(), path.c_str(), strerror(error));
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Send a batch to the processes of a firmware variant, or start decrypting it in a thread of the host engine.
+         *
+         * The processes get consecutive parts of the batch & decrypt them in the background until receive() is called.
+         * @param[in] batch (const Batch&): The batch, it has to be kept until receive().
+         * @return (bool): Whether the batch was sent.
+         */
+        bool send(const Batch &batch)
+        {
+            mPending.resize(batch.cipher.size());
+            if(!mFirmware)
+            {
+                mThread = std::thread([this, &batch]()
+                {
+                    HostAES aes(mEngine);
+                    aes.setKey(batch.key);
+                    aes.decryptBlocks(batch.cipher.data(), mPending.data(), batch.cipher.size() / STATE_BYTES);
+                });
+                return true;
+            }
+            const size_t blocks = batch.cipher.size() / STATE_BYTES;
+            const size_t partBlocks = (blocks + mProcesses.size() - 1) / mProcesses.size();
+            size_t offset = 0;
+            for(Process &process : mProcesses)
+            {
+                process.bytes = std::min(partBlocks * STATE_BYTES, batch.cipher.size() - offset);
+                if(process.bytes == 0) continue;
+                VariantRequest request = {};
+                request.type = VariantRequest::DECRYPT;
+                request.blocks = static_cast<uint32_t>(process.bytes / STATE_BYTES);
+                memcpy(request.key, batch.key, KEY_BYTES);
+                if(!writeAll(process.fd, &request, sizeof(request)) || !writeAll(process.fd, &batch.cipher[offset], process.bytes))
+                    return failed(process, "sending a batch");
+                offset += process.bytes;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Wait for the plaintexts of the batch from the processes of a firmware variant or the thread of the host engine.
+         * @return (bool): Whether the plaintexts were received.
+         */
+        bool receive()
+        {
+            if(!mFirmware)
+            {
+                mThread.join();
+                mPlain.swap(mPending);
+                return true;
+            }
+            size_t offset = 0;
+            for(Process &process : mProcesses)
+            {
+                if(!readAll(process.fd, &mPending[offset], process.bytes)) return failed(process, "receiving the plaintexts");
+                offset += process.bytes;
+            }
+            mPlain.swap(mPending);
+            return true;
+        }
+
+        /**
+         * @brief Dump the rounds of a block, only firmware variants can be dumped.
+         * @param[in] key (const @ref aes_key_t): The key.
+         * @param[in] cipher (const uint8_t*): The ciphertext.
+         * @param[out] dump (RoundDump&): The dump.
+         * @return (bool): Whether the block was dumped.
+         */
+        bool dump(const aes_key_t key, const uint8_t *cipher, RoundDump &dump)
+        {
+            if(!mFirmware) return false;
+            Process &process = mProcesses.front();
+            VariantRequest request = {};
+            request.type = VariantRequest::DUMP;
+            request.blocks = 1;
+            memcpy(request.key, key, KEY_BYTES);
+            if(writeAll(process.fd, &request, sizeof(request)) && writeAll(process.fd, cipher, STATE_BYTES)
+               && readAll(process.fd, &dump, sizeof(dump)))
+                return true;
+            return failed(process, "dumping the rounds");
+        }
+
+    private:
+        /**
+         * @brief A process of a firmware variant.
+         */
+        struct Process
+        {
+            pid_t pid;                  ///< The process
+            int fd;                     ///< Socket of the process
+            size_t bytes;               ///< Bytes of the current batch, that were sent to the process
+        };
+
+        /**
+         * @brief Report a failed exchange with a process of the variant & how the process ended.
+         * @param[inout] process (Process&): The process.
+         * @param[in] what (const char*): The exchange.
+         * @return (bool): false.
+         */
+        bool failed(Process &process, const char *what)
+        {
+            close(process.fd);
+            process.fd = -1;
+            int status = 0;
+            const bool ended = waitpid(process.pid, &status, 0) == process.pid;
+            process.pid = -1;
+            if(ended && WIFEXITED(status))
+                fprintf(stderr, "%s: The variant failed while %s, it exited with %d.\n", mName.c_str(), what, WEXITSTATUS(status));
+            else if(ended && WIFSIGNALED(status))
+                fprintf(stderr, "%s: The variant failed while %s, it was killed by signal %d (%s).\n", mName.c_str(), what,
+                        WTERMSIG(status), strsignal(WTERMSIG(status)));
+            else
+                fprintf(stderr, "%s: The variant failed while %s.\n", mName.c_str(), what);
+            return false;
+        }
+
+        const std::string mName;                            ///< Name of the variant or the engine
+        const bool mFirmware = false;                       ///< Whether it is a firmware variant
+        const HostAES::Engine mEngine = HostAES::Engine::T_TABLE;   ///< The host engine
+        std::vector<Process> mProcesses;                    ///< Processes of the firmware variant
+        std::thread mThread;                                ///< Thread of the host engine, while it decrypts a batch
+        std::vector<uint8_t> mPlain;                        ///< Plaintexts of the last received batch
+        std::vector<uint8_t> mPending;                      ///< Plaintexts of the batch, that is decrypted in the background
+    };
+
+    /**
+     * @brief Start decrypting a batch with all implementations in parallel: The processes of the variants decrypt,
+     *        while the host engines decrypt in threads of the harness.
+     * @param[inout] implementations (std::vector<Implementation*>&): The implementations.
+     * @param[in] batch (const Batch&): The batch, it has to be kept until receive().
+     * @return (bool): Whether the batch was sent to all implementations.
+     */
+    bool send(std::vector<Implementation*> &implementations, const Batch &batch)
+    {
+        bool ok = true;
+        for(Implementation *implementation : implementations)
+            ok = implementation->send(batch) && ok;
+        return ok;
+    }
+
+    /**
+     * @brief Wait for the plaintexts of the batch of all implementations.
+     * @param[inout] implementations (std::vector<Implementation*>&): The implementations.
+     * @return (bool): Whether all implementations decrypted the batch.
+     */
+    bool receive(std::vector<Implementation*> &implementations)
+    {
+        bool ok = true;
+        for(Implementation *implementation : implementations)
+            ok = implementation->receive() && ok;
+        return ok;
+    }
+
+    /**
+     * @brief Create the random key & blocks of a batch.
+     * @param[in] seed (const uint32_t): The seed of the run.
+     * @param[in] index (const uint64_t): Index of the batch.
+     * @param[in] blocks (const size_t): Number of blocks.
+     * @param[out] batch (Batch&): The batch.
+     */
+    void createBatch(const uint32_t seed, const uint64_t index, const size_t blocks, Batch &batch)
+    {
+        std::seed_seq sequence{seed, static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32)};
+        std::mt19937 random(sequence);
+        for(uint8_t i=0; i<KEY_BYTES; i++) batch.key[i] = static_cast<uint8_t>(random());
+        batch.cipher.resize(blocks * STATE_BYTES);
+        for(uint8_t &byte : batch.cipher) byte = static_cast<uint8_t>(random());
+    }
+
+    /**
+     * @brief Print a block.
+     * @param[in] name (const char*): Name of the block.
+     * @param[in] block (const uint8_t*): The 16 bytes of the block.
+     */
+    void printBlock(const char *name, const uint8_t *block)
+    {
+        printf("  %-10s", name);
+        for(uint8_t i=0; i<STATE_BYTES; i++) printf("%02x", block[i]);
+        printf("\n");
+    }
+
+    /**
+     * @brief Check, whether a state of a variant matches the state of the reference, up to the masks of a row.
+     * @param[in] reference (const uint8_t*): The state of the reference, in the byte order of the blocks.
+     * @param[in] state (const uint8_t*): The state of the variant.
+     * @param[in] masked (const bool): Whether the variant masks its states.
+     * @return (const char*): "same", "masked" or "DIFFERS".
+     */
+    const char *compareRound(const uint8_t *reference, const uint8_t *state, const bool masked)
+    {
+        if(memcmp(reference, state, STATE_BYTES) == 0) return "same";
+        if(!masked) return "DIFFERS";
+        // Byte i of a block is in row i % 4 of the state, each row has its own mask
+        for(uint8_t i=WORD_BYTES; i<STATE_BYTES; i++)
+            if((reference[i] ^ state[i]) != (reference[i % WORD_BYTES] ^ state[i % WORD_BYTES])) return "DIFFERS";
+        return "masked";
+    }
+
+    /**
+     * @brief Print the first divergence of an implementation with the dumps of its rounds.
+     * @param[inout] reference (Implementation&): The reference.
+     * @param[inout] implementation (Implementation&): The diverging implementation.
+     * @param[in] test (const char*): Name of the test.
+     * @param[in] key (const @ref aes_key_t): The key.
+     * @param[in] cipher (const uint8_t*): The ciphertext.
+     * @param[in] expected (const uint8_t*): The plaintext of the reference.
+     * @param[in] actual (const uint8_t*): The plaintext of the implementation.
+     */
+    void printDivergence(Implementation &reference, Implementation &implementation, const char *test, const aes_key_t key,
+                         const uint8_t *cipher, const uint8_t *expected, const uint8_t *actual)
+    {
+        printf("\n%s diverges in %s:\n", implementation.name().c_str(), test);
+        printBlock("key", key);
+        printBlock("cipher", cipher);
+        printBlock("expected", expected);
+        printBlock("got", actual);
+
+        RoundDump referenceDump;
+        RoundDump dump;
+        if(!reference.dump(key, cipher, referenceDump)) return;
+        const bool dumped = (&reference != &implementation) && implementation.dump(key, cipher, dump);
+        const bool masked = implementation.name().find("masking") != std::string::npos;
+        printf("\n  Round key  %-34s%s\n", "plain", dumped ? implementation.name().c_str() : "");
+        bool diverged = false;
+        for(uint8_t round=0; round<=ROUNDS; round++)
+        {
+            printf("  %9u  ", ROUNDS - round);
+            for(uint8_t i=0; i<STATE_BYTES; i++) printf("%02x", referenceDump.rounds[round][i]);
+            if(dumped)
+            {
+                printf("  ");
+                for(uint8_t i=0; i<STATE_BYTES; i++) printf("%02x", dump.rounds[round][i]);
+                const char *result = compareRound(referenceDump.rounds[round], dump.rounds[round], masked);
+                printf("  %s%s", result, (!diverged && strcmp(result, "DIFFERS") == 0) ? " <- first divergence" : "");
+                diverged = diverged || strcmp(result, "DIFFERS") == 0;
+            }
+            printf("\n");
+        }
+    }
+
+    /**
+     * @brief Split a comma-separated list.
+     * @param[in] list (const char*): The list.
+     * @return (std::vector<std::string>): The items.
+     */
+    std::vector<std::string> split(const char *list)
+    {
+        std::vector<std::string> items;
+        std::string item;
+        for(const char *c=list; ; c++)
+        {
+            if(*c == ',' || *c == '\0')
+            {
+                if(!item.empty()) items.push_back(item);
+                item.clear();
+                if(*c == '\0') break;
+            }
+            else
+                item += *c;
+        }
+        return items;
+    }
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-n blocks] [-b blocksPerKey] [-r seed] [-v variants] [-j processes] [-x directory]\n", name);
+        return 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t blocks = 1048576;
+    uint32_t blocksPerKey = 4096;
+    uint32_t seed = 1;
+    std::vector<std::string> variants(std::begin(VARIANTS), std::end(VARIANTS));
+    std::string directory = VARIANT_DIR;
+    unsigned processes = 0;
+    int option = 0;
+    while((option = getopt(argc, argv, "n:b:r:v:j:x:")) != -1)
+    {
+        switch(option)
+        {
+            case 'n': blocks = strtoull(optarg, nullptr, 0); break;
+            case 'b': blocksPerKey = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)); break;
+            case 'r': seed = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)); break;
+            case 'v': variants = split(optarg); break;
+            case 'j': processes = static_cast<unsigned>(strtoul(optarg, nullptr, 0)); break;
+            case 'x': directory = optarg; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind != argc || blocksPerKey < 1 || blocksPerKey > VariantRequest::MAX_BLOCKS) return usage(argv[0]);
+
+    // Implementations ******************************************************************
+    // The reference runs in any case & comes first
+    variants.erase(std::remove(variants.begin(), variants.end(), VARIANTS[0]), variants.end());
+    variants.insert(variants.begin(), VARIANTS[0]);
+    std::vector<std::unique_ptr<Implementation>> owned;
+    for(const std::string &variant : variants)
+    {
+        if(std::find(std::begin(VARIANTS), std::end(VARIANTS), variant) == std::end(VARIANTS))
+        {
+            fprintf(stderr, "There is no variant %s.\n", variant.c_str());
+            return 2;
+        }
+        owned.emplace_back(new Implementation(variant));
+    }
+    for(const HostAES::Engine engine : ENGINES)
+        if(HostAES::supported(engine)) owned.emplace_back(new Implementation(engine));
+    // By default (or -j 0) the processes of all variants use all cores, rounded up, so no core is left idle
+    if(processes == 0)
+    {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        processes = (cores + static_cast<unsigned>(variants.size()) - 1) / static_cast<unsigned>(variants.size());
+    }
+    std::vector<Implementation*> implementations;
+    for(std::unique_ptr<Implementation> &implementation : owned)
+    {
+        if(!implementation->start(directory, processes)) return 1;
+        implementations.push_back(implementation.get());
+    }
+    Implementation &reference = *implementations.front();
+
+    // FIPS-197 *************************************************************************
+    bool ok = true;
+    for(const Vector &vector : FIPS_VECTORS)
+    {
+        Batch batch;
+        memcpy(batch.key, vector.key, KEY_BYTES);
+        batch.cipher.assign(vector.cipher, vector.cipher + STATE_BYTES);
+        if(!send(implementations, batch) || !receive(implementations)) return 1;
+        for(Implementation *implementation : implementations)
+        {
+            if(memcmp(implementation->plain().data(), vector.plain, STATE_BYTES) == 0) continue;
+            const std::string test = std::string("the FIPS-197 example of ") + vector.name;
+            printDivergence(reference, *implementation, test.c_str(), vector.key, vector.cipher, vector.plain, implementation->plain().data());
+            ok = false;
+        }
+    }
+    if(!ok) return 1;
+    printf("FIPS-197:    %zu examples ok\n", sizeof(FIPS_VECTORS) / sizeof(FIPS_VECTORS[0]));
+
+    // Random keys & blocks *************************************************************
+    // The next batch is created while the implementations decrypt the current one
+    const uint64_t batches = (blocks + blocksPerKey - 1) / blocksPerKey;
+    const auto batchBlocks = [&](const uint64_t b) { return static_cast<size_t>(std::min<uint64_t>(blocksPerKey, blocks - b*blocksPerKey)); };
+    Batch buffers[2];
+    uint64_t checked = 0;
+    const auto start = std::chrono::steady_clock::now();
+    if(batches > 0)
+    {
+        createBatch(seed, 0, batchBlocks(0), buffers[0]);
+        if(!send(implementations, buffers[0])) return 1;
+    }
+    for(uint64_t b=0; b<batches && ok; b++)
+    {
+        const Batch &batch = buffers[b % 2];
+        Batch &next = buffers[(b + 1) % 2];
+        if(b + 1 < batches) createBatch(seed, b + 1, batchBlocks(b + 1), next);
+        if(!receive(implementations)) return 1;
+        checked += batch.cipher.size() / STATE_BYTES;
+
+        const std::vector<uint8_t> &expected = reference.plain();
+        for(Implementation *implementation : implementations)
+        {
+            const std::vector<uint8_t> &actual = implementation->plain();
+            const auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin());
+            if(mismatch.first == expected.end()) continue;
+            const size_t block = static_cast<size_t>(mismatch.first - expected.begin()) / STATE_BYTES;
+            const std::string test = "batch " + std::to_string(b) + ", block " + std::to_string(block) + " (seed " + std::to_string(seed) + ")";
+            printDivergence(reference, *implementation, test.c_str(), batch.key, &batch.cipher[block*STATE_BYTES],
+                            &expected[block*STATE_BYTES], &actual[block*STATE_BYTES]);
+            ok = false;
+        }
+        // The rounds of a divergence are dumped above, so the next batch is only sent afterwards
+        if(ok && b + 1 < batches && !send(implementations, next)) return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Results **************************************************************************
+    printf("Implementations: ");
+    for(const Implementation *implementation : implementations)
+        printf("%s%s", implementation->name().c_str(), implementation == implementations.back() ? "\n" : ", ");
+    printf("Processes:   %u per variant\n", processes);
+    printf("Blocks:      %llu per implementation under %llu keys (seed %u)\n", static_cast<unsigned long long>(checked),
+           static_cast<unsigned long long>((checked + blocksPerKey - 1) / blocksPerKey), seed);
+    printf("Result:      %s\n", ok ? "all implementations decrypt like the reference" : "divergence");
+    printf("Time:        %.3f s\n", seconds);
+    if(seconds > 0) printf("Throughput:  %.0f blocks/min per implementation\n", checked * 60 / seconds);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file variantMessage.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Messages between the conformance harness & the processes of the firmware variants.
+ *
+ * An `aesVariant` process is connected through an inherited `SOCK_STREAM` socket:
+ * -# The harness sends a VariantRequest, followed by `blocks` ciphertexts of 16 bytes.
+ * -# For VariantRequest::DECRYPT, the process answers with the `blocks` plaintexts. For VariantRequest::DUMP, it
+ *    decrypts the single block again & answers with a RoundDump.
+ *
+ * Both sides are built by the same compiler, so the structs are sent as they are.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef VARIANT_MESSAGE_H
+#define VARIANT_MESSAGE_H
+
+#include <cstdint>
+
+/**
+ * @brief A request for a firmware variant.
+ */
+struct VariantRequest
+{
+    static constexpr uint8_t DECRYPT = 0;               ///< Decrypt the blocks with AES::decryptBlocks()
+    static constexpr uint8_t DUMP = 1;                  ///< Decrypt a single block & dump its rounds
+    static constexpr uint32_t MAX_BLOCKS = 65536;       ///< Maximum number of blocks of a request
+
+    uint8_t type;               ///< #DECRYPT or #DUMP
+    uint8_t reserved[3];        ///< 0
+    uint32_t blocks;            ///< Number of ciphertexts, that follow the request
+    uint8_t key[16];            ///< Key of the ciphertexts
+};
+
+/**
+ * @brief The states of a decryption after the AddRoundKey of each round (see Leakage::onRound), in the byte order
+ *        of the blocks. With MASKING, the states are masked.
+ */
+struct RoundDump
+{
+    uint8_t rounds[11][16];     ///< State after the AddRoundKey with the round keys 10 down to 0
+    uint8_t output[16];         ///< The plaintext
+};
+
+#endif // VARIANT_MESSAGE_H
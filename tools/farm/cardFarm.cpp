@@ -0,0 +1,470 @@
+/**
+ * @file cardFarm.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Load-test a farm of virtual cards with a work-stealing pool of Terminal threads.
+ *
+ * Usage: `cardFarm [-c cards,...] [-p profile,...] [-n blocks] [-j threads] [-r] [-s seed] [-x dir]`
+ *
+ * For each number of cards (default 1,8,64,256), the farm starts as many virtual cards, each in its own process
+ * (the firmware's state is global) & connected through a socket pair. Each card gets its own random key with LOAD KEY
+ * in slot 1 & its own countermeasure profile. Then `blocks`
+ * (default 32) random blocks are decrypted on each card with DECRYPT & GET RESPONSE & checked against HostAES.
+ *
+ * The exchanges are run by a pool of Terminal threads (default: one per core). Each thread owns a queue of cards &
+ * decrypts one block after the other on them in turn. A thread without cards steals them from the back of the queue
+ * of another thread, so slow cards (e.g. with masking) don't leave threads idle. A table with the aggregate
+ * blocks/s, the wall clock latency of the blocks (from DECRYPT to the status words of GET RESPONSE) & their time on
+ * the simulated I/O line is printed for each number of cards.
+ *
+ * - `-p` is assigned to the cards round-robin. The profiles are the countermeasure combinations of the host benchmarks, e.g. `plain` or `masking_shuffling`.
+ * - `-r` runs the cards in real time, as seen by a real Terminal. Since the threads wait for the cards,
+ *   use as many threads as cards then.
+ * - `-x` is the directory of the `virtualCard_<profile>` executables, by default the build directory.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "cardMessage.h"
+#include "keyStore.h"
+#include "protocol.h"
+#include "host/hostAES.h"
+
+namespace
+{
+    constexpr uint8_t KEY_SLOT          = 1;            ///< Slot of the cards' keys, slot 0 keeps the default key
+    constexpr double CARD_FREQUENCY     = 4800000.0;    ///< Card clock in Hz, equals F_CPU of the firmware
+    constexpr uint8_t CLA               = Protocol::DATA_IN_HEADER[Protocol::CLA_INDEX];   ///< Class byte of the card's commands
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-c cards,...] [-p profile,...] [-n blocks] [-j threads] [-r] [-s seed] [-x dir]\n", name);
+        return 2;
+    }
+
+    /**
+     * @brief Split a comma separated list.
+     * @param[in] text (const char*): The list.
+     * @return (std::vector<std::string>): The non-empty items of the list.
+     */
+    std::vector<std::string> split(const char *text)
+    {
+        std::vector<std::string> items;
+        std::string item;
+        for(const char *c=text; ; c++)
+        {
+            if(*c == ',' || *c == '\0')
+            {
+                if(!item.empty()) items.push_back(item);
+                item.clear();
+                if(*c == '\0') return items;
+            }
+            else
+                item += *c;
+        }
+    }
+
+    /**
+     * @brief Get a percentile of sorted values.
+     * @param[in] sorted (const std::vector<T>&): The values in ascending order, not empty.
+     * @param[in] percent (const size_t): The percentile, e.g. 99.
+     * @return (T): The percentile.
+     */
+    template<typename T>
+    T percentile(const std::vector<T> &sorted, const size_t percent)
+    {
+        return sorted[std::min(sorted.size() - 1, (sorted.size() * percent) / 100)];
+    }
+
+    /**
+     * @brief A virtual card & the state of its load test.
+     */
+    struct Card
+    {
+        int fd = -1;                        ///< Socket of the card's process
+        pid_t pid = -1;                     ///< The card's process
+        std::string profile;                ///< Countermeasure profile
+        HostAES aes;                        ///< Engine with the card's key, for the expected plaintexts
+        std::mt19937 random;                ///< Source of the blocks to decrypt
+        int remaining = 0;                  ///< Number of blocks left to decrypt
+        std::vector<uint64_t> latencies;    ///< Wall clock latency of each block in ns
+        std::vector<uint64_t> cycles;       ///< Time of each block on the I/O line in card cycles
+
+        /**
+         * @brief Exchange a command with the card.
+         * @param[in] header (const uint8_t*): The command header.
+         * @param[in] dataIn (const uint8_t*): P3 bytes to send to the card, nullptr if the card sends data.
+         * @param[out] response (CardResponse&): The answer of the card.
+         * @return (bool): Whether the card completed the command.
+         */
+        bool exchange(const uint8_t *header, const uint8_t *dataIn, CardResponse &response) const
+        {
+            CardCommand command;
+            memset(&command, 0, sizeof(command));
+            memcpy(command.header, header, sizeof(command.header));
+            command.dataIn = dataIn ? 1 : 0;
+            if(dataIn) memcpy(command.data, dataIn, header[Protocol::P3_INDEX]);
+            return send(fd, &command, sizeof(command), MSG_NOSIGNAL) == sizeof(command)
+                && recv(fd, &response, sizeof(response), 0) == sizeof(response) && response.completed;
+        }
+    };
+
+    /**
+     * @brief Queue of the cards of a Terminal thread, from which other threads can steal.
+     */
+    class WorkQueue
+    {
+    public:
+        /**
+         * @brief Append a card, that has blocks left.
+         * @param[in] card (Card*): The card.
+         */
+        void push(Card *card)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mCards.push_back(card);
+        }
+
+        /**
+         * @brief Take the next card of the owner, in turn.
+         * @return (Card*): The card, or nullptr if the queue is empty.
+         */
+        Card *pop()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(mCards.empty()) return nullptr;
+            Card *card = mCards.front();
+            mCards.pop_front();
+            return card;
+        }
+
+        /**
+         * @brief Steal the card, that the owner would take last.
+         * @return (Card*): The card, or nullptr if the queue is empty.
+         */
+        Card *steal()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(mCards.empty()) return nullptr;
+            Card *card = mCards.back();
+            mCards.pop_back();
+            return card;
+        }
+
+    private:
+        std::mutex mMutex;                  ///< Guards #mCards
+        std::deque<Card*> mCards;           ///< The cards, that wait for their next block
+    };
+
+    /**
+     * @brief Class that runs the load test of a number of cards.
+     */
+    class Farm
+    {
+    public:
+        /**
+         * @brief Construct a new Farm object.
+         * @param[in] directory (const std::string&): Directory of the virtualCard executables.
+         * @param[in] realTime (const bool): Whether the cards run in real time.
+         */
+        Farm(const std::string &directory, const bool realTime) : mDirectory(directory), mRealTime(realTime) {}
+
+        /**
+         * @brief Get the path of the virtualCard executable of a profile.
+         * @param[in] profile (const std::string&): The countermeasure profile.
+         * @return (std::string): The path.
+         */
+        std::string executable(const std::string &profile) const
+        {
+            return mDirectory + "/virtualCard_" + profile;
+        }
+
+        /**
+         * @brief Start a card, check its ATR & load its key.
+         * @param[inout] card (Card&): The card with its profile.
+         * @param[in] key (const @ref aes_key_t): The card's key.
+         * @return (bool): Whether the card is ready.
+         */
+        bool start(Card &card, const aes_key_t key) const
+        {
+            int fds[2];
+            if(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0)
+            {
+                perror("socketpair");
+                return false;
+            }
+            const std::string path = executable(card.profile);
+            card.pid = fork();
+            if(card.pid == 0)
+            {
+                // The duplicate is inherited, the other sockets of the farm are not
+                const std::string fd = std::to_string(dup(fds[1]));
+                if(mRealTime)
+                    execl(path.c_str(), path.c_str(), "-r", "-f", fd.c_str(), static_cast<char*>(nullptr));
+                else
+                    execl(path.c_str(), path.c_str(), "-f", fd.c_str(), static_cast<char*>(nullptr));
+                _exit(127);
+            }
+            close(fds[1]);
+            card.fd = fds[0];
+            if(card.pid < 0)
+            {
+                perror("fork");
+                return false;
+            }
+
+            // ATR
+            CardResponse response;
+            if(recv(card.fd, &response, sizeof(response), 0) != sizeof(response) || !response.completed)
+            {
+                fprintf(stderr, "%s sent no ATR.\n", path.c_str());
+                return false;
+            }
+
+            // LOAD KEY
+            const uint8_t header[] = {CLA, Protocol::INS_LOAD_KEY, 0x00, KEY_SLOT, KEY_BYTES};
+            if(!card.exchange(header, key, response) || response.sw[0] != Protocol::SW_OK[0] || response.sw[1] != Protocol::SW_OK[1])
+            {
+                fprintf(stderr, "%s didn't load its key (SW %02x %02x).\n", path.c_str(), response.sw[0], response.sw[1]);
+                return false;
+            }
+            card.aes.setKey(key);
+            return true;
+        }
+
+        /**
+         * @brief Stop a card by closing its socket & wait for its process.
+         * @param[inout] card (Card&): The card.
+         */
+        static void stop(Card &card)
+        {
+            if(card.fd >= 0) close(card.fd);
+            if(card.pid > 0) waitpid(card.pid, nullptr, 0);
+            card.fd = -1;
+            card.pid = -1;
+        }
+
+        /**
+         * @brief Decrypt the blocks of all cards with a work-stealing pool of Terminal threads.
+         * @param[inout] cards (std::vector<std::unique_ptr<Card>>&): The started cards.
+         * @param[in] threads (const unsigned): Number of Terminal threads.
+         * @return (bool): Whether all blocks were decrypted correctly.
+         */
+        bool run(std::vector<std::unique_ptr<Card>> &cards, const unsigned threads)
+        {
+            std::vector<WorkQueue> queues(threads);
+            long blocks = 0;
+            for(size_t i=0; i<cards.size(); i++)
+            {
+                queues[i % threads].push(cards[i].get());
+                blocks += cards[i]->remaining;
+            }
+            mPending = blocks;
+            mSteals = 0;
+            mFailed = false;
+
+            std::vector<std::thread> pool;
+            for(unsigned t=0; t<threads; t++)
+                pool.emplace_back(&Farm::work, this, std::ref(queues), t);
+            for(std::thread &thread : pool)
+                thread.join();
+            return !mFailed;
+        }
+
+        /**
+         * @brief Get the number of cards, that were stolen by another thread in the last run().
+         * @return (long): The number of steals.
+         */
+        long steals() const { return mSteals; }
+
+    private:
+        const std::string mDirectory;       ///< Directory of the virtualCard executables
+        const bool mRealTime;               ///< Whether the cards run in real time
+        std::atomic<long> mPending{0};      ///< Number of blocks, that are not decrypted yet
+        std::atomic<long> mSteals{0};       ///< Number of stolen cards
+        std::atomic<bool> mFailed{false};   ///< Whether a block failed
+        std::mutex mErrorMutex;             ///< Serializes the error messages
+
+        /**
+         * @brief Run a Terminal thread, until all blocks are decrypted.
+         * @param[inout] queues (std::vector<WorkQueue>&): The queues of all threads.
+         * @param[in] self (const unsigned): Index of the thread's own queue.
+         */
+        void work(std::vector<WorkQueue> &queues, const unsigned self)
+        {
+            while(mPending > 0)
+            {
+                Card *card = queues[self].pop();
+                for(size_t i=1; !card && i<queues.size(); i++)
+                {
+                    card = queues[(self + i) % queues.size()].steal();
+                    if(card) mSteals++;
+                }
+                if(!card)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                if(!decryptBlock(*card))
+                {
+                    // The card is dropped with all of its blocks
+                    mFailed = true;
+                    mPending -= card->remaining;
+                    continue;
+                }
+                mPending--;
+                if(--card->remaining > 0) queues[self].push(card);
+            }
+        }
+
+        /**
+         * @brief Decrypt a random block on a card & check the plaintext.
+         * @param[inout] card (Card&): The card.
+         * @return (bool): Whether the block was decrypted correctly.
+         */
+        bool decryptBlock(Card &card)
+        {
+            uint8_t cipher[STATE_BYTES];
+            for(uint8_t i=0; i<STATE_BYTES; i++) cipher[i] = static_cast<uint8_t>(card.random());
+            uint8_t expected[STATE_BYTES];
+            memcpy(expected, cipher, STATE_BYTES);
+            card.aes.decrypt(expected);
+
+            const uint8_t decryptHeader[] = {CLA, Protocol::INS_DECRYPT, 0x00, KEY_SLOT, STATE_BYTES};
+            CardResponse decrypted;
+            CardResponse plain;
+            const auto start = std::chrono::steady_clock::now();
+            const bool ok = card.exchange(decryptHeader, cipher, decrypted)
+                && decrypted.sw[0] == Protocol::RESPONSE_DECRYPTED[0] && decrypted.sw[1] == Protocol::RESPONSE_DECRYPTED[1]
+                && card.exchange(Protocol::DATA_OUT_HEADER, nullptr, plain)
+                && plain.sw[0] == Protocol::RESPONSE_DATA_OUT[0] && plain.sw[1] == Protocol::RESPONSE_DATA_OUT[1];
+            const auto end = std::chrono::steady_clock::now();
+            if(!ok || memcmp(plain.data, expected, STATE_BYTES) != 0)
+            {
+                std::lock_guard<std::mutex> lock(mErrorMutex);
+                fprintf(stderr, "Card %d (%s) failed block %zu.\n", card.pid, card.profile.c_str(), card.latencies.size());
+                return false;
+            }
+            card.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            card.cycles.push_back(plain.end - decrypted.start);
+            return true;
+        }
+    };
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> counts = split("1,8,64,256");
+    std::vector<std::string> profiles = split("plain");
+    int blocks = 32;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool realTime = false;
+    uint32_t seed = 1;
+    std::string directory = VIRTUAL_CARD_DIR;
+    int option = 0;
+    while((option = getopt(argc, argv, "c:p:n:j:rs:x:")) != -1)
+    {
+        switch(option)
+        {
+            case 'c': counts = split(optarg); break;
+            case 'p': profiles = split(optarg); break;
+            case 'n': blocks = atoi(optarg); break;
+            case 'j': threads = static_cast<unsigned>(atoi(optarg)); break;
+            case 'r': realTime = true; break;
+            case 's': seed = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)); break;
+            case 'x': directory = optarg; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind != argc || counts.empty() || profiles.empty() || blocks < 1 || threads < 1)
+        return usage(argv[0]);
+
+    Farm farm(directory, realTime);
+    for(const std::string &profile : profiles)
+    {
+        const std::string path = farm.executable(profile);
+        if(access(path.c_str(), X_OK) != 0)
+        {
+            fprintf(stderr, "There is no virtual card %s.\n", path.c_str());
+            return 2;
+        }
+    }
+
+    printf("| Cards | Threads | Blocks | Blocks/s | Latency p50 | Latency p99 | Latency max | Slowest card p99 | Line p50 | Line p99 | Steals |\n");
+    printf("|--:|--:|--:|--:|--:|--:|--:|--:|--:|--:|--:|\n");
+    std::mt19937 random(seed);
+    bool ok = true;
+    for(const std::string &count : counts)
+    {
+        const int nCards = atoi(count.c_str());
+        if(nCards < 1) return usage(argv[0]);
+
+        // Start the cards
+        std::vector<std::unique_ptr<Card>> cards;
+        for(int i=0; i<nCards && ok; i++)
+        {
+            std::unique_ptr<Card> card(new Card);
+            card->profile = profiles[i % profiles.size()];
+            card->random.seed(random());
+            card->remaining = blocks;
+            aes_key_t key;
+            for(uint8_t b=0; b<KEY_BYTES; b++) key[b] = static_cast<uint8_t>(random());
+            ok = farm.start(*card, key);
+            cards.push_back(std::move(card));
+        }
+
+        // Decrypt the blocks
+        const unsigned poolSize = std::min(threads, static_cast<unsigned>(nCards));
+        const auto start = std::chrono::steady_clock::now();
+        ok = ok && farm.run(cards, poolSize);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        for(std::unique_ptr<Card> &card : cards)
+            Farm::stop(*card);
+        if(!ok) break;
+
+        // Results
+        std::vector<uint64_t> latencies;
+        std::vector<uint64_t> cycles;
+        uint64_t slowestCard = 0;
+        for(const std::unique_ptr<Card> &card : cards)
+        {
+            latencies.insert(latencies.end(), card->latencies.begin(), card->latencies.end());
+            cycles.insert(cycles.end(), card->cycles.begin(), card->cycles.end());
+            std::vector<uint64_t> own(card->latencies);
+            std::sort(own.begin(), own.end());
+            slowestCard = std::max(slowestCard, percentile(own, 99));
+        }
+        std::sort(latencies.begin(), latencies.end());
+        std::sort(cycles.begin(), cycles.end());
+        printf("| %d | %u | %zu | %.0f | %.3f ms | %.3f ms | %.3f ms | %.3f ms | %.2f ms | %.2f ms | %ld |\n",
+               nCards, poolSize, latencies.size(), latencies.size() / elapsed.count(),
+               percentile(latencies, 50) * 1e-6, percentile(latencies, 99) * 1e-6, latencies.back() * 1e-6, slowestCard * 1e-6,
+               percentile(cycles, 50) * 1e3 / CARD_FREQUENCY, percentile(cycles, 99) * 1e3 / CARD_FREQUENCY, farm.steals());
+        fflush(stdout);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file cardMessage.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Messages between the card farm (or any other Terminal application) & a virtual card.
+ *
+ * A virtual card is connected through a local `SOCK_SEQPACKET` socket, so each message is a single packet:
+ * -# The card sends a CardResponse with the ATR in its data, as soon as a Terminal is connected.
+ * -# The Terminal sends a CardCommand & the card answers it with a CardResponse, as often as it likes.
+ *
+ * Both sides are built by the same compiler, so the structs are sent as they are.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef CARD_MESSAGE_H
+#define CARD_MESSAGE_H
+
+#include <cstdint>
+
+/**
+ * @brief A T=0 command for a virtual card.
+ */
+struct CardCommand
+{
+    uint8_t header[5];          ///< Command header (CLA, INS, P1, P2, P3)
+    uint8_t dataIn;             ///< 1, if the P3 bytes of #data are sent to the card, 0 if the card sends them
+    uint8_t data[255];          ///< Data to send to the card
+};
+
+/**
+ * @brief The answer of a virtual card to a CardCommand or to a new connection.
+ */
+struct CardResponse
+{
+    uint8_t completed;          ///< 1, if the card completed the command (or sent the ATR) in time
+    uint8_t sw[2];              ///< Status words of the command
+    uint8_t length;             ///< Number of valid bytes in #data
+    uint8_t data[255];          ///< Data sent by the card, or the ATR
+    uint64_t start;             ///< Card cycle, at which the Terminal started the command (or the start bit of the ATR)
+    uint64_t end;               ///< Card cycle after the last byte of the card
+};
+
+#endif // CARD_MESSAGE_H
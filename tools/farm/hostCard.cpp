@@ -0,0 +1,184 @@
+#include "hostCard.h"
+
+#include <stdexcept>
+#include <string>
+
+constexpr size_t HostCard::STACK_SIZE;
+constexpr uint64_t HostCard::NEVER;
+constexpr uint32_t HostCard::TURN_ETUS;
+HostCard *HostCard::sInstance = nullptr;
+
+// The firmware's main() & ISRs, which keep their vector names as symbols on the host
+int firmwareMain();
+void timerRoutine() __asm__("__vector_13");
+void pinChangeRoutine() __asm__("__vector_5");
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+HostCard::HostCard() : mStack(STACK_SIZE)
+{
+    if(sInstance)
+        throw std::logic_error("There can only be one HostCard per process.");
+    sInstance = this;
+
+    HostHardware::pinB.onRead = readPin;
+    HostHardware::portB.onWrite = writePort;
+    HostHardware::ddrB.onWrite = writePort;
+    HostHardware::tcnt1.onRead = readCounter;
+    HostHardware::tcnt1.onWrite = writeCounter;
+    HostHardware::tccr1B.onWrite = writeControl;
+    HostHardware::sleepHook = sleep;
+
+    getcontext(&mFirmwareContext);
+    mFirmwareContext.uc_stack.ss_sp = mStack.data();
+    mFirmwareContext.uc_stack.ss_size = mStack.size();
+    mFirmwareContext.uc_link = &mTerminalContext;
+    makecontext(&mFirmwareContext, run, 0);
+    resume();
+}
+
+HostCard::~HostCard()
+{
+    HostHardware::pinB.onRead = nullptr;
+    HostHardware::portB.onWrite = nullptr;
+    HostHardware::ddrB.onWrite = nullptr;
+    HostHardware::tcnt1.onRead = nullptr;
+    HostHardware::tcnt1.onWrite = nullptr;
+    HostHardware::tccr1B.onWrite = nullptr;
+    HostHardware::sleepHook = nullptr;
+    sInstance = nullptr;
+}
+
+void HostCard::runUntil(const uint64_t cycle)
+{
+    for(uint64_t next = nextMatch(); next <= cycle; next = nextMatch())
+        match(next);
+    if(cycle > mNow) mNow = cycle;
+}
+
+bool HostCard::waitForLine(const bool level, const uint64_t deadline)
+{
+    while(mLine != level)
+    {
+        const uint64_t next = nextMatch();
+        if(next > deadline)
+        {
+            if(deadline > mNow) mNow = deadline;
+            return false;
+        }
+        match(next);
+    }
+    return true;
+}
+
+void HostCard::setTerminalLow(const bool low)
+{
+    const bool before = mLine;
+    mTerminalLow = low;
+    drive(TERMINAL, low);
+    updateLine();
+    // Only the Terminal's edges raise the pin-change interrupt, the card doesn't listen while it drives the line
+    if(mLine != before && GET_BIT(HostHardware::pcicr.value, PCIE1) && GET_BIT(HostHardware::pcmsk1.value, PCINT14))
+    {
+        // A falling edge the card listens for is a start bit
+        if(!mLine) mGuardEnd = mNow + (TURN_ETUS-1)*ETU;
+        pinChangeRoutine();
+        resume();
+    }
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+uint64_t HostCard::nextMatch() const
+{
+    // Only the compare match A in CTC mode raises an interrupt, e.g. not the CycleCounter in normal mode
+    if(!mTimerRunning || !GET_BIT(HostHardware::tccr1B.value, WGM12) || !GET_BIT(HostHardware::timsk1.value, OCIE1A))
+        return NEVER;
+    const uint64_t from = mNow > mTimerBase ? mNow : mTimerBase;
+    const uint16_t value = static_cast<uint16_t>(mTimerValue + (from - mTimerBase));
+    return from + static_cast<uint16_t>(HostHardware::ocr1A.value - value);
+}
+
+void HostCard::match(const uint64_t cycle)
+{
+    mNow = cycle;
+    // In CTC mode, the counter is cleared in the cycle after the match
+    mTimerValue = 0;
+    mTimerBase = cycle + 1;
+    timerRoutine();
+    resume();
+}
+
+uint16_t HostCard::counter() const
+{
+    if(!mTimerRunning || mNow <= mTimerBase) return mTimerValue;
+    return static_cast<uint16_t>(mTimerValue + (mNow - mTimerBase));
+}
+
+uint64_t HostCard::timerBase() const
+{
+    if(GET_BIT(HostHardware::ddrB.value, DDB6) && mGuardEnd > mNow) return mGuardEnd;
+    return mNow;
+}
+
+void HostCard::updateLine()
+{
+    // Open-drain line with pull-up: Either side can pull it low
+    const bool cardLow = GET_BIT(HostHardware::ddrB.value, DDB6) && !GET_BIT(HostHardware::portB.value, PB6);
+    drive(CARD, cardLow);
+    mLine = !(cardLow || mTerminalLow);
+}
+
+void HostCard::resume()
+{
+    if(mStopped)
+        throw std::runtime_error("The firmware stopped at cycle " + std::to_string(mNow) + ".");
+    swapcontext(&mTerminalContext, &mFirmwareContext);
+}
+
+void HostCard::run()
+{
+    firmwareMain();
+    sInstance->mStopped = true;
+}
+
+void HostCard::sleep()
+{
+    swapcontext(&sInstance->mFirmwareContext, &sInstance->mTerminalContext);
+}
+
+void HostCard::readPin(HostRegister<uint8_t> &reg)
+{
+    if(sInstance->mLine) SET_BIT(reg.value, PINB6);
+    else                 CLR_BIT(reg.value, PINB6);
+}
+
+void HostCard::writePort(HostRegister<uint8_t>&)
+{
+    sInstance->updateLine();
+}
+
+void HostCard::readCounter(HostRegister<uint16_t> &reg)
+{
+    reg.value = sInstance->counter();
+}
+
+void HostCard::writeCounter(HostRegister<uint16_t> &reg)
+{
+    sInstance->mTimerValue = reg.value;
+    sInstance->mTimerBase = sInstance->timerBase();
+}
+
+void HostCard::writeControl(HostRegister<uint8_t> &reg)
+{
+    // The firmware only uses Timer1 without a prescaler
+    const bool running = GET_BIT(reg.value, CS10);
+    if(running == sInstance->mTimerRunning) return;
+    if(running)
+        sInstance->mTimerBase = sInstance->timerBase();
+    else
+        sInstance->mTimerValue = sInstance->counter();
+    sInstance->mTimerRunning = running;
+}
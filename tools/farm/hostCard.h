@@ -0,0 +1,133 @@
+/**
+ * @file hostCard.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the HostCard class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef HOST_CARD_H
+#define HOST_CARD_H
+
+#include <cstdint>
+#include <ucontext.h>
+#include <vector>
+
+#include "ioLine.h"
+#include "protocol.h"
+
+/**
+ * @brief Class that runs the card's firmware natively on the host & models Timer1 & the I/O line.
+ *
+ * The firmware's main() is compiled as `firmwareMain()` & runs in its own context (ucontext) on the host backend of
+ * the hardware abstraction layer. Whenever it goes to sleep (HostHardware::sleepHook), control returns to the
+ * Terminal, which advances the time to the next event: A compare match of Timer1 in CTC mode calls its ISR
+ * (`__vector_13`), a change of the I/O line by the Terminal calls the pin-change ISR (`__vector_5`),
+ * if it is enabled. The firmware is resumed after each ISR, until it sleeps again.
+ *
+ * So the bit timing of the I/O line is exact, but the firmware's code runs in zero time: The cycles are those of
+ * the line, not of the AES. The firmware's state is global, so there can only be one HostCard per process.
+ *
+ * On the AVR, the card's processing time keeps its answer away from the Terminal's last character. Without it, the
+ * card could start sending before the Terminal's stop bit & error signal are over. So the HostCard models the guard
+ * time of ISO 7816-3 itself: If the card starts Timer1 to send, its first bit starts at least #TURN_ETUS after the
+ * Terminal's last start bit.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class HostCard : public IOLine
+{
+public:
+    /**
+     * @brief Reset the card & run the firmware until it sleeps for the first time, i.e. while it sends the ATR.
+     * @throws std::logic_error If there is already a HostCard in this process.
+     */
+    HostCard();
+
+    /**
+     * @brief Destroy the HostCard object & remove the hooks of the emulated hardware.
+     */
+    ~HostCard() override;
+
+    HostCard(const HostCard&) = delete;
+    HostCard &operator=(const HostCard&) = delete;
+
+    uint64_t cycle() const override { return mNow; }
+    void runUntil(const uint64_t cycle) override;
+    bool waitForLine(const bool level, const uint64_t deadline) override;
+    bool line() const override { return mLine; }
+    void setTerminalLow(const bool low) override;
+
+private:
+    static constexpr size_t STACK_SIZE   = 256*1024;     ///< Stack of the firmware's context in bytes
+    static constexpr uint64_t NEVER      = UINT64_MAX;   ///< Time of an event, that doesn't happen
+    static constexpr uint32_t TURN_ETUS  = 16;           ///< Minimum distance of start bits in opposite directions in ETUs
+
+    static HostCard *sInstance;         ///< The card of this process, for the hooks of the emulated hardware
+
+    ucontext_t mTerminalContext;        ///< Context of the Terminal, while the firmware runs
+    ucontext_t mFirmwareContext;        ///< Context of the firmware, while it sleeps
+    std::vector<uint8_t> mStack;        ///< Stack of the firmware's context
+    bool mStopped           = false;    ///< Whether the firmware's main() returned
+    uint64_t mNow           = 0;        ///< Current clock cycle
+    bool mTerminalLow       = false;    ///< Whether the Terminal pulls the I/O line low
+    bool mLine              = true;     ///< Level of the I/O line
+    bool mTimerRunning      = false;    ///< Whether Timer1 has a clock source
+    uint16_t mTimerValue    = 0;        ///< Value of TCNT1 at #mTimerBase
+    uint64_t mTimerBase     = 0;        ///< Cycle from which TCNT1 counts up from #mTimerValue
+    uint64_t mGuardEnd      = 0;        ///< First cycle at which the card may start Timer1 to send
+
+    /**
+     * @brief Get the cycle of the next compare match of Timer1, that raises an interrupt.
+     * @return (uint64_t): The cycle of the next match, or #NEVER.
+     */
+    uint64_t nextMatch() const;
+
+    /**
+     * @brief Advance the time to the compare match at @p cycle, call the ISR of Timer1 & resume the firmware.
+     * @param[in] cycle (const uint64_t): Cycle of the match.
+     */
+    void match(const uint64_t cycle);
+
+    /**
+     * @brief Get the value of TCNT1 at the current cycle.
+     * @return (uint16_t): The value of the counter.
+     */
+    uint16_t counter() const;
+
+    /**
+     * @brief Get the cycle from which Timer1 counts, if it's started or written at the current cycle.
+     *
+     * If the card drives the I/O line, the timer is held until #mGuardEnd, so the start bit of the card's first
+     * character (1 ETU after the timer's start) is #TURN_ETUS after the Terminal's last start bit.
+     * @return (uint64_t): The cycle from which TCNT1 counts.
+     */
+    uint64_t timerBase() const;
+
+    /**
+     * @brief Update the level of the I/O line from the card's registers & the Terminal.
+     */
+    void updateLine();
+
+    /**
+     * @brief Run the firmware until it sleeps again.
+     * @throws std::runtime_error If the firmware's main() returned.
+     */
+    void resume();
+
+    // Hooks of the emulated hardware
+    static void run();
+    static void sleep();
+    static void readPin(HostRegister<uint8_t> &reg);
+    static void writePort(HostRegister<uint8_t> &reg);
+    static void readCounter(HostRegister<uint16_t> &reg);
+    static void writeCounter(HostRegister<uint16_t> &reg);
+    static void writeControl(HostRegister<uint8_t> &reg);
+};
+
+#endif // HOST_CARD_H
@@ -0,0 +1,220 @@
+/**
+ * @file virtualCard.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Run the card's firmware on the host as a virtual card behind a local socket.
+ *
+ * Usage: `virtualCard [-r] [-t trace] <-f fd | -s socket>`
+ *
+ * The firmware runs in a HostCard & is driven by the bit-level T=0 Terminal of the simulator tools.
+ * Terminal applications talk to it with the messages of cardMessage.h: The card sends its ATR after each connection
+ * & answers each CardCommand with a CardResponse, until the connection is closed.
+ * The countermeasures are compile-time options, so there is one executable per profile,
+ * e.g. `virtualCard_masking`. The state of the card (keys, counters) persists across connections.
+ *
+ * - `-f` serves a single connection on an inherited `SOCK_SEQPACKET` socket, e.g. of the card farm, & exits after it.
+ * - `-s` listens on a Unix `SOCK_SEQPACKET` socket at the given path & serves one connection after the other.
+ * - `-r` runs the card in real time: Each response is delayed until the card's clock (4.8 MHz) has caught up with
+ *   the wall clock, & the card is idle between the commands. Otherwise the card answers as fast as the host allows.
+ * - `-t` records the I/O line from the reset on & saves the trace after each connection (see LineTrace),
+ *   so the session can be replayed with `lineReplay`.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "cardMessage.h"
+#include "hostCard.h"
+#include "lineTrace.h"
+#include "terminal.h"
+
+namespace
+{
+    constexpr uint64_t BYTE_TIMEOUT     = 50000000;     ///< Cycles to wait for a byte of the card, about 10s
+
+    typedef std::chrono::steady_clock wall_clock_t;     ///< Clock of the real time
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-r] [-t trace] <-f fd | -s socket>\n", name);
+        return 2;
+    }
+
+    /**
+     * @brief Class that serves the connections to the virtual card.
+     */
+    class Server
+    {
+    public:
+        /**
+         * @brief Construct a new Server object & receive the ATR of the card.
+         * @param[in] realTime (const bool): Whether the card runs in real time.
+         * @param[in] trace (const char*): Path of the trace of the I/O line, nullptr to record none.
+         * @throws std::runtime_error If the card sends no ATR.
+         */
+        Server(const bool realTime, const char *trace) : mTerminal(mCard), mRealTime(realTime), mTracePath(trace)
+        {
+            if(mTracePath) mCard.record(&mTrace.edges());
+            mEpoch = wall_clock_t::now();
+            if(!mTerminal.receiveATR(mATR, BYTE_TIMEOUT))
+                throw std::runtime_error("The card sent no ATR.");
+        }
+
+        /**
+         * @brief Send the ATR & answer the commands of a connection, until it is closed.
+         * @param[in] fd (const int): The connected socket.
+         * @return (bool): Whether the connection was closed without an error.
+         * @throws std::runtime_error If the trace can't be saved.
+         */
+        bool serve(const int fd)
+        {
+            CardResponse response;
+            memset(&response, 0, sizeof(response));
+            response.completed = 1;
+            response.length = static_cast<uint8_t>(mATR.size());
+            memcpy(response.data, mATR.data(), mATR.size());
+            response.start = mTerminal.atrStart();
+            response.end = mCard.cycle();
+            if(send(fd, &response, sizeof(response), MSG_NOSIGNAL) != sizeof(response)) return false;
+
+            CardCommand command;
+            bool closed = false;
+            while(true)
+            {
+                const ssize_t received = recv(fd, &command, sizeof(command), 0);
+                closed = received == 0;
+                if(received != sizeof(command)) break;
+                execute(command, response);
+                if(send(fd, &response, sizeof(response), MSG_NOSIGNAL) != sizeof(response)) break;
+            }
+            if(mTracePath)
+            {
+                // Record the stop bit & the error window of the last character
+                mCard.runUntil(mCard.cycle() + Terminal::GUARD_ETUS*HostCard::ETU);
+                mTrace.save(mTracePath);
+            }
+            return closed;
+        }
+
+    private:
+        HostCard mCard;                     ///< The card
+        Terminal mTerminal;                 ///< The Terminal on the card's I/O line
+        const bool mRealTime;               ///< Whether the card runs in real time
+        std::vector<uint8_t> mATR;          ///< The ATR of the card
+        wall_clock_t::time_point mEpoch;    ///< Wall clock time of the card's cycle 0, in real time
+        LineTrace mTrace;                   ///< Trace of the I/O line since the reset
+        const char *mTracePath;             ///< Path of the trace, nullptr if it isn't recorded
+
+        /**
+         * @brief Get the wall clock time of a cycle of the card.
+         * @param[in] cycle (const uint64_t): The cycle.
+         * @return (wall_clock_t::time_point): The wall clock time.
+         */
+        wall_clock_t::time_point wallTime(const uint64_t cycle) const
+        {
+            return mEpoch + std::chrono::duration_cast<wall_clock_t::duration>(std::chrono::duration<double>(static_cast<double>(cycle) / IOLine::FREQUENCY));
+        }
+
+        /**
+         * @brief Exchange a command with the card.
+         * @param[in] command (const CardCommand&): The command.
+         * @param[out] response (CardResponse&): The answer of the card.
+         */
+        void execute(const CardCommand &command, CardResponse &response)
+        {
+            memset(&response, 0, sizeof(response));
+            // The card is idle since the last command
+            if(mRealTime)
+            {
+                const std::chrono::duration<double> idle = wall_clock_t::now() - mEpoch;
+                mCard.runUntil(static_cast<uint64_t>(idle.count() * IOLine::FREQUENCY));
+            }
+
+            const uint8_t length = command.header[Terminal::P3_INDEX];
+            response.start = mCard.cycle();
+            response.completed = mTerminal.command(command.header, command.dataIn ? command.data : nullptr,
+                                                   response.data, response.sw, BYTE_TIMEOUT);
+            response.length = command.dataIn ? 0 : length;
+            response.end = mCard.cycle();
+            if(mRealTime) std::this_thread::sleep_until(wallTime(response.end));
+        }
+    };
+}
+
+int main(int argc, char **argv)
+{
+    bool realTime = false;
+    int fd = -1;
+    const char *path = nullptr;
+    const char *trace = nullptr;
+    int option = 0;
+    while((option = getopt(argc, argv, "rt:f:s:")) != -1)
+    {
+        switch(option)
+        {
+            case 'r': realTime = true; break;
+            case 't': trace = optarg; break;
+            case 'f': fd = atoi(optarg); break;
+            case 's': path = optarg; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind != argc || (fd < 0) == (path == nullptr)) return usage(argv[0]);
+
+    try
+    {
+        Server server(realTime, trace);
+        if(fd >= 0)
+            return server.serve(fd) ? 0 : 1;
+
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if(strlen(path) >= sizeof(address.sun_path))
+        {
+            fprintf(stderr, "The socket path %s is too long.\n", path);
+            return 2;
+        }
+        strcpy(address.sun_path, path);
+        unlink(path);
+        const int listener = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        if(listener < 0 || bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 1) != 0)
+        {
+            perror(path);
+            return 1;
+        }
+        while(true)
+        {
+            const int connection = accept(listener, nullptr, nullptr);
+            if(connection < 0)
+            {
+                perror("accept");
+                return 1;
+            }
+            if(!server.serve(connection)) fprintf(stderr, "The connection was closed with an error.\n");
+            close(connection);
+        }
+    }
+    catch(const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,171 @@
+/**
+ * @file logDecode.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Decode the binary log records of the card's Logger into text.
+ *
+ * Usage: `logDecode [--hex] [file]`
+ *
+ * - Without `--hex`, the input is the raw byte stream of the USART, e.g. `logDecode /dev/ttyUSB0`.
+ * - With `--hex`, the input is text with hex bytes, e.g. the data of GET DATA responses (tag 03).
+ *
+ * Without a file, the input is read from stdin. The records are printed as soon as they are complete.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "logEvents.h"
+
+namespace
+{
+    const char *const PHASE_NAMES[] =
+    {
+        "addRoundKey", "invShiftRows", "invByteSub", "invMixCols", "maskingInit", "hidingInit"
+    };
+
+    /**
+     * @brief Read the next byte of the input.
+     * @param[in] input (FILE*): The input.
+     * @param[in] hex (const bool): Whether the input is hex text.
+     * @param[out] byte (uint8_t&): The byte.
+     * @return (bool): Whether a byte was read, false at the end of the input.
+     */
+    bool readByte(FILE *input, const bool hex, uint8_t &byte)
+    {
+        if(!hex)
+        {
+            const int c = fgetc(input);
+            if(c == EOF) return false;
+            byte = static_cast<uint8_t>(c);
+            return true;
+        }
+        // Two hex digits, anything else separates the bytes
+        char digits[3] = {};
+        uint8_t count = 0;
+        for(int c = fgetc(input); c != EOF; c = fgetc(input))
+        {
+            if(isxdigit(c))
+            {
+                digits[count++] = static_cast<char>(c);
+                if(count == 2) break;
+            }
+            else if(count) break;
+        }
+        if(count == 0) return false;
+        byte = static_cast<uint8_t>(strtoul(digits, nullptr, 16));
+        return true;
+    }
+
+    uint16_t read16(const uint8_t *data) { return data[0] | (data[1] << 8); }
+    uint32_t read32(const uint8_t *data) { return read16(data) | (static_cast<uint32_t>(read16(data + 2)) << 16); }
+
+    /**
+     * @brief Print the payload as hex bytes.
+     * @param[in] name (const char*): Description of the record.
+     * @param[in] payload (const std::vector<uint8_t>&): Payload of the record.
+     */
+    void printBytes(const char *name, const std::vector<uint8_t> &payload)
+    {
+        printf("%s:", name);
+        for(const uint8_t byte : payload)
+            printf(" %02x", byte);
+        printf("\n");
+    }
+
+    /**
+     * @brief Print a single record.
+     * @param[in] event (const uint8_t): Event id of the record.
+     * @param[in] payload (const std::vector<uint8_t>&): Payload of the record.
+     */
+    void printRecord(const uint8_t event, const std::vector<uint8_t> &payload)
+    {
+        switch(static_cast<LogEvent>(event))
+        {
+            case LogEvent::DROPPED:
+                printf("Dropped %u records\n", payload.empty() ? 0u : payload[0]);
+                break;
+            case LogEvent::BOOT:
+                printf("Boot\n");
+                break;
+            case LogEvent::PIN_NOT_INPUT:
+                printf("The I/O-Pin should be set to input right now!\n");
+                break;
+            case LogEvent::MISSED_START_BIT:
+                printf("We either missed the start-bit, or just indicated an error-bit.\n");
+                break;
+            case LogEvent::COMMAND_REJECTED:
+                printBytes("Rejected a command with", payload);
+                break;
+            case LogEvent::HEADER_MISMATCH:
+                if(payload.size() < 3) break;
+                printf("Received wrong byte 0x%X instead of 0x%X at sequence position %u.\n", payload[0], payload[1], payload[2]);
+                break;
+            case LogEvent::RECEIVED_DATA:
+                printBytes("Received data to decrypt", payload);
+                break;
+            case LogEvent::DECRYPTED_DATA:
+                printBytes("Decrypted data", payload);
+                break;
+            case LogEvent::PROFILE_PHASE:
+            {
+                if(payload.size() < 13) break;
+                const uint8_t phase = payload[0];
+                const uint16_t count = read16(&payload[1]);
+                printf("%s: n=%u min=%u avg=%lu max=%u last=%u\n",
+                       phase < sizeof(PHASE_NAMES)/sizeof(PHASE_NAMES[0]) ? PHASE_NAMES[phase] : "unknown",
+                       count, read16(&payload[3]), count ? static_cast<unsigned long>(read32(&payload[9]) / count) : 0ul,
+                       read16(&payload[5]), read16(&payload[7]));
+            }
+            break;
+            default:
+                printBytes("Unknown event", payload);
+                break;
+        }
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool hex = false;
+    const char *path = nullptr;
+    for(int i=1; i<argc; i++)
+    {
+        if(strcmp(argv[i], "--hex") == 0) hex = true;
+        else path = argv[i];
+    }
+
+    FILE *input = path ? fopen(path, hex ? "r" : "rb") : stdin;
+    if(!input)
+    {
+        fprintf(stderr, "Can't open %s.\n", path);
+        return 1;
+    }
+
+    // Each record: event id, payload length, payload
+    uint8_t event = 0;
+    uint8_t len = 0;
+    while(readByte(input, hex, event) && readByte(input, hex, len))
+    {
+        std::vector<uint8_t> payload(len);
+        bool complete = true;
+        for(uint8_t i=0; i<len && complete; i++)
+            complete = readByte(input, hex, payload[i]);
+        if(!complete)
+        {
+            fprintf(stderr, "Truncated record.\n");
+            break;
+        }
+        printRecord(event, payload);
+    }
+
+    if(path) fclose(input);
+    return 0;
+}
@@ -0,0 +1,427 @@
+/**
+ * @file cpa.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Recover the last round key from a trace file with a correlation power analysis (CPA).
+ *
+ * Usage: `cpa [-j threads] [-c chunk] [-w window] [-s from:to] [-i interval] <traces>`
+ *
+ * The hypothesis for byte j of the last round key & a guess k is the Hamming weight of the output of the first
+ * AES::invByteSub() of the decryption, `HW(INV_S_BOX[c[j] ^ k])` for the ciphertext c, which is correlated with
+ * each sample of the traces. The traces are streamed from the TraceFile in chunks of `-c` traces (default 4096),
+ * which are released after they are processed, so the file can be much larger than the memory.
+ *
+ * The sums are partitioned by the value of the ciphertext byte: Each trace adds its samples to one row of 256 per
+ * key byte, & the sums of all 256 guesses are derived from these rows, whenever the ranks are reported. Both the
+ * accumulation & the correlation are split into tasks of one key byte & one window of `-w` samples (default 256),
+ * which a pool of threads (default: one per core) processes. Their loops are compiled for AVX2 & for the baseline
+ * of the CPU, the faster one is selected at runtime.
+ *
+ * The rank of each byte of the correct last round key (derived from the key in the file) among the 256 guesses
+ * is printed as the traces accumulate, whenever the number of traces has doubled since 1000 traces or, with `-i`,
+ * every `interval` traces. `-s` restricts the analysis to the samples from `from` to `to` (exclusive).
+ * The sums need `16 * 256 * 8` bytes per sample.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "aes.h"
+#include "lut.h"
+#include "parallel.h"
+#include "traceFile.h"
+
+namespace
+{
+    constexpr uint32_t GUESSES = 256;       ///< Guesses of a key byte
+    constexpr uint32_t VALUES = 256;        ///< Values of a ciphertext byte, the rows of the partitioned sums
+
+    /**
+     * @brief Add samples to sums.
+     * @param[inout] sums (int64_t*): The sums.
+     * @param[in] samples (const int8_t*): The samples.
+     * @param[in] n (const uint32_t): Number of samples.
+     */
+    SIMD_CLONES void add(int64_t *__restrict sums, const int8_t *__restrict samples, const uint32_t n)
+    {
+        for(uint32_t i=0; i<n; i++)
+            sums[i] += samples[i];
+    }
+
+    /**
+     * @brief Add samples & their squares to sums.
+     * @param[inout] sums (int64_t*): The sums of the samples.
+     * @param[inout] squares (int64_t*): The sums of the squares.
+     * @param[in] samples (const int8_t*): The samples.
+     * @param[in] n (const uint32_t): Number of samples.
+     */
+    SIMD_CLONES void addSquares(int64_t *__restrict sums, int64_t *__restrict squares, const int8_t *__restrict samples, const uint32_t n)
+    {
+        for(uint32_t i=0; i<n; i++)
+        {
+            const int32_t sample = samples[i];
+            sums[i] += sample;
+            squares[i] += sample * sample;
+        }
+    }
+
+    /**
+     * @brief Add a multiple of a row to another row.
+     * @param[inout] acc (float*): The row to add to.
+     * @param[in] factor (const float): The factor.
+     * @param[in] row (const float*): The row to add.
+     * @param[in] n (const uint32_t): Number of samples of the rows.
+     */
+    SIMD_CLONES void axpy(float *__restrict acc, const float factor, const float *__restrict row, const uint32_t n)
+    {
+        for(uint32_t i=0; i<n; i++)
+            acc[i] += factor * row[i];
+    }
+
+    /**
+     * @brief Streaming CPA of the 16 bytes of the last round key.
+     */
+    class Correlation
+    {
+    public:
+        /**
+         * @brief The strongest correlation of a guess within a window.
+         */
+        struct Peak
+        {
+            float r = 0;            ///< Absolute correlation
+            uint32_t sample = 0;    ///< Sample of the correlation
+        };
+
+        /**
+         * @brief Allocate the sums.
+         * @param[in] from (const uint32_t): First sample of the analysis.
+         * @param[in] samples (const uint32_t): Number of samples of the analysis.
+         * @param[in] window (const uint32_t): Samples per task.
+         */
+        Correlation(const uint32_t from, const uint32_t samples, const uint32_t window)
+            : mFrom(from), mSamples(samples), mWindow(window), mWindows((samples + window - 1) / window),
+              mSums(static_cast<size_t>(STATE_BYTES) * VALUES * samples), mSumX(samples), mSumXX(samples),
+              mCounts(static_cast<size_t>(STATE_BYTES) * VALUES), mPeaks(static_cast<size_t>(STATE_BYTES) * mWindows * GUESSES)
+        {
+            // Hypotheses: Hamming weight of the output of the inverse S-Box
+            for(uint32_t k=0; k<GUESSES; k++)
+                for(uint32_t v=0; v<VALUES; v++)
+                    mHypotheses[k][v] = static_cast<float>(__builtin_popcount(pgm_read_byte(&LUT::INV_S_BOX[v ^ k])));
+        }
+
+        uint32_t tasks() const { return STATE_BYTES * mWindows; }
+        uint64_t traces() const { return mTraces; }
+
+        /**
+         * @brief Add traces to the sums of a task.
+         * @param[in] file (const TraceFile&): The trace file.
+         * @param[in] task (const uint32_t): Index of the task, the key byte & the window.
+         * @param[in] first (const uint64_t): First trace.
+         * @param[in] count (const uint64_t): Number of traces.
+         */
+        void accumulate(const TraceFile &file, const uint32_t task, const uint64_t first, const uint64_t count)
+        {
+            const uint32_t byte = task / mWindows;
+            const uint32_t begin = (task % mWindows) * mWindow;
+            const uint32_t n = std::min(mWindow, mSamples - begin);
+            int64_t *sums = &mSums[static_cast<size_t>(byte) * VALUES * mSamples + begin];
+            uint64_t *counts = &mCounts[byte * VALUES];
+            for(uint64_t trace=first; trace<first+count; trace++)
+            {
+                const uint8_t value = file.ciphertext(trace)[byte];
+                const int8_t *samples = file.samples(trace) + mFrom + begin;
+                add(&sums[static_cast<size_t>(value) * mSamples], samples, n);
+                // Each count & sum of the samples belongs to exactly one task
+                if(begin == 0) counts[value]++;
+                if(byte == 0) addSquares(&mSumX[begin], &mSumXX[begin], samples, n);
+            }
+        }
+
+        /**
+         * @brief Count the traces, that all tasks have added.
+         * @param[in] count (const uint64_t): Number of traces.
+         */
+        void added(const uint64_t count) { mTraces += count; }
+
+        /**
+         * @brief Correlate the hypotheses of all guesses of a task with its samples.
+         * @param[in] task (const uint32_t): Index of the task, the key byte & the window.
+         */
+        void correlate(const uint32_t task)
+        {
+            const uint32_t byte = task / mWindows;
+            const uint32_t window = task % mWindows;
+            const uint32_t begin = window * mWindow;
+            const uint32_t n = std::min(mWindow, mSamples - begin);
+            const double traces = static_cast<double>(mTraces);
+            const uint64_t *counts = &mCounts[byte * VALUES];
+
+            // Centre the rows, so the products of the guesses only need single precision:
+            // sum(h * (x - mean)) = sum over v of h(v) * (S(v) - n(v) * mean)
+            std::vector<float> centred(static_cast<size_t>(VALUES) * n);
+            std::vector<float> deviationX(n);
+            for(uint32_t t=0; t<n; t++)
+            {
+                const double mean = mSumX[begin + t] / traces;
+                deviationX[t] = static_cast<float>(std::sqrt(std::max(0.0, mSumXX[begin + t] - mSumX[begin + t] * mean)));
+                for(uint32_t v=0; v<VALUES; v++)
+                {
+                    const int64_t sum = mSums[(static_cast<size_t>(byte) * VALUES + v) * mSamples + begin + t];
+                    centred[static_cast<size_t>(v) * n + t] = static_cast<float>(sum - counts[v] * mean);
+                }
+            }
+
+            std::vector<float> covariance(n);
+            for(uint32_t k=0; k<GUESSES; k++)
+            {
+                double sumH = 0;
+                double sumHH = 0;
+                std::fill(covariance.begin(), covariance.end(), 0.0f);
+                for(uint32_t v=0; v<VALUES; v++)
+                {
+                    const float h = mHypotheses[k][v];
+                    sumH += h * counts[v];
+                    sumHH += h * h * counts[v];
+                    if(h != 0 && counts[v]) axpy(covariance.data(), h, &centred[static_cast<size_t>(v) * n], n);
+                }
+                const float deviationH = static_cast<float>(std::sqrt(std::max(0.0, sumHH - sumH * sumH / traces)));
+
+                Peak &peak = mPeaks[(static_cast<size_t>(byte) * mWindows + window) * GUESSES + k];
+                peak = Peak();
+                for(uint32_t t=0; t<n; t++)
+                {
+                    const float deviation = deviationH * deviationX[t];
+                    if(deviation <= 0) continue;
+                    const float r = std::fabs(covariance[t]) / deviation;
+                    if(r > peak.r)
+                    {
+                        peak.r = r;
+                        peak.sample = mFrom + begin + t;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Get the strongest correlation of a guess over all windows, after correlate() of all tasks.
+         * @param[in] byte (const uint32_t): The key byte.
+         * @param[in] guess (const uint32_t): The guess.
+         * @return (Peak): The strongest correlation.
+         */
+        Peak peak(const uint32_t byte, const uint32_t guess) const
+        {
+            Peak best;
+            for(uint32_t window=0; window<mWindows; window++)
+            {
+                const Peak &peak = mPeaks[(static_cast<size_t>(byte) * mWindows + window) * GUESSES + guess];
+                if(peak.r > best.r) best = peak;
+            }
+            return best;
+        }
+
+        /**
+         * @brief Get the rank of a guess, after correlate() of all tasks.
+         * @param[in] byte (const uint32_t): The key byte.
+         * @param[in] guess (const uint32_t): The guess.
+         * @return (uint32_t): 1, if no other guess correlates stronger, up to 256.
+         */
+        uint32_t rank(const uint32_t byte, const uint32_t guess) const
+        {
+            const float r = peak(byte, guess).r;
+            uint32_t rank = 1;
+            for(uint32_t k=0; k<GUESSES; k++)
+                rank += (k != guess && peak(byte, k).r > r);
+            return rank;
+        }
+
+        /**
+         * @brief Get the guess with the strongest correlation, after correlate() of all tasks.
+         * @param[in] byte (const uint32_t): The key byte.
+         * @return (uint8_t): The guess.
+         */
+        uint8_t best(const uint32_t byte) const
+        {
+            uint32_t best = 0;
+            for(uint32_t k=1; k<GUESSES; k++)
+                if(peak(byte, k).r > peak(byte, best).r) best = k;
+            return static_cast<uint8_t>(best);
+        }
+
+    private:
+        const uint32_t mFrom;           ///< First sample of the analysis
+        const uint32_t mSamples;        ///< Number of samples of the analysis
+        const uint32_t mWindow;         ///< Samples per task
+        const uint32_t mWindows;        ///< Windows per key byte
+        uint64_t mTraces = 0;           ///< Number of traces in the sums
+        float mHypotheses[GUESSES][VALUES];     ///< Hypothesis of each guess & value of the ciphertext byte
+        std::vector<int64_t> mSums;     ///< Sums of the samples per key byte & value of the ciphertext byte
+        std::vector<int64_t> mSumX;     ///< Sums of the samples
+        std::vector<int64_t> mSumXX;    ///< Sums of the squares of the samples
+        std::vector<uint64_t> mCounts;  ///< Traces per key byte & value of the ciphertext byte
+        std::vector<Peak> mPeaks;       ///< Strongest correlation per key byte, window & guess
+    };
+
+    /**
+     * @brief Derive the key from the last round key by inverting the key schedule (see AES::createRoundKey()).
+     * @param[in] last (const uint8_t*): The last round key.
+     * @param[out] key ( @ref aes_key_t): The key.
+     */
+    void invertKeySchedule(const uint8_t *last, aes_key_t key)
+    {
+        memcpy(key, last, KEY_BYTES);
+        for(uint8_t round=ROUNDS; round>0; round--)
+        {
+            for(uint8_t i=KEY_BYTES-1; i>=WORD_BYTES; i--)
+                key[i] ^= key[i - WORD_BYTES];
+            key[0] ^= pgm_read_byte(&LUT::S_BOX[key[13]]) ^ AES::roundCoefficient(round);
+            key[1] ^= pgm_read_byte(&LUT::S_BOX[key[14]]);
+            key[2] ^= pgm_read_byte(&LUT::S_BOX[key[15]]);
+            key[3] ^= pgm_read_byte(&LUT::S_BOX[key[12]]);
+        }
+    }
+
+    /**
+     * @brief Print bytes as hex digits.
+     * @param[in] bytes (const uint8_t*): The bytes.
+     * @param[in] n (const uint8_t): Number of bytes.
+     */
+    void printHex(const uint8_t *bytes, const uint8_t n)
+    {
+        for(uint8_t i=0; i<n; i++)
+            printf("%02x", bytes[i]);
+    }
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-j threads] [-c chunk] [-w window] [-s from:to] [-i interval] <traces>\n", name);
+        return 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t chunk = 4096;
+    uint32_t window = 256;
+    uint32_t from = 0;
+    uint32_t to = 0;
+    uint64_t interval = 0;
+    int option = 0;
+    while((option = getopt(argc, argv, "j:c:w:s:i:")) != -1)
+    {
+        switch(option)
+        {
+            case 'j': threads = static_cast<unsigned>(atoi(optarg)); break;
+            case 'c': chunk = strtoull(optarg, nullptr, 0); break;
+            case 'w': window = static_cast<uint32_t>(atoi(optarg)); break;
+            case 's':
+                if(sscanf(optarg, "%u:%u", &from, &to) != 2) return usage(argv[0]);
+                break;
+            case 'i': interval = strtoull(optarg, nullptr, 0); break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind + 1 != argc) return usage(argv[0]);
+    if(threads < 1 || chunk < 1 || window < 1)
+    {
+        fprintf(stderr, "At least 1 thread, a chunk of 1 trace & a window of 1 sample are required.\n");
+        return 2;
+    }
+
+    // File *****************************************************************************
+    TraceFile file;
+    if(!file.open(argv[optind])) return 1;
+    const TraceFile::Header &header = file.header();
+    if(to == 0) to = header.samples;
+    if(from >= to || to > header.samples)
+    {
+        fprintf(stderr, "The traces have %u samples.\n", header.samples);
+        return 2;
+    }
+    sub_keys_t subKeys;
+    memcpy(subKeys[0], header.key, KEY_BYTES);
+    for(uint8_t i=1; i<=ROUNDS; i++)
+        AES::createRoundKey(subKeys, i);
+    const uint8_t *lastRoundKey = subKeys[ROUNDS];
+
+    printf("Traces:      %llu x %u samples of %s (%s, gain %.1f, noise %.1f), samples %u to %u\n",
+           static_cast<unsigned long long>(header.traces), header.samples, header.variant, header.model, header.gain, header.noise, from, to);
+    printf("\n    Traces  %-64s  Bytes  log2(ranks)\n", "Rank of each byte of the last round key");
+
+    // Analysis *************************************************************************
+    Correlation correlation(from, to - from, std::min(window, to - from));
+    uint64_t nextReport = interval ? interval : 1000;
+    const auto start = std::chrono::steady_clock::now();
+    for(uint64_t first=0; first<header.traces; first+=chunk)
+    {
+        const uint64_t count = std::min(chunk, header.traces - first);
+        parallel(correlation.tasks(), threads, [&](const uint32_t task) { correlation.accumulate(file, task, first, count); });
+        correlation.added(count);
+        file.release(first, count);
+
+        if(correlation.traces() < nextReport && correlation.traces() < header.traces) continue;
+        while(nextReport <= correlation.traces()) nextReport = interval ? nextReport + interval : 2*nextReport;
+        parallel(correlation.tasks(), threads, [&](const uint32_t task) { correlation.correlate(task); });
+        uint32_t recovered = 0;
+        double log2Ranks = 0;
+        printf("%10llu  ", static_cast<unsigned long long>(correlation.traces()));
+        for(uint32_t byte=0; byte<STATE_BYTES; byte++)
+        {
+            const uint32_t rank = correlation.rank(byte, lastRoundKey[byte]);
+            printf("%4u", rank);
+            recovered += (rank == 1);
+            log2Ranks += std::log2(static_cast<double>(rank));
+        }
+        printf("  %5u  %11.1f\n", recovered, log2Ranks);
+        fflush(stdout);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Results **************************************************************************
+    uint8_t guess[KEY_BYTES];
+    for(uint32_t byte=0; byte<STATE_BYTES; byte++)
+        guess[byte] = correlation.best(byte);
+    aes_key_t key;
+    invertKeySchedule(guess, key);
+    printf("\nByte  Guess  Correct  r (sample) of the correct guess  r (sample) of the best wrong guess\n");
+    for(uint32_t byte=0; byte<STATE_BYTES; byte++)
+    {
+        const Correlation::Peak correct = correlation.peak(byte, lastRoundKey[byte]);
+        Correlation::Peak wrong;
+        for(uint32_t k=0; k<GUESSES; k++)
+        {
+            const Correlation::Peak peak = correlation.peak(byte, k);
+            if(k != lastRoundKey[byte] && peak.r > wrong.r) wrong = peak;
+        }
+        printf("%4u  %5.2x  %7.2x  %6.4f (%5u)%18s%6.4f (%5u)\n", byte, guess[byte], lastRoundKey[byte],
+               correct.r, correct.sample, "", wrong.r, wrong.sample);
+    }
+    printf("\nKey:         ");
+    printHex(key, KEY_BYTES);
+    printf(memcmp(key, header.key, KEY_BYTES) == 0 ? " (recovered)\n" : " (wrong, the key is ");
+    if(memcmp(key, header.key, KEY_BYTES) != 0)
+    {
+        printHex(header.key, KEY_BYTES);
+        printf(")\n");
+    }
+    printf("Threads:     %u\n", threads);
+    printf("Time:        %.3f s\n", seconds);
+    if(seconds > 0) printf("Throughput:  %.0f traces/s\n", header.traces / seconds);
+    return 0;
+}
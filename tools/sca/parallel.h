@@ -0,0 +1,43 @@
+/**
+ * @file parallel.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the task pool & the SIMD dispatch of the trace analyses.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#define SIMD_CLONES __attribute__((target_clones("avx2", "default")))   ///< Compile a function for AVX2 & the baseline, selected at runtime
+
+/**
+ * @brief Run tasks with a pool of threads, each thread takes the next task, until none is left.
+ * @param[in] tasks (const uint32_t): Number of tasks.
+ * @param[in] threads (const unsigned): Number of threads, including the calling thread.
+ * @param[in] run (const Function&): The task, called with its index.
+ */
+template<typename Function>
+void parallel(const uint32_t tasks, const unsigned threads, const Function &run)
+{
+    std::atomic<uint32_t> nextTask(0);
+    const auto worker = [&]()
+    {
+        for(uint32_t task = nextTask++; task < tasks; task = nextTask++)
+            run(task);
+    };
+    std::vector<std::thread> pool;
+    for(unsigned i=1; i<std::min<unsigned>(threads, tasks); i++) pool.emplace_back(worker);
+    worker();
+    for(std::thread &thread : pool) thread.join();
+}
+
+#endif // PARALLEL_H
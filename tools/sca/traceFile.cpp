@@ -0,0 +1,111 @@
+#include "traceFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr uint32_t TraceFile::VERSION;
+constexpr size_t TraceFile::ALIGNMENT;
+constexpr uint32_t TraceFile::FLAG_GROUPS;
+constexpr char TraceFile::MAGIC[8];
+
+static_assert(sizeof(TraceFile::Header) == 256, "The header of a trace file has 256 bytes.");
+
+namespace
+{
+    /**
+     * @brief Round @p offset up to the next multiple of TraceFile::ALIGNMENT.
+     * @param[in] offset (const uint64_t): The offset.
+     * @return (uint64_t): The aligned offset.
+     */
+    uint64_t align(const uint64_t offset)
+    {
+        return (offset + TraceFile::ALIGNMENT - 1) / TraceFile::ALIGNMENT * TraceFile::ALIGNMENT;
+    }
+}
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+TraceFile::~TraceFile()
+{
+    if(mData) munmap(mData, mSize);
+    if(mFd >= 0) close(mFd);
+}
+
+bool TraceFile::create(const char *path, const Header &header)
+{
+    Header complete = header;
+    memcpy(complete.magic, MAGIC, sizeof(MAGIC));
+    complete.version = VERSION;
+    complete.samplesOffset = align(sizeof(Header));
+    complete.ciphertextOffset = align(complete.samplesOffset + complete.traces * complete.samples);
+    complete.plaintextOffset = align(complete.ciphertextOffset + complete.traces * 16);
+    complete.groupOffset = (complete.flags & FLAG_GROUPS) ? align(complete.plaintextOffset + complete.traces * 16) : 0;
+    mSize = (complete.flags & FLAG_GROUPS) ? complete.groupOffset + complete.traces : complete.plaintextOffset + complete.traces * 16;
+
+    mFd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(mFd < 0 || ftruncate(mFd, static_cast<off_t>(mSize)) != 0)
+    {
+        perror(path);
+        return false;
+    }
+    if(!map(path, PROT_READ | PROT_WRITE, MAP_SHARED)) return false;
+    memcpy(mData, &complete, sizeof(Header));
+    return true;
+}
+
+bool TraceFile::open(const char *path)
+{
+    mFd = ::open(path, O_RDONLY);
+    struct stat info;
+    if(mFd < 0 || fstat(mFd, &info) != 0)
+    {
+        perror(path);
+        return false;
+    }
+    mSize = static_cast<size_t>(info.st_size);
+    if(mSize < sizeof(Header))
+    {
+        fprintf(stderr, "%s is no trace file.\n", path);
+        return false;
+    }
+    if(!map(path, PROT_READ, MAP_SHARED)) return false;
+
+    const Header &file = header();
+    const uint64_t end = file.groupOffset ? file.groupOffset + file.traces : file.plaintextOffset + file.traces * 16;
+    if(memcmp(file.magic, MAGIC, sizeof(MAGIC)) != 0 || file.version != VERSION || end > mSize
+       || file.samplesOffset + file.traces * file.samples > file.ciphertextOffset)
+    {
+        fprintf(stderr, "%s is no trace file of version %u.\n", path, VERSION);
+        return false;
+    }
+    madvise(mData, mSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+void TraceFile::release(const uint64_t first, const uint64_t count) const
+{
+    // Only whole pages can be dropped
+    const uint64_t begin = align(header().samplesOffset + first * header().samples);
+    const uint64_t end = (header().samplesOffset + (first + count) * header().samples) / ALIGNMENT * ALIGNMENT;
+    if(end > begin) madvise(mData + begin, end - begin, MADV_DONTNEED);
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+bool TraceFile::map(const char *path, const int protection, const int flags)
+{
+    void *data = mmap(nullptr, mSize, protection, flags, mFd, 0);
+    if(data == MAP_FAILED)
+    {
+        perror(path);
+        return false;
+    }
+    mData = static_cast<uint8_t*>(data);
+    return true;
+}
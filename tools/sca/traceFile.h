@@ -0,0 +1,121 @@
+/**
+ * @file traceFile.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the TraceFile class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Class for memory-mapped files of power traces of the AES decryption, e.g. of `traceGen`.
+ *
+ * A trace file consists of the Header & the columns of all traces, each aligned to #ALIGNMENT bytes:
+ * -# The samples: `traces` rows of `samples` signed 8-bit samples, like an oscilloscope with an 8-bit ADC.
+ * -# The ciphertexts, the input of each decryption (16 bytes per trace).
+ * -# The plaintexts, the output of each decryption (16 bytes per trace).
+ * -# Optionally the group of each trace (1 byte per trace), e.g. 0 for the fixed & 1 for the random input of TVLA.
+ *
+ * The byte offsets of the columns are in the Header, all values are in the byte order of the host.
+ * A reader maps the file read-only & lets the kernel page the samples in & out (see release()),
+ * so a file can be much larger than the memory.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class TraceFile
+{
+public:
+    static constexpr uint32_t VERSION       = 1;        ///< Version of the file format
+    static constexpr size_t ALIGNMENT       = 4096;     ///< Alignment of the columns, a page
+    static constexpr uint32_t FLAG_GROUPS   = 0x01;     ///< Header::flags: The file has a group column
+
+    /**
+     * @brief Header of a trace file, 256 bytes.
+     */
+    struct Header
+    {
+        char magic[8];              ///< "T0TRACE"
+        uint32_t version;           ///< #VERSION
+        uint32_t flags;             ///< #FLAG_GROUPS
+        uint64_t traces;            ///< Number of traces
+        uint32_t samples;           ///< Number of samples per trace
+        float gain;                 ///< Sample units per unit of the leakage model
+        float noise;                ///< Standard deviation of the Gaussian noise in sample units
+        uint32_t reserved0;         ///< 0
+        uint64_t samplesOffset;     ///< Byte offset of the samples
+        uint64_t ciphertextOffset;  ///< Byte offset of the ciphertexts
+        uint64_t plaintextOffset;   ///< Byte offset of the plaintexts
+        uint64_t groupOffset;       ///< Byte offset of the groups, 0 without #FLAG_GROUPS
+        uint8_t key[16];            ///< AES key of the decryptions
+        char variant[32];           ///< Countermeasures of the firmware, e.g. "masking_shuffling"
+        char model[16];             ///< Leakage model, e.g. "hw"
+        uint8_t reserved[120];      ///< 0
+    };
+
+    TraceFile() = default;
+    TraceFile(const TraceFile&) = delete;
+    TraceFile &operator=(const TraceFile&) = delete;
+
+    /**
+     * @brief Unmap & close the file.
+     */
+    ~TraceFile();
+
+    /**
+     * @brief Create a trace file & map it writable.
+     *
+     * The offsets of the columns are computed from the other fields of @p header.
+     * @param[in] path (const char*): Path of the file.
+     * @param[in] header (const Header&): The header.
+     * @return (bool): Whether the file was created, an error was printed otherwise.
+     */
+    bool create(const char *path, const Header &header);
+
+    /**
+     * @brief Open a trace file & map it read-only.
+     * @param[in] path (const char*): Path of the file.
+     * @return (bool): Whether the file is a valid trace file, an error was printed otherwise.
+     */
+    bool open(const char *path);
+
+    /**
+     * @brief Let the kernel drop the samples of traces, that have been processed, from the memory.
+     * @param[in] first (const uint64_t): First trace.
+     * @param[in] count (const uint64_t): Number of traces.
+     */
+    void release(const uint64_t first, const uint64_t count) const;
+
+    const Header &header() const { return *reinterpret_cast<const Header*>(mData); }
+    int8_t *samples(const uint64_t trace) const { return reinterpret_cast<int8_t*>(mData + header().samplesOffset + trace * header().samples); }
+    uint8_t *ciphertext(const uint64_t trace) const { return mData + header().ciphertextOffset + trace * 16; }
+    uint8_t *plaintext(const uint64_t trace) const { return mData + header().plaintextOffset + trace * 16; }
+    uint8_t *group(const uint64_t trace) const { return header().groupOffset ? mData + header().groupOffset + trace : nullptr; }
+
+private:
+    static constexpr char MAGIC[8] = {'T', '0', 'T', 'R', 'A', 'C', 'E', '\0'};  ///< Magic number of a trace file
+
+    int mFd = -1;               ///< File descriptor
+    size_t mSize = 0;           ///< Size of the file
+    uint8_t *mData = nullptr;   ///< The mapped file
+
+    /**
+     * @brief Map the whole file.
+     * @param[in] path (const char*): Path of the file, for errors.
+     * @param[in] protection (const int): Protection of the mapping.
+     * @param[in] flags (const int): Flags of the mapping.
+     * @return (bool): Whether the file was mapped.
+     */
+    bool map(const char *path, const int protection, const int flags);
+};
+
+#endif // TRACE_FILE_H
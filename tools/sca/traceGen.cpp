@@ -0,0 +1,327 @@
+/**
+ * @file traceGen.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Generate simulated power traces of the firmware's AES decryption with a leakage model.
+ *
+ * Usage: `traceGen_<variant> [-n traces] [-m hw|hd|lsb] [-g gain] [-s noise] [-k key] [-r seed] [-j workers] [-f] <output>`
+ *
+ * The firmware is built with LEAKAGE & the countermeasures of the variant, so every intermediate of
+ * AES::addRoundKey(), AES::invMixCols() & AES::invByteSub() becomes one sample (see Leakage), in the order of
+ * the writes. Each NOP of a dummy op becomes a sample without data-dependent leakage. A sample is
+ * `gain * (model - mean of the model) + noise`, rounded to 8 bits, with Gaussian noise. The models are:
+ * - `hw` (default): Hamming weight of the new value.
+ * - `hd`: Hamming distance of the old & the new value.
+ * - `lsb`: Least significant bit of the new value.
+ *
+ * The traces are written to a TraceFile with random ciphertexts (or, with `-f`, a random choice of a fixed &
+ * a random ciphertext for TVLA, see TraceFile::group()). They are generated in chunks of #CHUNK_TRACES traces by a
+ * pool of worker processes (default: one per core), directly into the memory-mapped file. Each chunk has its own
+ * random source for the ciphertexts, the noise & the ADC of the RNG, so the file only depends on `-r` (default 1).
+ * The key defaults to the default key of slot 0, 1000000 traces are generated by default.
+ *
+ * The firmware's state, including the emulated hardware, is global, so the workers are processes, not threads.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "aes.h"
+#include "keyStore.h"
+#include "leakage.h"
+#include "traceFile.h"
+
+#ifndef VARIANT
+#define VARIANT "plain"     ///< Name of the countermeasure combination, set by CMake
+#endif
+
+namespace
+{
+    constexpr uint64_t CHUNK_TRACES = 1024;     ///< Traces per chunk of a worker
+
+    /// Fixed ciphertext of the fixed group with `-f`
+    const uint8_t FIXED_CIPHERTEXT[STATE_BYTES] = {0xda, 0x39, 0xa3, 0xee, 0x5e, 0x6b, 0x4b, 0x0d, 0x32, 0x55, 0xbf, 0xef, 0x95, 0x60, 0x18, 0x90};
+
+    /**
+     * @brief A leakage model.
+     */
+    struct Model
+    {
+        const char *name;                                           ///< Name of the model
+        float (*leak)(const uint8_t before, const uint8_t after);   ///< Leakage of a written intermediate
+        float mean;                                                 ///< Mean leakage of a uniform intermediate
+    };
+
+    const Model MODELS[] =
+    {
+        {"hw",  [](const uint8_t, const uint8_t after) { return static_cast<float>(__builtin_popcount(after)); }, 4.0f},
+        {"hd",  [](const uint8_t before, const uint8_t after) { return static_cast<float>(__builtin_popcount(before ^ after)); }, 4.0f},
+        {"lsb", [](const uint8_t, const uint8_t after) { return static_cast<float>(after & 1); }, 0.5f}
+    };
+
+    /**
+     * @brief State of the trace, that is generated by this process. The Leakage hooks have no context.
+     */
+    struct Generator
+    {
+        const Model *model = &MODELS[0];                ///< The leakage model
+        float gain = 8;                                 ///< Sample units per unit of the model
+        std::normal_distribution<float> noise{0, 4};    ///< Noise in sample units
+        std::mt19937 random;                            ///< Random source of the chunk
+        std::mt19937 adc;                               ///< Random source of the emulated ADC
+        int8_t *row = nullptr;                          ///< Samples of the trace, nullptr to only count them
+        uint32_t length = 0;                            ///< Number of samples per trace
+        uint32_t position = 0;                          ///< Next sample of the trace
+    } gGenerator;
+
+    /**
+     * @brief Append a sample to the trace.
+     * @param[in] leakage (const float): The leakage of the model.
+     */
+    void sample(const float leakage)
+    {
+        Generator &g = gGenerator;
+        if(g.row && g.position < g.length)
+        {
+            const float value = std::round(g.gain * (leakage - g.model->mean) + g.noise(g.random));
+            g.row[g.position] = static_cast<int8_t>(std::max(-128.0f, std::min(127.0f, value)));
+        }
+        g.position++;
+    }
+
+    /**
+     * @brief Leakage::onWrite hook.
+     */
+    void leakWrite(const uint8_t before, const uint8_t after)
+    {
+        sample(gGenerator.model->leak(before, after));
+    }
+
+    /**
+     * @brief Leakage::onIdle hook, a NOP leaks the mean.
+     */
+    void leakIdle(const uint8_t nops)
+    {
+        for(uint8_t i=0; i<nops; i++)
+            sample(gGenerator.model->mean);
+    }
+
+    /**
+     * @brief Finish an ADC conversion as soon as it is started, with noise of the chunk's random source in the LSBs.
+     * @param[in] reg (HostRegister<uint8_t>&): ADCSRA.
+     */
+    void convert(HostRegister<uint8_t> &reg)
+    {
+        if(!(reg.value & (1<<ADSC))) return;
+        HostHardware::adcL.value = static_cast<uint8_t>(0x80 | (gGenerator.adc() & 0x0f));
+        HostHardware::adcH.value = 0x01;
+        reg.value = static_cast<uint8_t>((reg.value & ~(1<<ADSC)) | (1<<ADIF));
+    }
+
+    /**
+     * @brief Generate the traces of a chunk.
+     * @param[in] file (const TraceFile&): The mapped trace file, the traces of the chunk are written to it.
+     * @param[in] chunk (const uint64_t): Index of the chunk.
+     * @param[in] seed (const uint32_t): Seed of the file.
+     * @return (uint64_t): Number of traces, that had more samples than the file.
+     */
+    uint64_t generate(const TraceFile &file, const uint64_t chunk, const uint32_t seed)
+    {
+        Generator &g = gGenerator;
+        std::seed_seq sequence{seed, static_cast<uint32_t>(chunk), static_cast<uint32_t>(chunk >> 32)};
+        g.random.seed(sequence);
+        g.adc.seed(g.random());
+
+        AES aes;
+        aes.selectKey(0);
+        uint64_t overflows = 0;
+        const uint64_t end = std::min(file.header().traces, (chunk + 1) * CHUNK_TRACES);
+        for(uint64_t trace = chunk * CHUNK_TRACES; trace < end; trace++)
+        {
+            uint8_t *cipher = file.ciphertext(trace);
+            const bool fixed = file.group(trace) && (g.random() & 1) == 0;
+            if(file.group(trace)) *file.group(trace) = fixed ? 0 : 1;
+            if(fixed)
+                memcpy(cipher, FIXED_CIPHERTEXT, STATE_BYTES);
+            else
+                for(uint8_t i=0; i<STATE_BYTES; i++) cipher[i] = static_cast<uint8_t>(g.random());
+
+            uint8_t *plain = file.plaintext(trace);
+            memcpy(plain, cipher, STATE_BYTES);
+            g.row = file.samples(trace);
+            g.position = 0;
+            aes.decrypt(plain);
+            if(g.position > g.length) overflows++;
+            // Pad shorter traces with idle samples
+            while(g.position < g.length) sample(g.model->mean);
+        }
+        g.row = nullptr;
+        return overflows;
+    }
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-n traces] [-m hw|hd|lsb] [-g gain] [-s noise] [-k key] [-r seed] [-j workers] [-f] <output>\n", name);
+        return 2;
+    }
+
+    /**
+     * @brief Parse a key of 32 hex digits.
+     * @param[in] text (const char*): The key.
+     * @param[out] key ( @ref aes_key_t): The parsed key.
+     * @return (bool): Whether @p text is a valid key.
+     */
+    bool parseKey(const char *text, aes_key_t key)
+    {
+        if(strlen(text) != 2*KEY_BYTES) return false;
+        for(uint8_t i=0; i<KEY_BYTES; i++)
+        {
+            char digits[3] = {text[2*i], text[2*i + 1], '\0'};
+            char *end = nullptr;
+            key[i] = static_cast<uint8_t>(strtoul(digits, &end, 16));
+            if(*end != '\0') return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Generator &g = gGenerator;
+    uint64_t traces = 1000000;
+    float noise = 4;
+    aes_key_t key;
+    memcpy(key, KeyStore::DEFAULT_KEY, KEY_BYTES);
+    uint32_t seed = 1;
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    bool groups = false;
+    int option = 0;
+    while((option = getopt(argc, argv, "n:m:g:s:k:r:j:f")) != -1)
+    {
+        switch(option)
+        {
+            case 'n': traces = strtoull(optarg, nullptr, 0); break;
+            case 'm':
+            {
+                const auto model = std::find_if(std::begin(MODELS), std::end(MODELS), [](const Model &m) { return strcmp(m.name, optarg) == 0; });
+                if(model == std::end(MODELS)) return usage(argv[0]);
+                g.model = model;
+            }
+            break;
+            case 'g': g.gain = strtof(optarg, nullptr); break;
+            case 's': noise = strtof(optarg, nullptr); break;
+            case 'k':
+                if(!parseKey(optarg, key))
+                {
+                    fprintf(stderr, "The key has to be 32 hex digits.\n");
+                    return 2;
+                }
+                break;
+            case 'r': seed = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)); break;
+            case 'j': workers = static_cast<unsigned>(atoi(optarg)); break;
+            case 'f': groups = true; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind + 1 != argc) return usage(argv[0]);
+    if(traces < 1 || workers < 1 || noise < 0)
+    {
+        fprintf(stderr, "At least 1 trace, 1 worker & a noise of at least 0 are required.\n");
+        return 2;
+    }
+    g.noise = std::normal_distribution<float>(0, noise);
+
+    // Firmware *************************************************************************
+    HostHardware::adcsrA.onWrite = convert;
+    Leakage::onWrite = leakWrite;
+    Leakage::onIdle = leakIdle;
+    KeyStore::init(key);
+    while(KeyStore::loadStep(nullptr));
+
+    // Count the samples of a decryption. The dummy ops always add up to the same number of NOPs.
+    AES probe;
+    probe.selectKey(0);
+    uint8_t block[STATE_BYTES] = {};
+    probe.decrypt(block);
+    g.length = g.position;
+
+    // File *****************************************************************************
+    TraceFile::Header header;
+    memset(&header, 0, sizeof(header));
+    header.flags = groups ? TraceFile::FLAG_GROUPS : 0;
+    header.traces = traces;
+    header.samples = g.length;
+    header.gain = g.gain;
+    header.noise = noise;
+    memcpy(header.key, key, KEY_BYTES);
+    strncpy(header.variant, VARIANT, sizeof(header.variant) - 1);
+    strncpy(header.model, g.model->name, sizeof(header.model) - 1);
+    TraceFile file;
+    if(!file.create(argv[optind], header)) return 1;
+
+    // Generation ***********************************************************************
+    // Worker w generates the chunks w, w + workers, ... into the shared mapping
+    const uint64_t chunks = (traces + CHUNK_TRACES - 1) / CHUNK_TRACES;
+    workers = static_cast<unsigned>(std::min<uint64_t>(workers, chunks));
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> pool;
+    for(unsigned w=0; w<workers; w++)
+    {
+        fflush(nullptr);
+        const pid_t pid = fork();
+        if(pid < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+        if(pid == 0)
+        {
+            uint64_t overflows = 0;
+            for(uint64_t chunk=w; chunk<chunks; chunk+=workers)
+                overflows += generate(file, chunk, seed);
+            if(overflows) fprintf(stderr, "%llu traces had more than %u samples & were cut.\n", static_cast<unsigned long long>(overflows), g.length);
+            _exit(0);
+        }
+        pool.push_back(pid);
+    }
+    bool ok = true;
+    for(const pid_t pid : pool)
+    {
+        int status = 0;
+        ok = waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0 && ok;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(!ok)
+    {
+        fprintf(stderr, "A worker failed.\n");
+        return 1;
+    }
+
+    // Results **************************************************************************
+    const uint64_t bytes = traces * (g.length + 2*STATE_BYTES + groups);
+    printf("Variant:     %s\n", VARIANT);
+    printf("Model:       %s (gain %.1f, noise %.1f)\n", g.model->name, g.gain, noise);
+    printf("Traces:      %llu x %u samples%s\n", static_cast<unsigned long long>(traces), g.length, groups ? " (fixed vs. random)" : "");
+    printf("Size:        %.1f MiB\n", bytes / (1024.0*1024.0));
+    printf("Workers:     %u\n", workers);
+    printf("Time:        %.3f s\n", seconds);
+    if(seconds > 0) printf("Throughput:  %.0f traces/s\n", traces / seconds);
+    return 0;
+}
@@ -0,0 +1,405 @@
+/**
+ * @file tvla.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Assess the leakage of a trace file with a fixed vs. random test vector leakage assessment (TVLA).
+ *
+ * Usage: `tvla [-o order] [-t threshold] [-a] [-j threads] [-c chunk] [-w window] [-s from:to] [-i interval] <traces>`
+ *
+ * The trace file needs the groups of the fixed & the random ciphertexts, e.g. from `traceGen -f` or from a capture.
+ * For each sample, Welch's t-test compares the two groups at the orders 1 to `-o` (default 2, at most 3):
+ * - Order 1: The means.
+ * - Order 2: The variances, i.e. the means of the squared centred samples. This detects the leakage of MASKING.
+ * - Order 3: The skewnesses, i.e. the means of the cubed standardised samples.
+ *
+ * The traces are streamed in chunks of `-c` traces (default 4096) in a single pass: The mean & the centred moments up
+ * to twice the order of each sample & group are updated with each trace with the numerically stable formulas of
+ * Welford & Pébay, so the moments of the squared or cubed samples don't suffer from cancellation. The samples are split
+ * into windows of `-w` samples (default 256), which a pool of threads (default: one per core) updates. The loops
+ * over the samples of a window are compiled for AVX2 & for the baseline of the CPU, the faster one is selected at runtime.
+ *
+ * The maximum |t| of each order & window is printed, whenever the number of traces has doubled since 1000 traces or,
+ * with `-i`, every `interval` traces. The test stops at the first report, where |t| exceeds `-t` (default 4.5),
+ * unless `-a` analyses all traces. `-s` restricts the test to the samples from `from` to `to` (exclusive).
+ * The exit code is 1, if |t| exceeded the threshold.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "parallel.h"
+#include "traceFile.h"
+
+namespace
+{
+    constexpr uint32_t MAX_ORDER = 3;                   ///< Highest order of the test
+    constexpr uint32_t MAX_MOMENT = 2*MAX_ORDER;        ///< Highest centred moment
+    constexpr uint32_t GROUPS = 2;                      ///< Fixed (0) & random (1) group
+
+    /// Binomial coefficients up to #MAX_MOMENT
+    constexpr double BINOMIALS[MAX_MOMENT+1][MAX_MOMENT+1] =
+    {
+        {1},
+        {1, 1},
+        {1, 2, 1},
+        {1, 3, 3, 1},
+        {1, 4, 6, 4, 1},
+        {1, 5, 10, 10, 5, 1},
+        {1, 6, 15, 20, 15, 6, 1}
+    };
+
+    /**
+     * @brief Moments of the samples of a group, the centred moments are sums, not divided by the count.
+     */
+    struct Moments
+    {
+        std::vector<double> mean;                       ///< Mean of each sample
+        std::vector<double> centred[MAX_MOMENT+1];      ///< Sum of the centred powers 2 to #MAX_MOMENT of each sample
+    };
+
+    /**
+     * @brief Add a trace to the moments of its group, with @p MOMENTS centred moments.
+     *
+     * The sums M_p of the centred powers are updated from the highest to the lowest one (Pébay, 2008):
+     * `M_p += sum over k=1..p-2 of C(p,k) * M_(p-k) * (-delta/n)^k + ((n-1)/n * delta)^p * (1 - (-1/(n-1))^(p-1))`
+     * with the new count n & the difference delta of the sample & the old mean.
+     * @param[inout] moments (Moments&): The moments of the group, with at least one trace.
+     * @param[in] count (const uint64_t): The count of the group including the trace, at least 2.
+     * @param[in] samples (const int8_t*): The samples of the window.
+     * @param[in] begin (const uint32_t): First sample of the window in the moments.
+     * @param[in] n (const uint32_t): Number of samples of the window.
+     */
+    template<uint32_t MOMENTS>
+    inline __attribute__((always_inline)) void update(Moments &moments, const uint64_t count, const int8_t *__restrict samples,
+                                                      const uint32_t begin, const uint32_t n)
+    {
+        const double scale = static_cast<double>(count - 1) / count;
+        double corrections[MOMENTS+1];
+        for(uint32_t p=2; p<=MOMENTS; p++)
+            corrections[p] = 1 - std::pow(-1.0 / (count - 1), p - 1);
+        double *__restrict mean = &moments.mean[begin];
+        double *__restrict m[MOMENTS+1];
+        for(uint32_t p=2; p<=MOMENTS; p++)
+            m[p] = &moments.centred[p][begin];
+
+        for(uint32_t t=0; t<n; t++)
+        {
+            const double delta = samples[t] - mean[t];
+            const double step = -delta / count;
+            const double scaled = scale * delta;
+            double old[MOMENTS+1];
+            for(uint32_t p=2; p<=MOMENTS; p++)
+                old[p] = m[p][t];
+            double scaledPower = scaled;
+            for(uint32_t p=2; p<=MOMENTS; p++)
+            {
+                scaledPower *= scaled;
+                double sum = old[p] + scaledPower * corrections[p];
+                double stepPower = 1;
+                for(uint32_t k=1; k+2<=p; k++)
+                {
+                    stepPower *= step;
+                    sum += BINOMIALS[p][k] * old[p-k] * stepPower;
+                }
+                m[p][t] = sum;
+            }
+            mean[t] -= step;
+        }
+    }
+
+    /// update() with the moments of the orders 1 to 3
+    SIMD_CLONES void update2(Moments &moments, const uint64_t count, const int8_t *samples, const uint32_t begin, const uint32_t n) { update<2>(moments, count, samples, begin, n); }
+    SIMD_CLONES void update4(Moments &moments, const uint64_t count, const int8_t *samples, const uint32_t begin, const uint32_t n) { update<4>(moments, count, samples, begin, n); }
+    SIMD_CLONES void update6(Moments &moments, const uint64_t count, const int8_t *samples, const uint32_t begin, const uint32_t n) { update<6>(moments, count, samples, begin, n); }
+
+    /**
+     * @brief Streaming fixed vs. random t-test of all samples.
+     */
+    class TTest
+    {
+    public:
+        /**
+         * @brief The largest |t| of an order within a window.
+         */
+        struct Peak
+        {
+            double t = 0;           ///< |t|
+            uint32_t sample = 0;    ///< Sample of |t|
+        };
+
+        /**
+         * @brief Allocate the moments.
+         * @param[in] from (const uint32_t): First sample of the test.
+         * @param[in] samples (const uint32_t): Number of samples of the test.
+         * @param[in] window (const uint32_t): Samples per task.
+         * @param[in] order (const uint32_t): Highest order of the test.
+         */
+        TTest(const uint32_t from, const uint32_t samples, const uint32_t window, const uint32_t order)
+            : mFrom(from), mSamples(samples), mWindow(window), mWindows((samples + window - 1) / window), mOrder(order),
+              mPeaks(static_cast<size_t>(order) * mWindows)
+        {
+            for(Moments &moments : mMoments)
+            {
+                moments.mean.resize(samples);
+                for(uint32_t p=2; p<=2*order; p++)
+                    moments.centred[p].resize(samples);
+            }
+        }
+
+        uint32_t tasks() const { return mWindows; }
+        uint32_t windows() const { return mWindows; }
+        uint32_t window() const { return mWindow; }
+        uint64_t traces() const { return mCounts[0] + mCounts[1]; }
+        uint64_t count(const uint32_t group) const { return mCounts[group]; }
+
+        /**
+         * @brief Add traces to the moments of a window.
+         * @param[in] file (const TraceFile&): The trace file.
+         * @param[in] window (const uint32_t): Index of the window.
+         * @param[in] first (const uint64_t): First trace.
+         * @param[in] count (const uint64_t): Number of traces.
+         */
+        void accumulate(const TraceFile &file, const uint32_t window, const uint64_t first, const uint64_t count)
+        {
+            const uint32_t begin = window * mWindow;
+            const uint32_t n = std::min(mWindow, mSamples - begin);
+            // Each window counts the traces itself, the counts are only updated after all windows (see added())
+            uint64_t counts[GROUPS] = {mCounts[0], mCounts[1]};
+            for(uint64_t trace=first; trace<first+count; trace++)
+            {
+                const uint8_t group = *file.group(trace) ? 1 : 0;
+                const int8_t *samples = file.samples(trace) + mFrom + begin;
+                Moments &moments = mMoments[group];
+                if(++counts[group] == 1)
+                {
+                    std::copy(samples, samples + n, &moments.mean[begin]);
+                    continue;
+                }
+                switch(mOrder)
+                {
+                    case 1: update2(moments, counts[group], samples, begin, n); break;
+                    case 2: update4(moments, counts[group], samples, begin, n); break;
+                    default: update6(moments, counts[group], samples, begin, n); break;
+                }
+            }
+        }
+
+        /**
+         * @brief Count the traces, that all windows have added.
+         * @param[in] file (const TraceFile&): The trace file.
+         * @param[in] first (const uint64_t): First trace.
+         * @param[in] count (const uint64_t): Number of traces.
+         */
+        void added(const TraceFile &file, const uint64_t first, const uint64_t count)
+        {
+            for(uint64_t trace=first; trace<first+count; trace++)
+                mCounts[*file.group(trace) ? 1 : 0]++;
+        }
+
+        /**
+         * @brief Compute the t-statistics of all orders in a window & keep the largest |t| of each.
+         * @param[in] window (const uint32_t): Index of the window.
+         */
+        void test(const uint32_t window)
+        {
+            const uint32_t begin = window * mWindow;
+            const uint32_t n = std::min(mWindow, mSamples - begin);
+            for(uint32_t order=1; order<=mOrder; order++)
+            {
+                Peak &peak = mPeaks[(order - 1) * mWindows + window];
+                peak = Peak();
+                if(mCounts[0] < 2 || mCounts[1] < 2) continue;
+                for(uint32_t t=begin; t<begin+n; t++)
+                {
+                    double mean[GROUPS];
+                    double variance[GROUPS];
+                    for(uint32_t group=0; group<GROUPS; group++)
+                        statistics(group, order, t, mean[group], variance[group]);
+                    const double deviation = std::sqrt(variance[0] / mCounts[0] + variance[1] / mCounts[1]);
+                    if(!(deviation > 0)) continue;
+                    const double value = std::fabs(mean[0] - mean[1]) / deviation;
+                    if(value > peak.t)
+                    {
+                        peak.t = value;
+                        peak.sample = mFrom + t;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Get the largest |t| of an order in a window, after test().
+         * @param[in] order (const uint32_t): The order.
+         * @param[in] window (const uint32_t): Index of the window.
+         * @return (const Peak&): The largest |t|.
+         */
+        const Peak &peak(const uint32_t order, const uint32_t window) const { return mPeaks[(order - 1) * mWindows + window]; }
+
+    private:
+        const uint32_t mFrom;               ///< First sample of the test
+        const uint32_t mSamples;            ///< Number of samples of the test
+        const uint32_t mWindow;             ///< Samples per task
+        const uint32_t mWindows;            ///< Number of windows
+        const uint32_t mOrder;              ///< Highest order of the test
+        uint64_t mCounts[GROUPS] = {};      ///< Traces per group
+        Moments mMoments[GROUPS];           ///< Moments per group
+        std::vector<Peak> mPeaks;           ///< Largest |t| per order & window
+
+        /**
+         * @brief Get the mean & the variance of the preprocessed samples of an order.
+         * @param[in] group (const uint32_t): The group.
+         * @param[in] order (const uint32_t): The order.
+         * @param[in] t (const uint32_t): The sample.
+         * @param[out] mean (double&): The mean.
+         * @param[out] variance (double&): The variance.
+         */
+        void statistics(const uint32_t group, const uint32_t order, const uint32_t t, double &mean, double &variance) const
+        {
+            const Moments &moments = mMoments[group];
+            const double count = static_cast<double>(mCounts[group]);
+            const auto centred = [&](const uint32_t p) { return moments.centred[p][t] / count; };
+            if(order == 1)
+            {
+                mean = moments.mean[t];
+                variance = centred(2);
+            }
+            else if(order == 2)
+            {
+                mean = centred(2);
+                variance = centred(4) - mean * mean;
+            }
+            else
+            {
+                // Standardised moments, so the variance of the samples doesn't leak into the higher order
+                const double deviation = std::sqrt(centred(2));
+                const double power = std::pow(deviation, order);
+                mean = power > 0 ? centred(order) / power : 0;
+                variance = power > 0 ? (centred(2*order) - centred(order) * centred(order)) / (power * power) : 0;
+            }
+        }
+    };
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-o order] [-t threshold] [-a] [-j threads] [-c chunk] [-w window] [-s from:to] [-i interval] <traces>\n", name);
+        return 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t order = 2;
+    double threshold = 4.5;
+    bool all = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t chunk = 4096;
+    uint32_t window = 256;
+    uint32_t from = 0;
+    uint32_t to = 0;
+    uint64_t interval = 0;
+    int option = 0;
+    while((option = getopt(argc, argv, "o:t:aj:c:w:s:i:")) != -1)
+    {
+        switch(option)
+        {
+            case 'o': order = static_cast<uint32_t>(atoi(optarg)); break;
+            case 't': threshold = strtod(optarg, nullptr); break;
+            case 'a': all = true; break;
+            case 'j': threads = static_cast<unsigned>(atoi(optarg)); break;
+            case 'c': chunk = strtoull(optarg, nullptr, 0); break;
+            case 'w': window = static_cast<uint32_t>(atoi(optarg)); break;
+            case 's':
+                if(sscanf(optarg, "%u:%u", &from, &to) != 2) return usage(argv[0]);
+                break;
+            case 'i': interval = strtoull(optarg, nullptr, 0); break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind + 1 != argc) return usage(argv[0]);
+    if(order < 1 || order > MAX_ORDER || threads < 1 || chunk < 1 || window < 1)
+    {
+        fprintf(stderr, "An order of 1 to %u, at least 1 thread, a chunk of 1 trace & a window of 1 sample are required.\n", MAX_ORDER);
+        return 2;
+    }
+
+    // File *****************************************************************************
+    TraceFile file;
+    if(!file.open(argv[optind])) return 1;
+    const TraceFile::Header &header = file.header();
+    if(!(header.flags & TraceFile::FLAG_GROUPS))
+    {
+        fprintf(stderr, "%s has no fixed & random groups, e.g. generate it with traceGen -f.\n", argv[optind]);
+        return 1;
+    }
+    if(to == 0) to = header.samples;
+    if(from >= to || to > header.samples)
+    {
+        fprintf(stderr, "The traces have %u samples.\n", header.samples);
+        return 2;
+    }
+
+    printf("Traces:      %llu x %u samples of %s (%s, gain %.1f, noise %.1f), samples %u to %u\n",
+           static_cast<unsigned long long>(header.traces), header.samples, header.variant, header.model, header.gain, header.noise, from, to);
+    TTest test(from, to - from, std::min(window, to - from), order);
+    printf("\n    Traces  Order  max |t| (sample)  max |t| per window of %u samples\n", test.window());
+
+    // Test *****************************************************************************
+    uint64_t nextReport = interval ? interval : 1000;
+    TTest::Peak leak;
+    uint32_t leakOrder = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(uint64_t first=0; first<header.traces && (all || !leakOrder); first+=chunk)
+    {
+        const uint64_t count = std::min(chunk, header.traces - first);
+        parallel(test.tasks(), threads, [&](const uint32_t window) { test.accumulate(file, window, first, count); });
+        test.added(file, first, count);
+        file.release(first, count);
+
+        if(test.traces() < nextReport && test.traces() < header.traces) continue;
+        while(nextReport <= test.traces()) nextReport = interval ? nextReport + interval : 2*nextReport;
+        parallel(test.tasks(), threads, [&](const uint32_t window) { test.test(window); });
+        for(uint32_t o=1; o<=order; o++)
+        {
+            TTest::Peak max;
+            for(uint32_t w=0; w<test.windows(); w++)
+                if(test.peak(o, w).t > max.t) max = test.peak(o, w);
+            printf("%10llu  %5u  %7.2f (%6u) ", static_cast<unsigned long long>(test.traces()), o, max.t, max.sample);
+            for(uint32_t w=0; w<test.windows(); w++)
+                printf(" %6.2f", test.peak(o, w).t);
+            printf("\n");
+            if(!leakOrder && max.t > threshold)
+            {
+                leak = max;
+                leakOrder = o;
+            }
+        }
+        fflush(stdout);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Results **************************************************************************
+    printf("\nGroups:      %llu fixed, %llu random\n", static_cast<unsigned long long>(test.count(0)), static_cast<unsigned long long>(test.count(1)));
+    if(leakOrder)
+        printf("Leakage:     order %u at sample %u, |t| = %.2f > %.1f%s\n", leakOrder, leak.sample, leak.t, threshold, all ? "" : " (stopped early)");
+    else
+        printf("Leakage:     none, |t| <= %.1f up to order %u\n", threshold, order);
+    printf("Threads:     %u\n", threads);
+    printf("Time:        %.3f s\n", seconds);
+    if(seconds > 0) printf("Throughput:  %.0f traces/s\n", test.traces() / seconds);
+    return leakOrder ? 1 : 0;
+}
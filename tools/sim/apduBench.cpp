@@ -0,0 +1,171 @@
+/**
+ * @file apduBench.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Measure the end-to-end latency & the throughput of block decryptions in simavr.
+ *
+ * Usage: `apduBench [-n blocks] [-e sendErrorRate] [-r receiveErrorRate] [-s seed] [-t trace] <firmware.elf>`
+ *
+ * The Terminal receives the ATR & decrypts `blocks` (default 64) different blocks back to back,
+ * each with a DECRYPT (`DATA_IN_HEADER`) & a GET RESPONSE command, as fast as the guard times allow.
+ * The latency of a block is measured from the first header byte of the DECRYPT command to the last status word
+ * of the GET RESPONSE command. The first block, which also reads the key schedule, is reported separately.
+ * The tool also reports the start-bit latency of the card, i.e. the cycles from the falling edge of each start bit
+ * of the Terminal to the timer start in the pin-change ISR (see SimCard::startBitLatencies()).
+ *
+ * - `-e` & `-r` inject parity errors into the bytes sent to & received from the card with the given probability
+ *   (see Terminal::injectErrors()), so the cost of the retransmissions can be measured.
+ * - `-t` saves the trace of the I/O line from the reset on (see LineTrace), so the run can be replayed with `lineReplay`.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <unistd.h>
+#include <vector>
+
+#include "lineTrace.h"
+#include "simCard.h"
+#include "terminal.h"
+
+namespace
+{
+    constexpr uint64_t BYTE_TIMEOUT     = 50000000;     ///< Cycles to wait for a byte of the card, about 10s
+    const uint8_t DECRYPT_HEADER[]      = {0x88, 0x10, 0x00, 0x00, 0x10};
+    const uint8_t GET_RESPONSE_HEADER[] = {0x88, 0xc0, 0x00, 0x00, 0x10};
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-n blocks] [-e sendErrorRate] [-r receiveErrorRate] [-s seed] [-t trace] <firmware.elf>\n", name);
+        return 2;
+    }
+
+    /**
+     * @brief Print a number of cycles & the corresponding time.
+     * @param[in] name (const char*): Name of the value.
+     * @param[in] cycles (const double): The number of cycles.
+     */
+    void printCycles(const char *name, const double cycles)
+    {
+        printf("%-20s %12.1f cycles (%10.1f us)\n", name, cycles, cycles * 1e6 / SimCard::FREQUENCY);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int blocks = 64;
+    double sendErrorRate = 0;
+    double receiveErrorRate = 0;
+    uint32_t seed = 1;
+    const char *trace = nullptr;
+    int option = 0;
+    while((option = getopt(argc, argv, "n:e:r:s:t:")) != -1)
+    {
+        switch(option)
+        {
+            case 'n': blocks = atoi(optarg); break;
+            case 'e': sendErrorRate = atof(optarg); break;
+            case 'r': receiveErrorRate = atof(optarg); break;
+            case 's': seed = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)); break;
+            case 't': trace = optarg; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind + 1 != argc) return usage(argv[0]);
+    if(blocks < 2 || sendErrorRate < 0 || sendErrorRate >= 1 || receiveErrorRate < 0 || receiveErrorRate >= 1)
+    {
+        fprintf(stderr, "At least 2 blocks & error rates from 0 to below 1 are required.\n");
+        return 2;
+    }
+
+    try
+    {
+        SimCard card(argv[optind]);
+        Terminal terminal(card);
+        LineTrace lineTrace;
+        if(trace) card.record(&lineTrace.edges());
+
+        // ATR **************************************************************************
+        std::vector<uint8_t> atr;
+        if(!terminal.receiveATR(atr, BYTE_TIMEOUT))
+        {
+            fprintf(stderr, "No ATR received.\n");
+            return 1;
+        }
+        terminal.injectErrors(sendErrorRate, receiveErrorRate, seed);
+
+        // Decryptions ******************************************************************
+        std::vector<uint64_t> latencies;
+        latencies.reserve(blocks);
+        uint8_t cipher[16] = {};
+        uint8_t plain[16] = {};
+        uint8_t sw[2] = {};
+        const uint64_t start = card.cycle();
+        uint64_t secondStart = 0;
+        for(int i=0; i<blocks; i++)
+        {
+            cipher[0] = static_cast<uint8_t>(i);
+            cipher[1] = static_cast<uint8_t>(i >> 8);
+            const uint64_t blockStart = card.cycle();
+            if(i == 1) secondStart = blockStart;
+            if(!terminal.command(DECRYPT_HEADER, cipher, nullptr, sw, BYTE_TIMEOUT) || sw[0] != 0x61 || sw[1] != 0x10)
+            {
+                fprintf(stderr, "Decryption of block %d failed (SW %02x %02x).\n", i, sw[0], sw[1]);
+                return 1;
+            }
+            if(!terminal.command(GET_RESPONSE_HEADER, nullptr, plain, sw, BYTE_TIMEOUT))
+            {
+                fprintf(stderr, "GET RESPONSE of block %d failed.\n", i);
+                return 1;
+            }
+            latencies.push_back(card.cycle() - blockStart);
+        }
+        const uint64_t end = card.cycle();
+        if(trace)
+        {
+            // Record the stop bit & the error window of the last character
+            card.runUntil(end + Terminal::GUARD_ETUS*SimCard::ETU);
+            lineTrace.save(trace);
+        }
+
+        // Results **********************************************************************
+        std::vector<uint64_t> sorted(latencies.begin() + 1, latencies.end());
+        std::sort(sorted.begin(), sorted.end());
+        uint64_t total = 0;
+        for(const uint64_t latency : sorted) total += latency;
+        const double sustained = (blocks - 1) * static_cast<double>(SimCard::FREQUENCY) / (end - secondStart);
+
+        printf("Blocks:              %d\n", blocks);
+        printCycles("First block:", latencies.front());
+        printCycles("Latency min:", sorted.front());
+        printCycles("Latency avg:", static_cast<double>(total) / sorted.size());
+        printCycles("Latency median:", sorted[sorted.size()/2]);
+        printCycles("Latency p99:", sorted[(sorted.size()*99)/100]);
+        printCycles("Latency max:", sorted.back());
+        const std::vector<uint32_t> &startBits = card.startBitLatencies();
+        if(!startBits.empty())
+        {
+            printCycles("Start bit min:", *std::min_element(startBits.begin(), startBits.end()));
+            printCycles("Start bit max:", *std::max_element(startBits.begin(), startBits.end()));
+        }
+        printf("Sustained:           %12.2f blocks/s (%.1f bytes/s of plaintext)\n", sustained, sustained * sizeof(plain));
+        printf("Total:               %12.3f s simulated\n", static_cast<double>(end - start) / SimCard::FREQUENCY);
+        printf("Injected errors:     %12u\n", terminal.injectedErrors());
+        printf("Parity errors:       %12u, retransmits: %u\n", terminal.parityErrors(), terminal.retransmits());
+    }
+    catch(const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file bootTiming.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Measure the time to the ATR & to the first decrypted block of the firmware in simavr.
+ *
+ * Usage: `bootTiming <firmware.elf>`
+ *
+ * The Terminal receives the ATR & sends the first block to decrypt right after it, as fast as the guard times allow.
+ * The tool prints the cycles from the reset to the start bit of the ATR & to the status words `61 10`,
+ * which announce the first decrypted block, & compares the latter with a second block.
+ * It fails, if the ATR is not started within the 40000 clock cycles required by ISO 7816-3.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "simCard.h"
+#include "terminal.h"
+
+namespace
+{
+    constexpr uint64_t ATR_DEADLINE     = 40000;        ///< Latest start of the ATR after the reset in clock cycles (ISO 7816-3)
+    constexpr uint64_t BYTE_TIMEOUT     = 50000000;     ///< Cycles to wait for a byte of the card, about 10s
+    const uint8_t EXPECTED_ATR[]        = {0x3b, 0x90, 0x11, 0x00};
+    const uint8_t DECRYPT_HEADER[]      = {0x88, 0x10, 0x00, 0x00, 0x10};
+    const uint8_t GET_RESPONSE_HEADER[] = {0x88, 0xc0, 0x00, 0x00, 0x10};
+    const uint8_t CIPHER[]              = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+    /**
+     * @brief Decrypt a block with a DECRYPT & a GET RESPONSE command.
+     * @param[inout] terminal (Terminal&): The Terminal.
+     * @param[out] plain (uint8_t*): The decrypted block.
+     * @param[out] ready (uint64_t&): Cycle of the start bit of the status words `61 10`.
+     * @return (bool): Whether the block was decrypted.
+     */
+    bool decrypt(Terminal &terminal, uint8_t *plain, uint64_t &ready)
+    {
+        uint8_t sw[2] = {};
+        if(!terminal.command(DECRYPT_HEADER, CIPHER, nullptr, sw, BYTE_TIMEOUT) || sw[0] != 0x61 || sw[1] != 0x10)
+        {
+            fprintf(stderr, "Decryption failed (SW %02x %02x).\n", sw[0], sw[1]);
+            return false;
+        }
+        ready = terminal.statusStart();
+        if(!terminal.command(GET_RESPONSE_HEADER, nullptr, plain, sw, BYTE_TIMEOUT))
+        {
+            fprintf(stderr, "GET RESPONSE failed.\n");
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <firmware.elf>\n", argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        SimCard card(argv[1]);
+        Terminal terminal(card);
+
+        // ATR **************************************************************************
+        std::vector<uint8_t> atr;
+        if(!terminal.receiveATR(atr, BYTE_TIMEOUT))
+        {
+            fprintf(stderr, "No ATR received.\n");
+            return 1;
+        }
+        if(atr.size() != sizeof(EXPECTED_ATR) || memcmp(atr.data(), EXPECTED_ATR, sizeof(EXPECTED_ATR)) != 0)
+            fprintf(stderr, "Unexpected ATR.\n");
+        const uint64_t atrStart = terminal.atrStart();
+
+        // First & second block *********************************************************
+        uint8_t first[sizeof(CIPHER)] = {};
+        uint8_t second[sizeof(CIPHER)] = {};
+        uint64_t firstReady = 0;
+        uint64_t secondReady = 0;
+        const uint64_t atrEnd = card.cycle();
+        if(!decrypt(terminal, first, firstReady)) return 1;
+        const uint64_t secondStart = card.cycle();
+        if(!decrypt(terminal, second, secondReady)) return 1;
+        if(memcmp(first, second, sizeof(CIPHER)) != 0)
+            fprintf(stderr, "The first & second block differ.\n");
+
+        const double usPerCycle = 1e6 / SimCard::FREQUENCY;
+        printf("ATR start:           %10llu cycles (%8.1f us, limit %llu cycles)\n",
+               static_cast<unsigned long long>(atrStart), atrStart*usPerCycle, static_cast<unsigned long long>(ATR_DEADLINE));
+        printf("First block ready:   %10llu cycles (%8.1f us after reset)\n",
+               static_cast<unsigned long long>(firstReady), firstReady*usPerCycle);
+        printf("First block:         %10llu cycles from ATR end to 61 10\n",
+               static_cast<unsigned long long>(firstReady - atrEnd));
+        printf("Second block:        %10llu cycles from command to 61 10\n",
+               static_cast<unsigned long long>(secondReady - secondStart));
+        printf("Parity errors:       %10u, retransmits: %u\n", terminal.parityErrors(), terminal.retransmits());
+
+        if(atrStart > ATR_DEADLINE)
+        {
+            fprintf(stderr, "The ATR started after %llu cycles.\n", static_cast<unsigned long long>(ATR_DEADLINE));
+            return 1;
+        }
+    }
+    catch(const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+# Run constTime on the timing build of every variant of the benchmark matrix & fail, if any of them leaks
+# VARIANTS:     Names of the countermeasure combinations (separated by |)
+# MATRIX_DIR:   Directory with a build per variant with ProfilingTrigger & without the BlockCache (<variant>_timing)
+# FIRMWARE:     File name of the firmware ELF in each build
+# CONST_TIME:   Path of the constTime tool
+# OUTPUT_DIR:   Directory for the report & the cycles per call (CSV) of each variant
+string(REPLACE "|" ";" VARIANTS "${VARIANTS}")
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+set(leaking)
+foreach(variant ${VARIANTS})
+    execute_process(COMMAND "${CONST_TIME}" -o "${OUTPUT_DIR}/${variant}.csv" "${MATRIX_DIR}/${variant}_timing/${FIRMWARE}"
+                    OUTPUT_VARIABLE report RESULT_VARIABLE status)
+    file(WRITE "${OUTPUT_DIR}/${variant}.txt" "${report}")
+    message("*** ${variant} ***\n${report}")
+    if(NOT status EQUAL 0 AND "${report}" MATCHES "Data-dependent timing found")
+        list(APPEND leaking ${variant})
+    elseif(NOT status EQUAL 0)
+        message(FATAL_ERROR "constTime failed for ${variant}.")
+    endif()
+endforeach()
+
+if(leaking)
+    message(FATAL_ERROR "Data-dependent timing in: ${leaking}")
+endif()
+message(STATUS "No data-dependent timing found. The reports are in ${OUTPUT_DIR}")
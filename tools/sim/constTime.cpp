@@ -0,0 +1,359 @@
+/**
+ * @file constTime.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Check whether the cycles of AES::decrypt() depend on the ciphertext or the key, in simavr.
+ *
+ * Usage: `constTime [-n calls] [-s seed] [-o calls.csv] <firmware.elf>`
+ *
+ * Two experiments with `calls` (default 2000) decryptions each are run. In each call, a coin decides between
+ * a fixed & a random input, so both classes are measured under the same conditions:
+ *
+ * - ciphertext: The key is fixed, the ciphertext is either fixed or random.
+ * - key: The ciphertext is random, the key is either the fixed key (slot 0) or one of 7 random keys (slots 1-7).
+ *
+ * The cycles of each call are taken from the trigger (JP5) pin, which is high exactly while the card decrypts.
+ * If the firmware was built with ProfilingTrigger, the start of each phase is marked by short pulses on the pin.
+ * They are decoded into the cycles per phase & call, from the mark of a phase to the next mark or the end of the call.
+ * The marks add a constant number of cycles, so they don't hide or cause a data-dependent variation.
+ *
+ * For the whole call & each phase, the mean, standard deviation, minimum & maximum of both classes are printed
+ * together with Welch's t-statistic. A |t| above 4.5 is flagged as a data-dependent variation & makes the tool fail.
+ * Random countermeasures (e.g. dummy operations) add variance to both classes alike, so they are not flagged.
+ * The firmware should be built without the BlockCache, since it would answer the fixed ciphertext without decrypting.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+#include "simCard.h"
+#include "terminal.h"
+
+namespace
+{
+    constexpr uint64_t BYTE_TIMEOUT     = 50000000;     ///< Cycles to wait for a byte of the card, about 10s
+    constexpr uint8_t NUM_PHASES        = 6;            ///< Profiler::NUM_PHASES
+    constexpr uint8_t RANDOM_KEYS       = 7;            ///< Number of random keys, in slots 1 to 7
+    constexpr uint32_t WARM_UP_CALLS    = 32;           ///< Unmeasured calls, until the background jobs of the key loads are done
+    constexpr uint64_t MARK_LOW_MAX     = 16;           ///< Maximum cycles the trigger pin is low during a phase mark
+    constexpr uint64_t MARK_GAP_MAX     = 32;           ///< Maximum cycles between two pulses of the same phase mark
+    constexpr double T_THRESHOLD        = 4.5;          ///< |t| above which a variation is flagged
+    const char *PHASE_NAMES[NUM_PHASES] = {"ADD_ROUND_KEY", "INV_SHIFT_ROWS", "INV_BYTE_SUB", "INV_MIX_COLS", "MASKING_INIT", "HIDING_INIT"};
+    const uint8_t SW_OK[]               = {0x90, 0x00};
+    const uint8_t SW_BUSY[]             = {0x69, 0x85};
+
+    /**
+     * @brief Cycles of a single call of AES::decrypt().
+     */
+    struct call_t
+    {
+        bool fixed;                     ///< Whether the input was the fixed one
+        uint64_t cycles;                ///< Cycles of the whole call
+        uint64_t phases[NUM_PHASES];    ///< Cycles spent in each phase
+    };
+
+    /**
+     * @brief Running statistics of a class of calls (Welford's algorithm).
+     */
+    struct stats_t
+    {
+        uint64_t count = 0;             ///< Number of values
+        double mean = 0;                ///< Mean of the values
+        double m2 = 0;                  ///< Sum of the squared differences from the mean
+        uint64_t min = UINT64_MAX;      ///< Minimum value
+        uint64_t max = 0;               ///< Maximum value
+
+        /**
+         * @brief Add a value.
+         * @param[in] value (const uint64_t): The value.
+         */
+        void add(const uint64_t value)
+        {
+            count++;
+            const double delta = value - mean;
+            mean += delta / count;
+            m2 += delta * (value - mean);
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+
+        /**
+         * @brief Get the sample variance.
+         * @return (double): The variance, 0 for less than 2 values.
+         */
+        double variance() const { return count > 1 ? m2 / (count - 1) : 0; }
+    };
+
+    /**
+     * @brief Welch's t-statistic of two classes.
+     * @param[in] a (const stats_t&): The first class.
+     * @param[in] b (const stats_t&): The second class.
+     * @return (double): The t-statistic, infinite if the means differ without any variance.
+     */
+    double welch(const stats_t &a, const stats_t &b)
+    {
+        const double difference = a.mean - b.mean;
+        const double error = a.variance() / a.count + b.variance() / b.count;
+        if(error == 0) return difference == 0 ? 0 : INFINITY;
+        return difference / std::sqrt(error);
+    }
+
+    /**
+     * @brief Decode the trigger pin edges of the next call of AES::decrypt().
+     * @param[in] card (const SimCard&): The card, whose pin is low again.
+     * @param[inout] edge (size_t&): Index of the rising edge of the call, set to the index of the next call.
+     * @param[out] call (@ref call_t&): The cycles of the call & its phases.
+     * @return (bool): Whether a complete call was found.
+     */
+    bool decodeCall(const SimCard &card, size_t &edge, call_t &call)
+    {
+        const std::vector<uint64_t> &rises = card.triggerRises();
+        const std::vector<uint64_t> &falls = card.triggerFalls();
+        if(edge >= falls.size() || rises.size() != falls.size()) return false;
+
+        std::fill(call.phases, call.phases + NUM_PHASES, 0);
+        const uint64_t start = rises[edge];
+        uint64_t segmentStart = start;
+        int phase = -1;
+        size_t k = edge;
+        while(true)
+        {
+            // A fall, that is not followed by a rise shortly after, ends the call
+            const uint64_t fall = falls[k];
+            const bool pulse = k + 1 < rises.size() && rises[k+1] - fall <= MARK_LOW_MAX;
+            if(!pulse)
+            {
+                if(phase >= 0) call.phases[phase] += fall - segmentStart;
+                call.cycles = fall - start;
+                edge = k + 1;
+                return true;
+            }
+
+            // A phase mark of n+1 pulses, the pin is high again at rises[k]
+            uint8_t pulses = 1;
+            k++;
+            while(k + 1 < rises.size() && falls[k] - rises[k] <= MARK_GAP_MAX && rises[k+1] - falls[k] <= MARK_LOW_MAX)
+            {
+                pulses++;
+                k++;
+            }
+            if(phase >= 0) call.phases[phase] += fall - segmentStart;
+            phase = std::min<int>(pulses - 1, NUM_PHASES - 1);
+            segmentStart = fall;
+        }
+    }
+
+    /**
+     * @brief Load a key into a slot, retry as long as the card is busy with the previous key.
+     * @param[inout] terminal (Terminal&): The Terminal.
+     * @param[in] slot (const uint8_t): The key slot.
+     * @param[in] key (const uint8_t*): The 16 key bytes.
+     * @return (bool): Whether the card accepted the key.
+     */
+    bool loadKey(Terminal &terminal, const uint8_t slot, const uint8_t *key)
+    {
+        const uint8_t header[] = {0x88, 0xd8, 0x00, slot, 0x10};
+        uint8_t sw[2] = {};
+        do
+        {
+            if(!terminal.command(header, key, nullptr, sw, BYTE_TIMEOUT)) return false;
+        } while(sw[0] == SW_BUSY[0] && sw[1] == SW_BUSY[1]);
+        return sw[0] == SW_OK[0] && sw[1] == SW_OK[1];
+    }
+
+    /**
+     * @brief Decrypt a block with a DECRYPT & a GET RESPONSE command.
+     * @param[inout] terminal (Terminal&): The Terminal.
+     * @param[in] slot (const uint8_t): The key slot.
+     * @param[in] cipher (const uint8_t*): The 16 bytes of the ciphertext.
+     * @return (bool): Whether the block was decrypted.
+     */
+    bool decrypt(Terminal &terminal, const uint8_t slot, const uint8_t *cipher)
+    {
+        const uint8_t decryptHeader[] = {0x88, 0x10, 0x00, slot, 0x10};
+        const uint8_t getResponseHeader[] = {0x88, 0xc0, 0x00, 0x00, 0x10};
+        uint8_t plain[16] = {};
+        uint8_t sw[2] = {};
+        if(!terminal.command(decryptHeader, cipher, nullptr, sw, BYTE_TIMEOUT) || sw[0] != 0x61 || sw[1] != 0x10)
+        {
+            fprintf(stderr, "Decryption failed (SW %02x %02x).\n", sw[0], sw[1]);
+            return false;
+        }
+        return terminal.command(getResponseHeader, nullptr, plain, sw, BYTE_TIMEOUT);
+    }
+
+    /**
+     * @brief Print the statistics of a measure & flag a data-dependent variation.
+     * @param[in] name (const char*): Name of the measure.
+     * @param[in] fixed (const stats_t&): Statistics of the fixed class.
+     * @param[in] random (const stats_t&): Statistics of the random class.
+     * @return (bool): Whether the variation was flagged.
+     */
+    bool report(const char *name, const stats_t &fixed, const stats_t &random)
+    {
+        const double t = welch(fixed, random);
+        const bool flagged = std::fabs(t) > T_THRESHOLD;
+        printf("%-16s %12.1f %9.1f %12.1f %9.1f %10llu %10llu %9.2f  %s\n", name,
+               fixed.mean, std::sqrt(fixed.variance()), random.mean, std::sqrt(random.variance()),
+               static_cast<unsigned long long>(std::min(fixed.min, random.min)),
+               static_cast<unsigned long long>(std::max(fixed.max, random.max)),
+               t, flagged ? "LEAK" : "ok");
+        return flagged;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t calls = 2000;
+    uint32_t seed = 1;
+    const char *csvFile = nullptr;
+    int option = 0;
+    while((option = getopt(argc, argv, "n:s:o:")) != -1)
+    {
+        switch(option)
+        {
+            case 'n': calls = static_cast<uint32_t>(atoi(optarg)); break;
+            case 's': seed = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)); break;
+            case 'o': csvFile = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n calls] [-s seed] [-o calls.csv] <firmware.elf>\n", argv[0]);
+                return 2;
+        }
+    }
+    if(optind + 1 != argc || calls < 4)
+    {
+        fprintf(stderr, "Usage: %s [-n calls] [-s seed] [-o calls.csv] <firmware.elf>\n", argv[0]);
+        return 2;
+    }
+
+    FILE *csv = nullptr;
+    if(csvFile)
+    {
+        csv = fopen(csvFile, "w");
+        if(!csv)
+        {
+            fprintf(stderr, "Can't open %s.\n", csvFile);
+            return 2;
+        }
+        fprintf(csv, "experiment,class,cycles");
+        for(uint8_t i=0; i<NUM_PHASES; i++) fprintf(csv, ",%s", PHASE_NAMES[i]);
+        fprintf(csv, "\n");
+    }
+
+    bool leak = false;
+    try
+    {
+        SimCard card(argv[optind]);
+        Terminal terminal(card);
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> byteDistribution(0, 255);
+
+        std::vector<uint8_t> atr;
+        if(!terminal.receiveATR(atr, BYTE_TIMEOUT))
+        {
+            fprintf(stderr, "No ATR received.\n");
+            return 1;
+        }
+
+        // Keys *****************************************************************************
+        uint8_t fixedKey[16] = {};
+        uint8_t fixedCipher[16] = {};
+        for(uint8_t i=0; i<16; i++)
+        {
+            fixedKey[i] = static_cast<uint8_t>(byteDistribution(rng));
+            fixedCipher[i] = static_cast<uint8_t>(byteDistribution(rng));
+        }
+        for(uint8_t slot=1; slot<=RANDOM_KEYS; slot++)
+        {
+            uint8_t key[16];
+            for(uint8_t i=0; i<16; i++) key[i] = static_cast<uint8_t>(byteDistribution(rng));
+            if(!loadKey(terminal, slot, key))
+            {
+                fprintf(stderr, "Loading the key into slot %u failed.\n", slot);
+                return 1;
+            }
+        }
+        if(!loadKey(terminal, 0, fixedKey))
+        {
+            fprintf(stderr, "Loading the fixed key failed.\n");
+            return 1;
+        }
+        for(uint32_t i=0; i<WARM_UP_CALLS; i++)
+            if(!decrypt(terminal, 0, fixedCipher)) return 1;
+
+        // Experiments **************************************************************************
+        const char *experiments[] = {"ciphertext", "key"};
+        for(uint8_t experiment=0; experiment<2; experiment++)
+        {
+            stats_t cycles[2];
+            stats_t phases[NUM_PHASES][2];
+            bool marked = false;
+            size_t edge = card.triggerRises().size();
+            for(uint32_t i=0; i<calls; i++)
+            {
+                const bool fixed = rng() & 0x01;
+                uint8_t cipher[16];
+                for(uint8_t j=0; j<16; j++) cipher[j] = static_cast<uint8_t>(byteDistribution(rng));
+                uint8_t slot = 0;
+                if(experiment == 0)
+                {
+                    if(fixed) std::copy(fixedCipher, fixedCipher + 16, cipher);
+                }
+                else if(!fixed)
+                    slot = static_cast<uint8_t>(1 + rng() % RANDOM_KEYS);
+                if(!decrypt(terminal, slot, cipher)) return 1;
+
+                call_t call = {};
+                call.fixed = fixed;
+                if(!decodeCall(card, edge, call))
+                {
+                    fprintf(stderr, "No decryption on the trigger pin in call %u, is the BlockCache disabled?\n", i);
+                    return 1;
+                }
+                cycles[fixed].add(call.cycles);
+                for(uint8_t p=0; p<NUM_PHASES; p++)
+                {
+                    phases[p][fixed].add(call.phases[p]);
+                    marked |= call.phases[p] != 0;
+                }
+                if(csv)
+                {
+                    fprintf(csv, "%s,%s,%llu", experiments[experiment], fixed ? "fixed" : "random", static_cast<unsigned long long>(call.cycles));
+                    for(uint8_t p=0; p<NUM_PHASES; p++) fprintf(csv, ",%llu", static_cast<unsigned long long>(call.phases[p]));
+                    fprintf(csv, "\n");
+                }
+            }
+
+            printf("Experiment: %s, %llu fixed & %llu random calls\n", experiments[experiment],
+                   static_cast<unsigned long long>(cycles[1].count), static_cast<unsigned long long>(cycles[0].count));
+            printf("%-16s %12s %9s %12s %9s %10s %10s %9s\n", "", "fixed mean", "sd", "random mean", "sd", "min", "max", "t");
+            leak |= report("decrypt", cycles[1], cycles[0]);
+            for(uint8_t p=0; marked && p<NUM_PHASES; p++)
+            {
+                // Skip the phases of countermeasures, that are not built in
+                if(phases[p][0].max == 0 && phases[p][1].max == 0) continue;
+                leak |= report(PHASE_NAMES[p], phases[p][1], phases[p][0]);
+            }
+            printf("\n");
+        }
+    }
+    catch(const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        if(csv) fclose(csv);
+        return 1;
+    }
+    if(csv) fclose(csv);
+
+    printf(leak ? "Data-dependent timing found (|t| > %.1f).\n" : "No data-dependent timing found (|t| <= %.1f).\n", T_THRESHOLD);
+    return leak ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file cycleBench.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Measure the cycles of the firmware's AES & countermeasures in simavr.
+ *
+ * Usage: `cycleBench <firmware.elf> [blocks]`
+ *
+ * The Terminal receives the ATR & decrypts `blocks` (default 16) different blocks, so none of them is answered
+ * from the block cache. The cycles per AES::decrypt() are taken from the trigger (JP5) pin, which is high exactly
+ * while the card decrypts. If the firmware was built with Profiling, the Profiler record is read with GET DATA
+ * & the average cycles of Masking::init() & Hiding::init() (the phases MASKING_INIT & HIDING_INIT) are reported, too.
+ *
+ * The results are printed as `name value` lines, e.g.
+ *
+ *     atr_cycles 10432
+ *     decrypt_cycles_min 81234
+ *     decrypt_cycles_avg 81301.5
+ *     decrypt_cycles_max 81377
+ *     masking_init_cycles 6120.0
+ *
+ * Values, that are not available for the firmware, are omitted.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "profiler.h"
+#include "simCard.h"
+#include "terminal.h"
+
+namespace
+{
+    constexpr uint64_t BYTE_TIMEOUT     = 50000000;     ///< Cycles to wait for a byte of the card, about 10s
+    /// Size of the Profiler record, its layout is the same on the card & on the host (packed & little-endian)
+    constexpr uint8_t PROFILE_LENGTH    = sizeof(Profiler::record_t);
+    static_assert(sizeof(Profiler::record_t) <= 0xff, "The Profiler record has to fit into a single GET DATA response.");
+    const uint8_t DECRYPT_HEADER[]      = {0x88, 0x10, 0x00, 0x00, 0x10};
+    const uint8_t GET_RESPONSE_HEADER[] = {0x88, 0xc0, 0x00, 0x00, 0x10};
+    const uint8_t GET_PROFILE_HEADER[]  = {0x88, 0xca, 0x00, 0x02, PROFILE_LENGTH};
+
+    /**
+     * @brief Print the average cycles per call of a phase in the Profiler record, if it was called.
+     * @param[in] name (const char*): Name of the result.
+     * @param[in] record (const Profiler::record_t&): The Profiler record.
+     * @param[in] phase (const Profiler::Phase): The phase.
+     */
+    void printPhase(const char *name, const Profiler::record_t &record, const Profiler::Phase phase)
+    {
+        const Profiler::phase_t &data = record.phases[static_cast<uint8_t>(phase)];
+        if(data.count > 0)
+            printf("%s %.1f\n", name, static_cast<double>(data.totalCycles) / data.count);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 2 && argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <firmware.elf> [blocks]\n", argv[0]);
+        return 2;
+    }
+    const int blocks = argc == 3 ? atoi(argv[2]) : 16;
+    if(blocks < 1 || blocks > 256)
+    {
+        fprintf(stderr, "The number of blocks must be between 1 & 256.\n");
+        return 2;
+    }
+
+    try
+    {
+        SimCard card(argv[1]);
+        Terminal terminal(card);
+
+        // ATR **************************************************************************
+        std::vector<uint8_t> atr;
+        if(!terminal.receiveATR(atr, BYTE_TIMEOUT))
+        {
+            fprintf(stderr, "No ATR received.\n");
+            return 1;
+        }
+        const size_t firstEdge = card.triggerFalls().size();
+
+        // Decryptions ******************************************************************
+        uint8_t cipher[16] = {};
+        uint8_t plain[16] = {};
+        uint8_t sw[2] = {};
+        for(int i=0; i<blocks; i++)
+        {
+            cipher[0] = static_cast<uint8_t>(i);
+            if(!terminal.command(DECRYPT_HEADER, cipher, nullptr, sw, BYTE_TIMEOUT) || sw[0] != 0x61 || sw[1] != 0x10)
+            {
+                fprintf(stderr, "Decryption of block %d failed (SW %02x %02x).\n", i, sw[0], sw[1]);
+                return 1;
+            }
+            if(!terminal.command(GET_RESPONSE_HEADER, nullptr, plain, sw, BYTE_TIMEOUT))
+            {
+                fprintf(stderr, "GET RESPONSE of block %d failed.\n", i);
+                return 1;
+            }
+        }
+
+        // The trigger pin is high during each AES::decrypt()
+        const std::vector<uint64_t> &rises = card.triggerRises();
+        const std::vector<uint64_t> &falls = card.triggerFalls();
+        if(falls.size() - firstEdge != static_cast<size_t>(blocks) || rises.size() != falls.size())
+        {
+            fprintf(stderr, "Expected %d pulses on the trigger pin, got %zu.\n", blocks, falls.size() - firstEdge);
+            return 1;
+        }
+        uint64_t minCycles = UINT64_MAX;
+        uint64_t maxCycles = 0;
+        uint64_t totalCycles = 0;
+        for(size_t i=firstEdge; i<falls.size(); i++)
+        {
+            const uint64_t cycles = falls[i] - rises[i];
+            minCycles = std::min(minCycles, cycles);
+            maxCycles = std::max(maxCycles, cycles);
+            totalCycles += cycles;
+        }
+
+        printf("atr_cycles %llu\n", static_cast<unsigned long long>(terminal.atrStart()));
+        printf("decrypt_cycles_min %llu\n", static_cast<unsigned long long>(minCycles));
+        printf("decrypt_cycles_avg %.1f\n", static_cast<double>(totalCycles) / blocks);
+        printf("decrypt_cycles_max %llu\n", static_cast<unsigned long long>(maxCycles));
+
+        // Profiler record, only available with Profiling *******************************
+        uint8_t profile[PROFILE_LENGTH] = {};
+        Profiler::record_t record;
+        if(terminal.command(GET_PROFILE_HEADER, nullptr, profile, sw, BYTE_TIMEOUT) && sw[0] == 0x90 && sw[1] == 0x00)
+        {
+            memcpy(&record, profile, sizeof(record));
+            if(record.version == Profiler::RECORD_VERSION)
+            {
+                printPhase("masking_init_cycles", record, Profiler::Phase::MASKING_INIT);
+                printPhase("hiding_init_cycles", record, Profiler::Phase::HIDING_INIT);
+            }
+        }
+    }
+    catch(const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
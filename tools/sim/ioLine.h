@@ -0,0 +1,110 @@
+/**
+ * @file ioLine.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the IOLine interface.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef IO_LINE_H
+#define IO_LINE_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief An edge of one of the drivers of the I/O line.
+ */
+struct LineEdge
+{
+    uint64_t cycle;             ///< Clock cycle of the card, at which the driver changed
+    uint8_t driver;             ///< IOLine::TERMINAL or IOLine::CARD
+    uint8_t low;                ///< 1, if the driver pulls the line low from #cycle on, 0 if it releases it
+    uint8_t reserved[6];        ///< Padding, 0
+};
+
+/**
+ * @brief Interface of a simulated card, as seen by the Terminal on the I/O line.
+ *
+ * The I/O line is an open-drain line with a pull-up: It is low, if either the card drives it low
+ * or the Terminal pulls it low (see setTerminalLow()). All times are measured in clock cycles of the card
+ * since its reset. It is implemented by the SimCard in simavr & by the HostCard of the card farm.
+ * The edges of both drivers can be recorded (see record()), e.g. to replay the Terminal's side later (see LineTrace).
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class IOLine
+{
+public:
+    static constexpr uint32_t FREQUENCY     = 4800000;      ///< Card clock in Hz, equals F_CPU of the firmware
+    static constexpr uint32_t ETU           = 372;          ///< Elementary time unit in clock cycles (F=372, D=1)
+    static constexpr uint8_t TERMINAL       = 0;            ///< LineEdge::driver of the Terminal
+    static constexpr uint8_t CARD           = 1;            ///< LineEdge::driver of the card
+
+    /**
+     * @brief Destroy the IOLine object.
+     */
+    virtual ~IOLine() = default;
+
+    /**
+     * @brief Get the number of clock cycles since the reset.
+     * @return (uint64_t): The current cycle.
+     */
+    virtual uint64_t cycle() const = 0;
+
+    /**
+     * @brief Run the card until @p cycle is reached.
+     * @param[in] cycle (const uint64_t): Cycle to run to.
+     */
+    virtual void runUntil(const uint64_t cycle) = 0;
+
+    /**
+     * @brief Run the card until the I/O line has the level @p level or @p deadline is reached.
+     * @param[in] level (const bool): Level to wait for.
+     * @param[in] deadline (const uint64_t): Cycle at which to give up.
+     * @return (bool): Whether the I/O line reached @p level in time.
+     */
+    virtual bool waitForLine(const bool level, const uint64_t deadline) = 0;
+
+    /**
+     * @brief Get the level of the I/O line.
+     * @return (bool): The level of the I/O line.
+     */
+    virtual bool line() const = 0;
+
+    /**
+     * @brief Pull the I/O line low on the Terminal's side or release it.
+     * @param[in] low (const bool): Whether to pull the I/O line low.
+     */
+    virtual void setTerminalLow(const bool low) = 0;
+
+    /**
+     * @brief Record the edges of both drivers from now on.
+     * @param[out] edges (std::vector<LineEdge>*): Vector, to which the edges are appended, nullptr to stop recording.
+     */
+    void record(std::vector<LineEdge> *edges) { mRecord = edges; }
+
+protected:
+    /**
+     * @brief Set whether a driver pulls the I/O line low & record its edge. To be called by the implementations.
+     * @param[in] driver (const uint8_t): #TERMINAL or #CARD.
+     * @param[in] low (const bool): Whether the driver pulls the line low.
+     */
+    void drive(const uint8_t driver, const bool low)
+    {
+        if(mLow[driver] == low) return;
+        mLow[driver] = low;
+        if(mRecord) mRecord->push_back(LineEdge{cycle(), driver, static_cast<uint8_t>(low), {}});
+    }
+
+private:
+    std::vector<LineEdge> *mRecord  = nullptr;          ///< Recorded edges, nullptr if not recording
+    bool mLow[2]                    = {false, false};   ///< Whether the Terminal & the card pull the line low
+};
+
+#endif // IO_LINE_H
@@ -0,0 +1,210 @@
+/**
+ * @file lineReplay.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Replay the Terminal's side of an I/O line trace into the card & compare the characters & their timing.
+ *
+ * Usage: `lineReplay [-c] [-r] [-v] [-o replay] <firmware.elf> <trace>` in simavr,
+ * `lineReplay_<profile> [-c] [-r] [-v] [-o replay] <trace>` with a HostCard of the card farm.
+ *
+ * The trace is recorded by `apduBench -t` or `virtualCard -t`, or imported from a capture of both drivers (`-c`,
+ * see LineTrace::importCSV()). Each edge of the Terminal is applied at its recorded cycle, as fast as possible or
+ * in real time (`-r`), so the reader's timing, its parity errors & retransmissions are reproduced exactly.
+ * The characters of the recording & the replay are decoded & compared: The first difference is printed
+ * (`-v` prints all characters), as well as the delay of the card's characters & the turnaround of the card,
+ * i.e. the cycles from the start bit of the Terminal's last character to the start bit of the card's answer.
+ * The HostCard runs the firmware's code in zero time, so its cycles are only those of the line.
+ *
+ * - `-o` saves the trace of the replay, e.g. to replay it in the other build.
+ *
+ * The exit code is 1, if the characters differ.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "lineTrace.h"
+#ifdef HOST_CARD
+#include "hostCard.h"
+#else
+#include "simCard.h"
+#endif
+
+namespace
+{
+    typedef std::vector<LineTrace::Character> characters_t;     ///< Decoded characters of a trace
+
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        #ifdef HOST_CARD
+        fprintf(stderr, "Usage: %s [-c] [-r] [-v] [-o replay] <trace>\n", name);
+        #else
+        fprintf(stderr, "Usage: %s [-c] [-r] [-v] [-o replay] <firmware.elf> <trace>\n", name);
+        #endif
+        return 2;
+    }
+
+    /**
+     * @brief Print a character.
+     * @param[in] name (const char*): Name of the trace.
+     * @param[in] character (const LineTrace::Character&): The character.
+     */
+    void printCharacter(const char *name, const LineTrace::Character &character)
+    {
+        printf("%-9s %12llu  %-8s %02x%s%s\n", name, static_cast<unsigned long long>(character.start),
+               character.driver == IOLine::TERMINAL ? "Terminal" : "card", character.byte,
+               character.parity ? "" : "  parity wrong", character.error ? "  error signalled" : "");
+    }
+
+    /**
+     * @brief Get the turnarounds of the card, i.e. the cycles from the start bit of the Terminal's last character
+     *        to the start bit of each card character, that answers it.
+     * @param[in] characters (const characters_t&): The characters of a trace.
+     * @return (std::vector<uint64_t>): The sorted turnarounds.
+     */
+    std::vector<uint64_t> turnarounds(const characters_t &characters)
+    {
+        std::vector<uint64_t> cycles;
+        for(size_t i=1; i<characters.size(); i++)
+        {
+            if(characters[i].driver == IOLine::CARD && characters[i-1].driver == IOLine::TERMINAL)
+                cycles.push_back(characters[i].start - characters[i-1].start);
+        }
+        std::sort(cycles.begin(), cycles.end());
+        return cycles;
+    }
+
+    /**
+     * @brief Count the characters of a driver & those of them, for which an error was signalled.
+     * @param[in] characters (const characters_t&): The characters of a trace.
+     * @param[in] driver (const uint8_t): IOLine::TERMINAL or IOLine::CARD.
+     * @param[out] errors (size_t&): The number of characters with an error signal.
+     * @return (size_t): The number of characters.
+     */
+    size_t count(const characters_t &characters, const uint8_t driver, size_t &errors)
+    {
+        size_t total = 0;
+        errors = 0;
+        for(const LineTrace::Character &character : characters)
+        {
+            if(character.driver != driver) continue;
+            total++;
+            errors += character.error;
+        }
+        return total;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *options = "crvo:";
+    bool csv = false;
+    bool realTime = false;
+    bool verbose = false;
+    const char *output = nullptr;
+    int option = 0;
+    while((option = getopt(argc, argv, options)) != -1)
+    {
+        switch(option)
+        {
+            case 'c': csv = true; break;
+            case 'r': realTime = true; break;
+            case 'v': verbose = true; break;
+            case 'o': output = optarg; break;
+            default: return usage(argv[0]);
+        }
+    }
+    #ifdef HOST_CARD
+    if(optind + 1 != argc) return usage(argv[0]);
+    #else
+    if(optind + 2 != argc) return usage(argv[0]);
+    #endif
+    const uint32_t etu = IOLine::ETU;
+
+    try
+    {
+        LineTrace recorded(etu);
+        if(csv)
+            recorded.importCSV(argv[argc-1]);
+        else
+            recorded.load(argv[argc-1]);
+        if(recorded.etu() != etu)
+            fprintf(stderr, "The trace was recorded with an ETU of %u cycles, the card uses %u cycles.\n", recorded.etu(), etu);
+
+        #ifdef HOST_CARD
+        HostCard card;
+        #else
+        SimCard card(argv[optind]);
+        #endif
+        LineTrace replayed = recorded.replay(card, realTime);
+        if(output) replayed.save(output);
+
+        // Characters *******************************************************************
+        const characters_t expected = recorded.decode();
+        const characters_t actual = replayed.decode();
+        size_t differences = 0;
+        size_t first = std::max(expected.size(), actual.size());
+        std::vector<int64_t> delays;
+        for(size_t i=0; i<std::max(expected.size(), actual.size()); i++)
+        {
+            const bool same = i < expected.size() && i < actual.size() && expected[i].driver == actual[i].driver
+                              && expected[i].byte == actual[i].byte && expected[i].error == actual[i].error;
+            if(!same && differences++ == 0) first = i;
+            if(same && actual[i].driver == IOLine::CARD)
+                delays.push_back(static_cast<int64_t>(actual[i].start) - static_cast<int64_t>(expected[i].start));
+            if(verbose || (!same && differences == 1))
+            {
+                if(!same) printf("Difference at character %zu:\n", i);
+                if(i < expected.size()) printCharacter("recorded", expected[i]);
+                if(i < actual.size()) printCharacter("replayed", actual[i]);
+            }
+        }
+        std::sort(delays.begin(), delays.end());
+
+        // Results **********************************************************************
+        printf("Edges:               %zu recorded (%u cycles per ETU), %zu replayed\n", recorded.edges().size(), recorded.etu(), replayed.edges().size());
+        for(const characters_t *characters : {&expected, &actual})
+        {
+            size_t terminalErrors = 0;
+            size_t cardErrors = 0;
+            const size_t terminal = count(*characters, IOLine::TERMINAL, terminalErrors);
+            const size_t cardCharacters = count(*characters, IOLine::CARD, cardErrors);
+            printf("%-20s %zu Terminal (%zu rejected by the card), %zu card (%zu rejected by the Terminal)\n",
+                   characters == &expected ? "Recorded:" : "Replayed:", terminal, terminalErrors, cardCharacters, cardErrors);
+        }
+        if(differences)
+            printf("Differences:         %zu, the first at character %zu\n", differences, first);
+        else
+            printf("Differences:         none\n");
+        if(!delays.empty())
+            printf("Card delay:          min %lld, median %lld, max %lld cycles\n", static_cast<long long>(delays.front()),
+                   static_cast<long long>(delays[delays.size()/2]), static_cast<long long>(delays.back()));
+        const std::vector<uint64_t> expectedTurns = turnarounds(expected);
+        const std::vector<uint64_t> actualTurns = turnarounds(actual);
+        if(!expectedTurns.empty() && !actualTurns.empty())
+        {
+            printf("Turnaround recorded: median %llu, max %llu cycles\n", static_cast<unsigned long long>(expectedTurns[expectedTurns.size()/2]),
+                   static_cast<unsigned long long>(expectedTurns.back()));
+            printf("Turnaround replayed: median %llu, max %llu cycles\n", static_cast<unsigned long long>(actualTurns[actualTurns.size()/2]),
+                   static_cast<unsigned long long>(actualTurns.back()));
+        }
+        return differences ? 1 : 0;
+    }
+    catch(const std::exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,180 @@
+#include "lineTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+constexpr uint32_t LineTrace::VERSION;
+constexpr uint32_t LineTrace::TAIL_ETUS;
+constexpr char LineTrace::MAGIC[4];
+
+namespace
+{
+    /**
+     * @brief A change of the level of the I/O line.
+     */
+    struct LevelChange
+    {
+        uint64_t cycle;         ///< Cycle of the change
+        bool high;              ///< Level from #cycle on
+        uint8_t driver;         ///< Driver, whose edge changed the level
+    };
+
+    /**
+     * @brief Get the level of the I/O line at a cycle.
+     * @param[in] changes (const std::vector<LevelChange>&): The changes of the level, sorted by their cycle.
+     * @param[in] cycle (const uint64_t): The cycle.
+     * @return (bool): The level, high before the first change.
+     */
+    bool levelAt(const std::vector<LevelChange> &changes, const uint64_t cycle)
+    {
+        const auto next = std::upper_bound(changes.begin(), changes.end(), cycle,
+                                           [](const uint64_t c, const LevelChange &change) { return c < change.cycle; });
+        return next == changes.begin() || std::prev(next)->high;
+    }
+}
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void LineTrace::load(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if(!file)
+        throw std::runtime_error("Can't open " + path + ".");
+    Header header;
+    const bool valid = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                       && header.version == VERSION && header.frequency == IOLine::FREQUENCY && header.etu > 0;
+    if(!valid)
+    {
+        fclose(file);
+        throw std::runtime_error(path + " is no trace of a card at " + std::to_string(IOLine::FREQUENCY) + " Hz.");
+    }
+
+    // The number of edges has to match the rest of the file, before it's used to allocate them
+    const long offset = ftell(file);
+    const long end = (offset >= 0 && fseek(file, 0, SEEK_END) == 0) ? ftell(file) : -1;
+    const uint64_t bytes = end >= offset ? static_cast<uint64_t>(end - offset) : 1;
+    const bool sized = bytes % sizeof(LineEdge) == 0 && header.edges == bytes / sizeof(LineEdge)
+                       && fseek(file, offset, SEEK_SET) == 0;
+    std::vector<LineEdge> edges;
+    if(sized) edges.resize(header.edges);
+    const bool complete = sized && fread(edges.data(), sizeof(LineEdge), edges.size(), file) == edges.size();
+    fclose(file);
+    if(!complete)
+        throw std::runtime_error(path + " is truncated or its header has a wrong number of edges.");
+    mETU = header.etu;
+    mEdges.swap(edges);
+}
+
+void LineTrace::importCSV(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "r");
+    if(!file)
+        throw std::runtime_error("Can't open " + path + ".");
+    mEdges.clear();
+    bool low[2] = {false, false};
+    char line[256];
+    while(fgets(line, sizeof(line), file))
+    {
+        double seconds = 0;
+        int levels[2] = {1, 1};
+        if(sscanf(line, "%lf,%d,%d", &seconds, &levels[IOLine::TERMINAL], &levels[IOLine::CARD]) != 3) continue;
+        const uint64_t cycle = static_cast<uint64_t>(std::llround(std::max(seconds, 0.0) * IOLine::FREQUENCY));
+        for(uint8_t driver : {IOLine::TERMINAL, IOLine::CARD})
+        {
+            if(low[driver] == !levels[driver]) continue;
+            low[driver] = !levels[driver];
+            mEdges.push_back(LineEdge{cycle, driver, static_cast<uint8_t>(low[driver]), {}});
+        }
+    }
+    fclose(file);
+    std::stable_sort(mEdges.begin(), mEdges.end(), [](const LineEdge &a, const LineEdge &b) { return a.cycle < b.cycle; });
+}
+
+void LineTrace::save(const std::string &path) const
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if(!file)
+        throw std::runtime_error("Can't create " + path + ".");
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.frequency = IOLine::FREQUENCY;
+    header.etu = mETU;
+    header.edges = mEdges.size();
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                         && fwrite(mEdges.data(), sizeof(LineEdge), mEdges.size(), file) == mEdges.size();
+    if(fclose(file) != 0 || !written)
+        throw std::runtime_error("Can't write " + path + ".");
+}
+
+LineTrace LineTrace::replay(IOLine &card, const bool realTime) const
+{
+    LineTrace replayed(mETU);
+    card.record(&replayed.mEdges);
+    const auto epoch = std::chrono::steady_clock::now();
+    for(const LineEdge &edge : mEdges)
+    {
+        if(edge.driver != IOLine::TERMINAL) continue;
+        if(realTime)
+            std::this_thread::sleep_until(epoch + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                      std::chrono::duration<double>(static_cast<double>(edge.cycle) / IOLine::FREQUENCY)));
+        card.runUntil(edge.cycle);
+        card.setTerminalLow(edge.low);
+    }
+    card.runUntil((mEdges.empty() ? card.cycle() : mEdges.back().cycle) + TAIL_ETUS*mETU);
+    card.record(nullptr);
+    return replayed;
+}
+
+std::vector<LineTrace::Character> LineTrace::decode() const
+{
+    // Level of the open-drain line, that is low while either driver pulls it low
+    std::vector<LevelChange> changes;
+    bool low[2] = {false, false};
+    for(const LineEdge &edge : mEdges)
+    {
+        const bool before = !(low[0] || low[1]);
+        low[edge.driver & 1] = edge.low;
+        const bool after = !(low[0] || low[1]);
+        if(after != before) changes.push_back(LevelChange{edge.cycle, after, edge.driver});
+    }
+
+    // Sample each character like the receiver: 8 data bits & the parity bit in the middle of their ETU,
+    // & the error signal of the receiver at 11 ETU
+    std::vector<Character> characters;
+    uint64_t from = 0;
+    for(auto change = changes.begin(); change != changes.end(); ++change)
+    {
+        if(change->high || change->cycle < from) continue;
+        Character character;
+        character.start = change->cycle;
+        character.driver = change->driver;
+        character.byte = 0;
+        bool odd = false;
+        for(uint8_t i=0; i<8; i++)
+        {
+            const bool bit = levelAt(changes, character.start + (i+1)*mETU + mETU/2);
+            character.byte |= static_cast<uint8_t>(bit << i);
+            odd ^= bit;
+        }
+        character.parity = levelAt(changes, character.start + 9*mETU + mETU/2) == odd;
+        character.error = !levelAt(changes, character.start + 11*mETU);
+        characters.push_back(character);
+
+        // The next start bit follows the stop bit or the end of the error signal
+        from = character.start + 11*mETU;
+        if(character.error)
+        {
+            const auto end = std::find_if(change, changes.end(), [from](const LevelChange &c) { return c.high && c.cycle >= from; });
+            if(end == changes.end()) break;
+            from = end->cycle;
+        }
+    }
+    return characters;
+}
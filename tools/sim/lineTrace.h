@@ -0,0 +1,134 @@
+/**
+ * @file lineTrace.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the LineTrace class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef LINE_TRACE_H
+#define LINE_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ioLine.h"
+
+/**
+ * @brief Class for traces of the I/O line, i.e. the timestamped edges of the Terminal & the card (see LineEdge).
+ *
+ * A trace is recorded on any IOLine (see IOLine::record()) or imported from a capture of both drivers, e.g. of
+ * a logic analyzer. Its Terminal edges can be replayed into a card (see replay()) at full speed or in real time,
+ * & the characters of both traces can be decoded (see decode()) & compared.
+ *
+ * A trace file consists of a LineTrace::Header & the LineEdge structs in the byte order of the host.
+ * All cycles are clock cycles of the card since its reset.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class LineTrace
+{
+public:
+    static constexpr uint32_t VERSION   = 1;            ///< Version of the file format
+    static constexpr uint32_t TAIL_ETUS = 960;          ///< ETUs to run the card after the last edge of a replay
+
+    /**
+     * @brief Header of a trace file.
+     */
+    struct Header
+    {
+        char magic[4];          ///< "T0LT"
+        uint32_t version;       ///< #VERSION
+        uint32_t frequency;     ///< Clock of the card in Hz
+        uint32_t etu;           ///< ETU of the card in clock cycles
+        uint64_t edges;         ///< Number of LineEdge structs after the header
+    };
+
+    /**
+     * @brief A character on the I/O line.
+     */
+    struct Character
+    {
+        uint64_t start;         ///< Cycle of the falling edge of the start bit
+        uint8_t driver;         ///< Driver of the start bit, IOLine::TERMINAL or IOLine::CARD
+        uint8_t byte;           ///< The byte (direct convention)
+        bool parity;            ///< Whether the parity bit is correct
+        bool error;             ///< Whether the receiver signalled a parity error (line low at 11 ETU)
+    };
+
+    /**
+     * @brief Construct an empty trace.
+     * @param[in] etu (const uint32_t): ETU of the card in clock cycles.
+     */
+    explicit LineTrace(const uint32_t etu = IOLine::ETU) : mETU(etu) {}
+
+    /**
+     * @brief Load a trace file.
+     * @param[in] path (const std::string&): Path of the file.
+     * @throws std::runtime_error If the file can't be read, isn't a trace or its size doesn't match the number of edges
+     *                            in the header. The trace is unchanged then.
+     */
+    void load(const std::string &path);
+
+    /**
+     * @brief Import a capture of both drivers.
+     *
+     * Each line of the CSV file is `seconds,terminal,card` with the levels of the Terminal's & the card's output,
+     * e.g. measured on both sides of a series resistor. The time 0 is the rising edge of the card's reset.
+     * Lines, that don't start with a number (e.g. a header), are skipped.
+     * @param[in] path (const std::string&): Path of the CSV file.
+     * @throws std::runtime_error If the file can't be read.
+     */
+    void importCSV(const std::string &path);
+
+    /**
+     * @brief Save the trace to a file.
+     * @param[in] path (const std::string&): Path of the file.
+     * @throws std::runtime_error If the file can't be written.
+     */
+    void save(const std::string &path) const;
+
+    /**
+     * @brief Replay the Terminal's edges into a card & record the replay.
+     *
+     * Each Terminal edge is applied at its cycle, regardless of the card's answers, & the card runs #TAIL_ETUS
+     * after the last edge of the trace. The card has to be reset just before.
+     * @param[inout] card (IOLine&): The card.
+     * @param[in] realTime (const bool): Whether to wait for the wall clock before each edge,
+     *                                   otherwise the trace is replayed as fast as possible.
+     * @return (LineTrace): The trace of the replay.
+     */
+    LineTrace replay(IOLine &card, const bool realTime) const;
+
+    /**
+     * @brief Decode the characters on the I/O line.
+     * @return (std::vector<Character>): The characters of both directions in their order on the line.
+     */
+    std::vector<Character> decode() const;
+
+    /**
+     * @brief Get the edges of the trace.
+     * @return (std::vector<LineEdge>&): The edges.
+     */
+    std::vector<LineEdge> &edges() { return mEdges; }
+
+    /**
+     * @brief Get the ETU of the card.
+     * @return (uint32_t): The ETU in clock cycles.
+     */
+    uint32_t etu() const { return mETU; }
+
+private:
+    static constexpr char MAGIC[4] = {'T', '0', 'L', 'T'};   ///< Magic number of a trace file
+
+    uint32_t mETU;                      ///< ETU of the card in clock cycles
+    std::vector<LineEdge> mEdges;       ///< Edges of both drivers, sorted by their cycle
+};
+
+#endif // LINE_TRACE_H
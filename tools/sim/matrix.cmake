@@ -0,0 +1,53 @@
+# Run cycleBench & avr-size on every firmware of the benchmark matrix & write the results as a Markdown table to OUTPUT
+# VARIANTS:     Names of the countermeasure combinations (separated by |)
+# MATRIX_DIR:   Directory with a build of the firmware per variant (<variant>) & a build with Profiling (<variant>_profiled)
+# FIRMWARE:     File name of the firmware ELF in each build
+# CYCLE_BENCH:  Path of the cycleBench tool
+# AVRSIZE:      Path of avr-size
+string(REPLACE "|" ";" VARIANTS "${VARIANTS}")
+
+# Get the value of NAME from the `name value` lines of cycleBench, or "-" if it is missing
+function(get_result output name var)
+    if("${output}" MATCHES "${name} ([0-9.]+)")
+        set(${var} "${CMAKE_MATCH_1}" PARENT_SCOPE)
+    else()
+        set(${var} "-" PARENT_SCOPE)
+    endif()
+endfunction()
+
+set(table "| Variant | decrypt min | decrypt avg | decrypt max | Masking::init | Hiding::init | boot to ATR | .text | .data | .bss |\n")
+set(table "${table}|---|--:|--:|--:|--:|--:|--:|--:|--:|--:|\n")
+foreach(variant ${VARIANTS})
+    # Cycles & sizes of the firmware as shipped
+    set(elf "${MATRIX_DIR}/${variant}/${FIRMWARE}")
+    execute_process(COMMAND "${CYCLE_BENCH}" "${elf}" OUTPUT_VARIABLE shipped RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "cycleBench failed for ${elf}.")
+    endif()
+    execute_process(COMMAND "${AVRSIZE}" --format=berkeley "${elf}" OUTPUT_VARIABLE size RESULT_VARIABLE status)
+    if(NOT status EQUAL 0 OR NOT "${size}" MATCHES "\n *([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)")
+        message(FATAL_ERROR "avr-size failed for ${elf}.")
+    endif()
+    set(text "${CMAKE_MATCH_1}")
+    set(data "${CMAKE_MATCH_2}")
+    set(bss  "${CMAKE_MATCH_3}")
+
+    # Cycles of the init phases, measured by the Profiler
+    set(elf "${MATRIX_DIR}/${variant}_profiled/${FIRMWARE}")
+    execute_process(COMMAND "${CYCLE_BENCH}" "${elf}" OUTPUT_VARIABLE profiled RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "cycleBench failed for ${elf}.")
+    endif()
+
+    get_result("${shipped}" "decrypt_cycles_min" decryptMin)
+    get_result("${shipped}" "decrypt_cycles_avg" decryptAvg)
+    get_result("${shipped}" "decrypt_cycles_max" decryptMax)
+    get_result("${shipped}" "atr_cycles" atr)
+    get_result("${profiled}" "masking_init_cycles" maskingInit)
+    get_result("${profiled}" "hiding_init_cycles" hidingInit)
+    set(table "${table}| ${variant} | ${decryptMin} | ${decryptAvg} | ${decryptMax} | ${maskingInit} | ${hidingInit} | ${atr} | ${text} | ${data} | ${bss} |\n")
+endforeach()
+
+file(WRITE "${OUTPUT}" "${table}")
+message("${table}")
+message(STATUS "Results written to ${OUTPUT}")
@@ -0,0 +1,146 @@
+#include "simCard.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+extern "C"
+{
+    #include "sim_elf.h"
+    #include "sim_cycle_timers.h"
+    #include "avr_ioport.h"
+    #include "avr_adc.h"
+}
+
+constexpr const char *SimCard::MCU;
+
+namespace
+{
+    /**
+     * @brief Cycle timer that does nothing, but wakes up a sleeping card.
+     */
+    avr_cycle_count_t wakeUp(avr_t*, avr_cycle_count_t, void*) { return 0; }
+}
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+SimCard::SimCard(const std::string &firmware)
+{
+    elf_firmware_t elf;
+    memset(&elf, 0, sizeof(elf));
+    if(elf_read_firmware(firmware.c_str(), &elf) != 0)
+        throw std::runtime_error("Can't read the firmware " + firmware + ".");
+
+    mAvr = avr_make_mcu_by_name(MCU);
+    if(!mAvr)
+        throw std::runtime_error(std::string("simavr does not support the ") + MCU + ".");
+    avr_init(mAvr);
+    avr_load_firmware(mAvr, &elf);
+    mAvr->frequency = FREQUENCY;
+    mAvr->vcc = mAvr->avcc = mAvr->aref = 5000;
+
+    mIOPinIrq = avr_io_getirq(mAvr, AVR_IOCTL_IOPORT_GETIRQ('B'), IO_PIN);
+    mADCIrq = avr_io_getirq(mAvr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0);
+    updatePins();
+}
+
+SimCard::~SimCard()
+{
+    if(mAvr)
+    {
+        avr_terminate(mAvr);
+        free(mAvr);
+    }
+}
+
+void SimCard::step()
+{
+    // Change the noise on ADC0 every now & then, around half the reference voltage
+    if(mSteps++ % NOISE_PERIOD == 0)
+        avr_raise_irq(mADCIrq, 2400 + mNoise() % 200);
+
+    const int state = avr_run(mAvr);
+    if(state == cpu_Done || state == cpu_Crashed)
+        throw std::runtime_error("The firmware stopped at cycle " + std::to_string(cycle()) + ".");
+    updatePins();
+}
+
+void SimCard::runUntil(const uint64_t cycle)
+{
+    if(this->cycle() >= cycle) return;
+    wakeAt(cycle);
+    while(this->cycle() < cycle)
+        step();
+}
+
+bool SimCard::waitForLine(const bool level, const uint64_t deadline)
+{
+    if(mLine == level) return true;
+    wakeAt(deadline);
+    while(mLine != level)
+    {
+        if(cycle() >= deadline) return false;
+        step();
+    }
+    return true;
+}
+
+void SimCard::setTerminalLow(const bool low)
+{
+    // A falling edge, while the card waits for a byte, is a start bit
+    const bool timerStopped = !(mAvr->data[TCCR1B_ADDRESS] & (1<<CS10_BIT));
+    const bool input = !(mAvr->data[DDRB_ADDRESS] & (1<<IO_PIN));
+    if(low && mLine && timerStopped && input)
+    {
+        mStartBit = cycle();
+        mStartBitPending = true;
+    }
+    mTerminalLow = low;
+    drive(TERMINAL, low);
+    updatePins();
+}
+
+void SimCard::readData(const uint16_t address, void *data, const size_t length) const
+{
+    if(address + length > mAvr->ramend + 1u)
+        throw std::out_of_range("Address outside of the card's data space.");
+    memcpy(data, mAvr->data + address, length);
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+void SimCard::updatePins()
+{
+    const uint8_t ddr = mAvr->data[DDRB_ADDRESS];
+    const uint8_t port = mAvr->data[PORTB_ADDRESS];
+
+    // Open-drain line with pull-up: Either side can pull it low
+    const bool cardLow = (ddr & (1<<IO_PIN)) && !(port & (1<<IO_PIN));
+    drive(CARD, cardLow);
+    mLine = !(cardLow || mTerminalLow);
+    // Feed the level back to PINB, which also raises the pin-change interrupt of the card
+    if(mIOPinIrq->value != mLine)
+        avr_raise_irq(mIOPinIrq, mLine);
+
+    if(mStartBitPending && (mAvr->data[TCCR1B_ADDRESS] & (1<<CS10_BIT)))
+    {
+        mStartBitLatencies.push_back(static_cast<uint32_t>(cycle() - mStartBit));
+        mStartBitPending = false;
+    }
+
+    // Trigger pin
+    const bool trigger = (ddr & (1<<TRIGGER_PIN)) && (port & (1<<TRIGGER_PIN));
+    if(trigger != mTrigger)
+    {
+        (trigger ? mTriggerRises : mTriggerFalls).push_back(cycle());
+        mTrigger = trigger;
+    }
+}
+
+void SimCard::wakeAt(const uint64_t cycle)
+{
+    if(cycle > this->cycle())
+        avr_cycle_timer_register(mAvr, cycle - this->cycle(), wakeUp, nullptr);
+}
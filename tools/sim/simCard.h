@@ -0,0 +1,169 @@
+/**
+ * @file simCard.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the SimCard class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef SIM_CARD_H
+#define SIM_CARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ioLine.h"
+
+extern "C"
+{
+    #include "sim_avr.h"
+    #include "sim_irq.h"
+}
+
+/**
+ * @brief Class that runs the card's firmware in simavr & models the I/O line & the trigger (JP5) pin.
+ *
+ * The I/O line (PB6) is the open-drain line of the IOLine interface. The card's clock is the CPU clock,
+ * so all times are measured in CPU cycles since the reset.
+ * ADC0 is fed with noise, so the RNG of the card can be seeded.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class SimCard : public IOLine
+{
+public:
+    static constexpr const char *MCU        = "atmega644";  ///< Simulated MCU
+
+    /**
+     * @brief Load the firmware & reset the card.
+     * @param[in] firmware (const std::string&): Path of the firmware ELF file.
+     * @throws std::runtime_error If the firmware can't be loaded.
+     */
+    explicit SimCard(const std::string &firmware);
+
+    /**
+     * @brief Destroy the SimCard object & the simulated MCU.
+     */
+    ~SimCard() override;
+
+    SimCard(const SimCard&) = delete;
+    SimCard &operator=(const SimCard&) = delete;
+
+    /**
+     * @brief Get the number of clock cycles since the reset.
+     * @return (uint64_t): The current cycle.
+     */
+    uint64_t cycle() const override { return mAvr->cycle; }
+
+    /**
+     * @brief Execute a single instruction (or sleep until the next event) & update the I/O line.
+     * @throws std::runtime_error If the firmware crashed or stopped.
+     */
+    void step();
+
+    /**
+     * @brief Run the card until @p cycle is reached.
+     * @param[in] cycle (const uint64_t): Cycle to run to.
+     */
+    void runUntil(const uint64_t cycle) override;
+
+    /**
+     * @brief Run the card until the I/O line has the level @p level or @p deadline is reached.
+     * @param[in] level (const bool): Level to wait for.
+     * @param[in] deadline (const uint64_t): Cycle at which to give up.
+     * @return (bool): Whether the I/O line reached @p level in time.
+     */
+    bool waitForLine(const bool level, const uint64_t deadline) override;
+
+    /**
+     * @brief Get the level of the I/O line.
+     * @return (bool): The level of the I/O line.
+     */
+    bool line() const override { return mLine; }
+
+    /**
+     * @brief Pull the I/O line low on the Terminal's side or release it.
+     * @param[in] low (const bool): Whether to pull the I/O line low.
+     */
+    void setTerminalLow(const bool low) override;
+
+    /**
+     * @brief Get the level of the trigger (JP5) pin.
+     * @return (bool): The level of the trigger pin.
+     */
+    bool trigger() const { return mTrigger; }
+
+    /**
+     * @brief Get the cycles of all rising edges of the trigger (JP5) pin since the reset.
+     * @return (const std::vector<uint64_t>&): The cycles of the rising edges.
+     */
+    const std::vector<uint64_t> &triggerRises() const { return mTriggerRises; }
+
+    /**
+     * @brief Get the cycles of all falling edges of the trigger (JP5) pin since the reset.
+     * @return (const std::vector<uint64_t>&): The cycles of the falling edges.
+     */
+    const std::vector<uint64_t> &triggerFalls() const { return mTriggerFalls; }
+
+    /**
+     * @brief Get the start-bit latencies of the card since the reset.
+     *
+     * The latency is measured from the Terminal's falling edge of a start bit, while the card's timer is stopped
+     * & the I/O pin is an input, to the first instruction, after which the timer runs (CS10 set in TCCR1B).
+     * It includes the interrupt response & the pin-change ISR up to the timer start.
+     * @return (const std::vector<uint32_t>&): The latencies in cycles.
+     */
+    const std::vector<uint32_t> &startBitLatencies() const { return mStartBitLatencies; }
+
+    /**
+     * @brief Copy data from the card's data space (registers, I/O & SRAM).
+     * @param[in] address (const uint16_t): Data space address, e.g. `avr-nm` address minus 0x800000.
+     * @param[out] data (void*): Buffer for the data.
+     * @param[in] length (const size_t): Number of bytes to copy.
+     */
+    void readData(const uint16_t address, void *data, const size_t length) const;
+
+private:
+    static constexpr uint16_t DDRB_ADDRESS  = 0x24;     ///< Data space address of DDRB
+    static constexpr uint16_t PORTB_ADDRESS = 0x25;     ///< Data space address of PORTB
+    static constexpr uint16_t TCCR1B_ADDRESS = 0x81;    ///< Data space address of TCCR1B
+    static constexpr uint8_t CS10_BIT       = 0;        ///< Clock select bit of Timer1, that the card sets to start it
+    static constexpr uint8_t IO_PIN         = 6;        ///< I/O line on PB6
+    static constexpr uint8_t TRIGGER_PIN    = 4;        ///< Trigger (JP5) pin on PB4
+    static constexpr uint32_t NOISE_PERIOD  = 64;       ///< Number of steps after which the ADC noise changes
+
+    avr_t *mAvr             = nullptr;  ///< The simulated MCU
+    avr_irq_t *mIOPinIrq    = nullptr;  ///< IRQ of the I/O pin, to feed the line level back to the card
+    avr_irq_t *mADCIrq      = nullptr;  ///< IRQ of ADC0
+    bool mTerminalLow       = false;    ///< Whether the Terminal pulls the I/O line low
+    bool mLine              = true;     ///< Level of the I/O line
+    bool mTrigger           = false;    ///< Level of the trigger pin
+    uint32_t mSteps         = 0;        ///< Number of executed steps
+    std::vector<uint64_t> mTriggerRises;///< Cycles of the rising edges of the trigger pin
+    std::vector<uint64_t> mTriggerFalls;///< Cycles of the falling edges of the trigger pin
+    std::mt19937 mNoise;                ///< Noise source for the ADC
+    bool mStartBitPending   = false;    ///< Whether the timer has not been started since the last start bit
+    uint64_t mStartBit      = 0;        ///< Cycle of the Terminal's last falling edge of a start bit
+    std::vector<uint32_t> mStartBitLatencies;   ///< Cycles from each start bit of the Terminal to the timer start
+
+    /**
+     * @brief Update the level of the I/O line & the trigger pin from the card's registers.
+     */
+    void updatePins();
+
+    /**
+     * @brief Stop simavr from sleeping past @p cycle.
+     * @param[in] cycle (const uint64_t): Cycle at which the card has to wake up.
+     */
+    void wakeAt(const uint64_t cycle);
+};
+
+#endif // SIM_CARD_H
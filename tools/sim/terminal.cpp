@@ -0,0 +1,182 @@
+#include "terminal.h"
+
+#include <algorithm>
+
+constexpr uint32_t IOLine::FREQUENCY;
+constexpr uint32_t IOLine::ETU;
+constexpr uint8_t IOLine::TERMINAL;
+constexpr uint8_t IOLine::CARD;
+constexpr uint8_t Terminal::HEADER_LENGTH;
+constexpr uint8_t Terminal::INS_INDEX;
+constexpr uint8_t Terminal::P3_INDEX;
+constexpr uint8_t Terminal::NULL_BYTE;
+constexpr uint32_t Terminal::GUARD_ETUS;
+constexpr uint32_t Terminal::TURN_ETUS;
+constexpr uint32_t Terminal::WAIT_ETUS;
+
+// **********************************************************************************
+// Public Methods *******************************************************************
+// **********************************************************************************
+void Terminal::injectErrors(const double sendRate, const double receiveRate, const uint32_t seed)
+{
+    mSendErrorRate = sendRate;
+    mReceiveErrorRate = receiveRate;
+    mErrors.seed(seed);
+}
+
+bool Terminal::receiveATR(std::vector<uint8_t> &atr, const uint64_t timeout)
+{
+    atr.clear();
+    uint8_t byte = 0;
+    // TS
+    if(!receiveByte(byte, timeout)) return false;
+    mATRStart = mLastReceived;
+    atr.push_back(byte);
+
+    // T0 & the interface bytes TAi, TBi, TCi & TDi, as indicated by the high nibble of T0 & each TDi
+    if(!receiveByte(byte, WAIT_ETUS*mETU)) return false;
+    atr.push_back(byte);
+    const uint8_t historicalBytes = byte & 0x0f;
+    uint8_t indicator = byte >> 4;
+    while(indicator)
+    {
+        for(uint8_t mask=0x01; mask<=0x08; mask<<=1)
+        {
+            if(!(indicator & mask)) continue;
+            if(!receiveByte(byte, WAIT_ETUS*mETU)) return false;
+            atr.push_back(byte);
+        }
+        // Only a TDi is followed by further interface bytes
+        indicator = (indicator & 0x08) ? (byte >> 4) : 0;
+    }
+
+    // Historical bytes
+    for(uint8_t i=0; i<historicalBytes; i++)
+    {
+        if(!receiveByte(byte, WAIT_ETUS*mETU)) return false;
+        atr.push_back(byte);
+    }
+    return true;
+}
+
+bool Terminal::receiveByte(uint8_t &byte, const uint64_t timeout)
+{
+    const uint64_t deadline = mCard.cycle() + timeout;
+    while(true)
+    {
+        // Wait for the idle line & the falling edge of the start bit
+        if(!mCard.waitForLine(true, deadline)) return false;
+        if(!mCard.waitForLine(false, deadline)) return false;
+        const uint64_t start = mCard.cycle();
+
+        // Sample the 8 data bits (LSB first) & the parity bit in the middle of each bit
+        uint16_t bits = 0;
+        for(uint8_t i=1; i<=9; i++)
+        {
+            mCard.runUntil(start + i*mETU + mETU/2);
+            bits |= static_cast<uint16_t>(mCard.line()) << (i-1);
+        }
+        mLastReceived = start;
+        mNextSend = std::max(mNextSend, start + TURN_ETUS*mETU);
+        byte = static_cast<uint8_t>(bits);
+        if(parity(byte) == static_cast<bool>(bits & 0x100))
+        {
+            if(!injectError(mReceiveErrorRate)) return true;
+            mInjectedErrors++;
+        }
+        else
+            mParityErrors++;
+
+        // Signal the parity error from 10.5 to 12 ETU, so the card repeats the byte
+        mCard.runUntil(start + 10*mETU + mETU/2);
+        mCard.setTerminalLow(true);
+        mCard.runUntil(start + 12*mETU);
+        mCard.setTerminalLow(false);
+    }
+}
+
+void Terminal::sendByte(const uint8_t byte)
+{
+    // Start bit (0), 8 data bits (LSB first) & parity bit
+    const uint16_t bits = (static_cast<uint16_t>(byte) << 1) | (static_cast<uint16_t>(parity(byte)) << 9);
+    bool corrupt = injectError(mSendErrorRate);
+    if(corrupt) mInjectedErrors++;
+    while(true)
+    {
+        const uint16_t sent = corrupt ? bits ^ 0x200 : bits;
+        corrupt = false;
+        mCard.runUntil(mNextSend);
+        const uint64_t start = mCard.cycle();
+        for(uint8_t i=0; i<10; i++)
+        {
+            mCard.setTerminalLow(!((sent >> i) & 0x01));
+            mCard.runUntil(start + (i+1)*mETU);
+        }
+        // Stop bit, during which the card may signal a parity error from 10.5 ETU on
+        mCard.setTerminalLow(false);
+        mCard.runUntil(start + 11*mETU);
+        const bool error = !mCard.line();
+        mNextSend = start + GUARD_ETUS*mETU;
+        if(!error) return;
+
+        // Wait for the end of the error signal & re-send the byte
+        mRetransmits++;
+        mCard.waitForLine(true, start + 14*mETU);
+        mNextSend = std::max(mNextSend, mCard.cycle() + 2*mETU);
+    }
+}
+
+bool Terminal::command(const uint8_t *header, const uint8_t *dataIn, uint8_t *dataOut, uint8_t *sw, const uint64_t timeout)
+{
+    for(uint8_t i=0; i<HEADER_LENGTH; i++)
+        sendByte(header[i]);
+
+    const uint8_t ins = header[INS_INDEX];
+    const uint8_t length = header[P3_INDEX];
+    uint8_t transferred = 0;
+    while(true)
+    {
+        uint8_t procedure = 0;
+        if(!receiveByte(procedure, timeout)) return false;
+        if(procedure == NULL_BYTE) continue;
+
+        // ACK: Transfer all remaining bytes (INS) or only the next byte (INS ^ 0xff)
+        if(procedure == ins || procedure == static_cast<uint8_t>(ins ^ 0xff))
+        {
+            uint8_t count = (procedure == ins) ? length - transferred : 1;
+            for(; count > 0 && transferred < length; count--, transferred++)
+            {
+                if(dataIn)
+                    sendByte(dataIn[transferred]);
+                else if(!receiveByte(dataOut[transferred], timeout))
+                    return false;
+            }
+            continue;
+        }
+
+        // Status words 6x yy & 9x yy
+        if((procedure & 0xf0) == 0x60 || (procedure & 0xf0) == 0x90)
+        {
+            mStatusStart = mLastReceived;
+            sw[0] = procedure;
+            return receiveByte(sw[1], timeout);
+        }
+        return false;
+    }
+}
+
+// **********************************************************************************
+// Private Methods ******************************************************************
+// **********************************************************************************
+bool Terminal::parity(const uint8_t byte)
+{
+    bool odd = false;
+    for(uint8_t mask=0x01; mask!=0x00; mask<<=1)
+        odd ^= static_cast<bool>(byte & mask);
+    return odd;
+}
+
+bool Terminal::injectError(const double rate)
+{
+    return rate > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(mErrors) < rate;
+}
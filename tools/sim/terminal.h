@@ -0,0 +1,154 @@
+/**
+ * @file terminal.h
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief File containing the Terminal class.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "ioLine.h"
+
+/**
+ * @brief Class implementing the Terminal's side of the ISO 7816-3 T=0 protocol on the simulated I/O line.
+ *
+ * The Terminal transmits & samples each bit on the I/O line of a simulated card (see IOLine), signals parity errors
+ * of received bytes & re-sends bytes for which the card signals a parity error. All times & timeouts are in clock cycles.
+ * The Terminal uses the default F/D = 372/1 of the card, which doesn't support another rate.
+ *
+ * To test the error handling of the card, parity errors can be injected (see injectErrors()): A sent byte is then
+ * first sent with an inverted parity bit, a received byte with a correct parity is rejected as if it was wrong.
+ *
+ * @authors agent (agent@local)
+ *
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+class Terminal
+{
+public:
+    static constexpr uint8_t HEADER_LENGTH  = 5;        ///< Length of a T=0 command header
+    static constexpr uint8_t INS_INDEX      = 1;        ///< Index of the instruction byte in a header
+    static constexpr uint8_t P3_INDEX       = 4;        ///< Index of the length byte in a header
+    static constexpr uint8_t NULL_BYTE      = 0x60;     ///< Procedure byte, that requests more time
+    static constexpr uint32_t GUARD_ETUS    = 12;       ///< Minimum distance of the start bits of two bytes in the same direction
+    static constexpr uint32_t TURN_ETUS     = 16;       ///< Minimum distance of the start bits of two bytes in opposite directions
+    static constexpr uint32_t WAIT_ETUS     = 9600;     ///< Maximum distance of the start bits of two bytes of the ATR
+
+    /**
+     * @brief Construct a new Terminal object.
+     * @param[in] card (IOLine&): The simulated card.
+     */
+    explicit Terminal(IOLine &card) : mCard(card) {}
+
+    /**
+     * @brief Inject parity errors into the transfer of single bytes.
+     * @param[in] sendRate (const double): Probability of sending a byte with a wrong parity first.
+     * @param[in] receiveRate (const double): Probability of rejecting a correctly received byte.
+     * @param[in] seed (const uint32_t): Seed of the random choice, so a run can be reproduced.
+     */
+    void injectErrors(const double sendRate, const double receiveRate, const uint32_t seed);
+
+    /**
+     * @brief Receive the answer-to-reset.
+     * @param[out] atr (std::vector<uint8_t>&): The bytes of the ATR.
+     * @param[in] timeout (const uint64_t): Number of cycles to wait for the first byte.
+     * @return (bool): Whether the complete ATR was received.
+     */
+    bool receiveATR(std::vector<uint8_t> &atr, const uint64_t timeout);
+
+    /**
+     * @brief Receive a single byte. If its parity is wrong, signal an error & receive the repetition.
+     * @param[out] byte (uint8_t&): The received byte.
+     * @param[in] timeout (const uint64_t): Number of cycles to wait for the start bit.
+     * @return (bool): Whether a byte was received in time.
+     */
+    bool receiveByte(uint8_t &byte, const uint64_t timeout);
+
+    /**
+     * @brief Send a single byte & re-send it as long as the card signals a parity error.
+     * @param[in] byte (const uint8_t): The byte to send.
+     */
+    void sendByte(const uint8_t byte);
+
+    /**
+     * @brief Exchange a T=0 command with the card.
+     *
+     * Send @p header & handle the procedure bytes of the card, until it sends the status words.
+     * @param[in] header (const uint8_t*): The command header (CLA, INS, P1, P2, P3).
+     * @param[in] dataIn (const uint8_t*): P3 bytes to send to the card, nullptr if the card sends data.
+     * @param[out] dataOut (uint8_t*): Buffer for P3 bytes from the card, nullptr if the card receives data.
+     * @param[out] sw (uint8_t*): The two status words.
+     * @param[in] timeout (const uint64_t): Number of cycles to wait for each byte of the card.
+     * @return (bool): Whether the command was completed in time.
+     */
+    bool command(const uint8_t *header, const uint8_t *dataIn, uint8_t *dataOut, uint8_t *sw, const uint64_t timeout);
+
+    /**
+     * @brief Get the cycle of the start bit of the first ATR byte.
+     * @return (uint64_t): The cycle of the start bit.
+     */
+    uint64_t atrStart() const { return mATRStart; }
+
+    /**
+     * @brief Get the cycle of the start bit of the first status word of the last command.
+     * @return (uint64_t): The cycle of the start bit.
+     */
+    uint64_t statusStart() const { return mStatusStart; }
+
+    /**
+     * @brief Get the number of received bytes with a parity error.
+     * @return (uint32_t): The number of parity errors.
+     */
+    uint32_t parityErrors() const { return mParityErrors; }
+
+    /**
+     * @brief Get the number of bytes, that had to be re-sent.
+     * @return (uint32_t): The number of re-sent bytes.
+     */
+    uint32_t retransmits() const { return mRetransmits; }
+
+    /**
+     * @brief Get the number of injected parity errors.
+     * @return (uint32_t): The number of injected errors, in both directions.
+     */
+    uint32_t injectedErrors() const { return mInjectedErrors; }
+
+private:
+    IOLine &mCard;                      ///< The simulated card
+    const uint32_t mETU     = IOLine::ETU;  ///< Elementary time unit in clock cycles
+    uint64_t mATRStart      = 0;        ///< Cycle of the start bit of the first ATR byte
+    uint64_t mStatusStart   = 0;        ///< Cycle of the start bit of the first status word of the last command
+    uint64_t mLastReceived  = 0;        ///< Cycle of the start bit of the last received byte
+    uint64_t mNextSend      = 0;        ///< Earliest cycle for the start bit of the next sent byte
+    uint32_t mParityErrors  = 0;        ///< Number of received bytes with a parity error
+    uint32_t mRetransmits   = 0;        ///< Number of re-sent bytes
+    uint32_t mInjectedErrors= 0;        ///< Number of injected parity errors
+    double mSendErrorRate   = 0;        ///< Probability of sending a byte with a wrong parity first
+    double mReceiveErrorRate= 0;        ///< Probability of rejecting a correctly received byte
+    std::mt19937 mErrors;               ///< Random source of the injected errors
+
+    /**
+     * @brief Decide randomly, whether to inject an error.
+     * @param[in] rate (const double): Probability of an error.
+     * @return (bool): Whether to inject an error.
+     */
+    bool injectError(const double rate);
+
+    /**
+     * @brief Get the even parity bit of @p byte.
+     * @param[in] byte (const uint8_t): The byte.
+     * @return (bool): The parity bit, true if the number of set bits is odd.
+     */
+    static bool parity(const uint8_t byte);
+};
+
+#endif // TERMINAL_H
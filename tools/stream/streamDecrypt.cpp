@@ -0,0 +1,246 @@
+/**
+ * @file streamDecrypt.cpp
+ *
+ * @authors agent (agent@local)
+ *
+ * @brief Decrypt a recorded stream file on the host, exactly like the card.
+ *
+ * Usage: `streamDecrypt [-k key] [-e engine] [-j threads] [-c chunkKiB] <input> <output>`
+ *
+ * The input is mapped into memory & split into chunks of whole blocks (default 1024 KiB), which a pool of worker
+ * threads (default: one per core) decrypts directly into the memory-mapped output. Each 16-byte block of the output
+ * is what the card sends back for the block with sendDecryptedData(), so the input has to be a multiple of 16 bytes.
+ * The throughput is reported at the end.
+ *
+ * - `-k` is the key as 32 hex digits, by default the key that the card loads into the empty slot 0.
+ * - `-e` selects the engine: `host` (default) is the fastest engine of HostAES, `ttable`, `aesni`, `vperm` &
+ *   `bitsliced` select one of its engines & `firmware` uses AES::decryptBlocks() of the firmware itself.
+ *   The host engines are cross-checked against AES::decrypt() by `engineCheck`. The firmware's AES counts the
+ *   decrypted blocks in the global Statistics, so it always runs in a single thread.
+ * @date 18.10.2026
+ * @copyright agent 2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "aes.h"
+#include "keyStore.h"
+#include "host/hostAES.h"
+
+namespace
+{
+    /**
+     * @brief Print the usage.
+     * @param[in] name (const char*): Name of the executable.
+     * @return (int): The exit code for a wrong usage.
+     */
+    int usage(const char *name)
+    {
+        fprintf(stderr, "Usage: %s [-k key] [-e host|ttable|aesni|vperm|bitsliced|firmware] [-j threads] [-c chunkKiB] <input> <output>\n", name);
+        return 2;
+    }
+
+    /**
+     * @brief Parse a key of 32 hex digits.
+     * @param[in] text (const char*): The key.
+     * @param[out] key ( @ref aes_key_t): The parsed key.
+     * @return (bool): Whether @p text is a valid key.
+     */
+    bool parseKey(const char *text, aes_key_t key)
+    {
+        if(strlen(text) != 2*KEY_BYTES) return false;
+        for(uint8_t i=0; i<KEY_BYTES; i++)
+        {
+            char digits[3] = {text[2*i], text[2*i + 1], '\0'};
+            char *end = nullptr;
+            key[i] = static_cast<uint8_t>(strtoul(digits, &end, 16));
+            if(*end != '\0') return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief A file, that is mapped into memory.
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief Map the input file read-only.
+         * @param[in] path (const char*): Path of the file.
+         * @return (bool): Whether the file was mapped, an error was printed otherwise.
+         */
+        bool openInput(const char *path)
+        {
+            mFd = open(path, O_RDONLY);
+            struct stat info;
+            if(mFd < 0 || fstat(mFd, &info) != 0)
+            {
+                perror(path);
+                return false;
+            }
+            mSize = static_cast<size_t>(info.st_size);
+            return map(path, PROT_READ, MAP_PRIVATE);
+        }
+
+        /**
+         * @brief Create the output file with @p size bytes & map it writable.
+         * @param[in] path (const char*): Path of the file.
+         * @param[in] size (const size_t): Size of the file.
+         * @return (bool): Whether the file was mapped, an error was printed otherwise.
+         */
+        bool openOutput(const char *path, const size_t size)
+        {
+            mFd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if(mFd < 0 || ftruncate(mFd, static_cast<off_t>(size)) != 0)
+            {
+                perror(path);
+                return false;
+            }
+            mSize = size;
+            return map(path, PROT_READ | PROT_WRITE, MAP_SHARED);
+        }
+
+        ~MappedFile()
+        {
+            if(mData) munmap(mData, mSize);
+            if(mFd >= 0) close(mFd);
+        }
+
+        uint8_t *data() const { return mData; }
+        size_t size() const { return mSize; }
+
+    private:
+        int mFd = -1;               ///< File descriptor
+        size_t mSize = 0;           ///< Size of the file
+        uint8_t *mData = nullptr;   ///< The mapped file, nullptr if it is empty
+
+        /**
+         * @brief Map the whole file, the file is read sequentially.
+         * @return (bool): Whether the file was mapped.
+         */
+        bool map(const char *path, const int protection, const int flags)
+        {
+            if(mSize == 0) return true;
+            void *data = mmap(nullptr, mSize, protection, flags, mFd, 0);
+            if(data == MAP_FAILED)
+            {
+                perror(path);
+                return false;
+            }
+            mData = static_cast<uint8_t*>(data);
+            madvise(mData, mSize, MADV_SEQUENTIAL);
+            return true;
+        }
+    };
+}
+
+int main(int argc, char **argv)
+{
+    aes_key_t key;
+    memcpy(key, KeyStore::DEFAULT_KEY, KEY_BYTES);
+    const char *engineName = "host";
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkBytes = 1024*1024;
+    int option = 0;
+    while((option = getopt(argc, argv, "k:e:j:c:")) != -1)
+    {
+        switch(option)
+        {
+            case 'k':
+                if(!parseKey(optarg, key))
+                {
+                    fprintf(stderr, "The key has to be 32 hex digits.\n");
+                    return 2;
+                }
+                break;
+            case 'e': engineName = optarg; break;
+            case 'j': threads = static_cast<unsigned>(atoi(optarg)); break;
+            case 'c': chunkBytes = static_cast<size_t>(atol(optarg)) * 1024; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if(optind + 2 != argc) return usage(argv[0]);
+    if(threads < 1 || chunkBytes < 1)
+    {
+        fprintf(stderr, "At least 1 thread & a chunk of 1 KiB are required.\n");
+        return 2;
+    }
+
+    // Engine ***************************************************************************
+    const bool firmware = (strcmp(engineName, "firmware") == 0);
+    HostAES::Engine engine = HostAES::best();
+    if(strcmp(engineName, "ttable") == 0) engine = HostAES::Engine::T_TABLE;
+    else if(strcmp(engineName, "aesni") == 0) engine = HostAES::Engine::AES_NI;
+    else if(strcmp(engineName, "vperm") == 0) engine = HostAES::Engine::VPERM;
+    else if(strcmp(engineName, "bitsliced") == 0) engine = HostAES::Engine::BITSLICED;
+    else if(strcmp(engineName, "host") != 0 && !firmware) return usage(argv[0]);
+    if(!firmware && !HostAES::supported(engine))
+    {
+        fprintf(stderr, "The CPU doesn't support %s.\n", HostAES::name(engine));
+        return 1;
+    }
+    if(firmware) threads = 1;
+
+    // Files ****************************************************************************
+    MappedFile input;
+    if(!input.openInput(argv[optind])) return 1;
+    if(input.size() % STATE_BYTES != 0)
+    {
+        fprintf(stderr, "%s has %zu bytes, the card only decrypts whole blocks of %u bytes.\n", argv[optind], input.size(), STATE_BYTES);
+        return 1;
+    }
+    MappedFile output;
+    if(!output.openOutput(argv[optind + 1], input.size())) return 1;
+    const size_t nBlocks = input.size() / STATE_BYTES;
+    const size_t chunkBlocks = std::max<size_t>(1, chunkBytes / STATE_BYTES);
+
+    // Decryption ***********************************************************************
+    const auto start = std::chrono::steady_clock::now();
+    if(firmware)
+    {
+        KeyStore::init(key);
+        while(KeyStore::loadStep(nullptr));
+        AES aes;
+        aes.selectKey(0);
+        for(size_t block=0; block<nBlocks; block+=chunkBlocks)
+            aes.decryptBlocks(&input.data()[block*STATE_BYTES], &output.data()[block*STATE_BYTES], std::min(chunkBlocks, nBlocks - block));
+    }
+    else
+    {
+        // The workers share the engine, decryptBlocks() doesn't change it. Each takes the next chunk, until none is left.
+        HostAES aes(engine);
+        aes.setKey(key);
+        std::atomic<size_t> nextChunk(0);
+        const auto worker = [&]()
+        {
+            for(size_t block = nextChunk++ * chunkBlocks; block < nBlocks; block = nextChunk++ * chunkBlocks)
+                aes.decryptBlocks(&input.data()[block*STATE_BYTES], &output.data()[block*STATE_BYTES], std::min(chunkBlocks, nBlocks - block));
+        };
+        threads = static_cast<unsigned>(std::min<size_t>(threads, (nBlocks + chunkBlocks - 1) / chunkBlocks));
+        std::vector<std::thread> pool;
+        for(unsigned i=1; i<threads; i++) pool.emplace_back(worker);
+        worker();
+        for(std::thread &thread : pool) thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Results **************************************************************************
+    printf("Engine:      %s\n", firmware ? "AES (firmware)" : HostAES::name(engine));
+    printf("Threads:     %u\n", std::max(threads, 1u));
+    printf("Blocks:      %zu (%.1f MiB)\n", nBlocks, input.size() / (1024.0*1024.0));
+    printf("Time:        %.3f s\n", seconds);
+    if(seconds > 0) printf("Throughput:  %.1f MiB/s\n", input.size() / (1024.0*1024.0) / seconds);
+    return 0;
+}